@@ -7,6 +7,8 @@
 #include <sstream>
 #include <iomanip>
 #include <chrono>
+#include <cctype>
+#include <unordered_set>
 
 // ==================== NORMALIZATION UTILITIES ====================
 
@@ -118,25 +120,6 @@ double SimilarityMetrics::cosineSimilarity(
     return dotProduct / (norm1 * norm2);
 }
 
-double SimilarityMetrics::combinedSimilarity(const std::string& text1, 
-                                            const std::string& text2,
-                                            double jaccardWeight, 
-                                            double cosineWeight) {
-    auto tokens1 = NLPUtils::tokenize(text1);
-    auto tokens2 = NLPUtils::tokenize(text2);
-    
-    std::set<std::string> set1(tokens1.begin(), tokens1.end());
-    std::set<std::string> set2(tokens2.begin(), tokens2.end());
-    double jaccardSim = jaccardSimilarity(set1, set2);
-    
-    std::unordered_map<std::string, double> vec1, vec2;
-    for (const auto& token : tokens1) vec1[token]++;
-    for (const auto& token : tokens2) vec2[token]++;
-    double cosineSim = cosineSimilarity(vec1, vec2);
-    
-    return jaccardWeight * jaccardSim + cosineWeight * cosineSim;
-}
-
 std::unordered_map<std::string, double> SimilarityMetrics::createTFIDFVector(
     const std::string& text,
     const std::vector<std::string>& corpus) {
@@ -165,4 +148,349 @@ std::unordered_map<std::string, double> SimilarityMetrics::createTFIDFVector(
     return tfidf;
 }
 
+// Word tokens as matched by \b\w+\b in NLPUtils::tokenize, lowercased,
+// skipping any in stopWordSet
+static void scanWords(const std::string& text, std::vector<std::string>& tokens,
+                      const std::unordered_set<std::string>* stopWordSet) {
+    auto isWordChar = [](unsigned char ch) { return std::isalnum(ch) || ch == '_'; };
+    tokens.clear();
+    
+    std::string token;
+    size_t i = 0;
+    while (i < text.size()) {
+        if (!isWordChar(text[i])) {
+            i++;
+            continue;
+        }
+        token.clear();
+        for (; i < text.size() && isWordChar(text[i]); i++) {
+            token += static_cast<char>(std::tolower(static_cast<unsigned char>(text[i])));
+        }
+        if (!stopWordSet || !stopWordSet->count(token)) {
+            tokens.push_back(token);
+        }
+    }
+}
+
+void SimilarityMetrics::tokenizeContent(const std::string& text, std::vector<std::string>& tokens) {
+    static const std::unordered_set<std::string> stopWordSet(NLPUtils::stopWords.begin(),
+                                                             NLPUtils::stopWords.end());
+    scanWords(text, tokens, &stopWordSet);
+}
+
+void SimilarityMetrics::tokenizeWords(const std::string& text, std::vector<std::string>& tokens) {
+    scanWords(text, tokens, nullptr);
+}
+
+// ==================== SPARSE VECTOR KERNELS ====================
+
+void SparseVector::computeNorm() {
+    double sum = 0.0;
+    for (float value : values) {
+        sum += static_cast<double>(value) * value;
+    }
+    norm = std::sqrt(sum);
+}
+
+// Scalar merge of a[i..na) and b[j..nb)
+static void mergeTail(const SparseVector& a, size_t i, const SparseVector& b, size_t j,
+                      SparseOverlap& overlap) {
+    const uint32_t* ia = a.indices.data();
+    const uint32_t* ib = b.indices.data();
+    while (i < a.size() && j < b.size()) {
+        if (ia[i] < ib[j]) {
+            i++;
+        } else if (ib[j] < ia[i]) {
+            j++;
+        } else {
+            overlap.sharedTerms++;
+            overlap.dotProduct += static_cast<double>(a.values[i]) * b.values[j];
+            i++;
+            j++;
+        }
+    }
+}
+
+// Each index of the short vector is found by exponential then binary search,
+// resuming from the previous match: O(short × log(long / short))
+static void gallopIntersect(const SparseVector& shortVec, const SparseVector& longVec,
+                            SparseOverlap& overlap) {
+    const uint32_t* begin = longVec.indices.data();
+    const uint32_t* end = begin + longVec.size();
+    const uint32_t* pos = begin;
+    
+    for (size_t i = 0; i < shortVec.size() && pos < end; i++) {
+        uint32_t target = shortVec.indices[i];
+        size_t step = 1;
+        const uint32_t* low = pos;
+        while (low + step < end && low[step] < target) {
+            low += step;
+            step *= 2;
+        }
+        pos = std::lower_bound(low, std::min(low + step + 1, end), target);
+        if (pos < end && *pos == target) {
+            overlap.sharedTerms++;
+            overlap.dotProduct += static_cast<double>(shortVec.values[i]) * longVec.values[pos - begin];
+        }
+    }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+
+// Block merge: each block of 4 indices of a is compared against all
+// rotations of a block of b in one step; the block with the smaller last
+// index advances. SSE2 is part of the x86-64 baseline.
+static void blockIntersect(const SparseVector& a, const SparseVector& b, SparseOverlap& overlap) {
+    const uint32_t* ia = a.indices.data();
+    const uint32_t* ib = b.indices.data();
+    size_t i = 0, j = 0;
+    
+    while (i + 4 <= a.size() && j + 4 <= b.size()) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ia + i));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ib + j));
+        __m128i match = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi32(va, vb),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1)))),
+            _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))),
+                         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3)))));
+        
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(match));
+        while (mask) {
+            size_t lane = __builtin_ctz(mask);
+            size_t k = j;
+            while (ib[k] != ia[i + lane]) k++;
+            overlap.sharedTerms++;
+            overlap.dotProduct += static_cast<double>(a.values[i + lane]) * b.values[k];
+            mask &= mask - 1;
+        }
+        
+        uint32_t lastA = ia[i + 3];
+        uint32_t lastB = ib[j + 3];
+        if (lastA <= lastB) i += 4;
+        if (lastB <= lastA) j += 4;
+    }
+    mergeTail(a, i, b, j, overlap);
+}
+#else
+static void blockIntersect(const SparseVector& a, const SparseVector& b, SparseOverlap& overlap) {
+    mergeTail(a, 0, b, 0, overlap);
+}
+#endif
+
+SparseOverlap SimilarityMetrics::sparseOverlap(const SparseVector& vec1, const SparseVector& vec2) {
+    SparseOverlap overlap;
+    const SparseVector& shorter = vec1.size() <= vec2.size() ? vec1 : vec2;
+    const SparseVector& longer = vec1.size() <= vec2.size() ? vec2 : vec1;
+    
+    if (shorter.empty()) return overlap;
+    if (shorter.size() * 16 < longer.size()) {
+        gallopIntersect(shorter, longer, overlap);
+    } else {
+        blockIntersect(vec1, vec2, overlap);
+    }
+    return overlap;
+}
+
+double SimilarityMetrics::cosineSimilarity(const SparseVector& vec1, const SparseVector& vec2) {
+    if (vec1.norm < 1e-10 || vec2.norm < 1e-10) return 0.0;
+    return sparseOverlap(vec1, vec2).dotProduct / (vec1.norm * vec2.norm);
+}
+
+// Jaccard and cosine from one overlap, with the conventions of the set and map versions
+static void scoreOverlap(const SparseVector& vec1, const SparseVector& vec2,
+                         const SparseOverlap& overlap, double* jaccard, double* cosine) {
+    if (jaccard) {
+        if (vec1.empty() && vec2.empty()) {
+            *jaccard = 1.0;
+        } else if (vec1.empty() || vec2.empty()) {
+            *jaccard = 0.0;
+        } else {
+            size_t unionSize = vec1.size() + vec2.size() - overlap.sharedTerms;
+            *jaccard = static_cast<double>(overlap.sharedTerms) / unionSize;
+        }
+    }
+    if (cosine) {
+        bool zero = vec1.norm < 1e-10 || vec2.norm < 1e-10;
+        *cosine = zero ? 0.0 : overlap.dotProduct / (vec1.norm * vec2.norm);
+    }
+}
+
+void SimilarityMetrics::compareOneToMany(const SparseVector& query,
+                                         const std::vector<SparseVector>& candidates,
+                                         double* jaccard, double* cosine) {
+    for (size_t c = 0; c < candidates.size(); c++) {
+        scoreOverlap(query, candidates[c], sparseOverlap(query, candidates[c]),
+                     jaccard ? jaccard + c : nullptr, cosine ? cosine + c : nullptr);
+    }
+}
+
+double SimilarityMetrics::combinedSimilarity(const std::string& text1, 
+                                            const std::string& text2,
+                                            double jaccardWeight, 
+                                            double cosineWeight) {
+    std::vector<std::string> tokens1, tokens2;
+    tokenizeWords(text1, tokens1);
+    tokenizeWords(text2, tokens2);
+    
+    // Term IDs local to this pair; count vectors share one vocabulary
+    std::unordered_map<std::string, uint32_t> termIds;
+    auto countVector = [&termIds](const std::vector<std::string>& tokens) {
+        std::vector<uint32_t> ids;
+        ids.reserve(tokens.size());
+        for (const auto& token : tokens) {
+            ids.push_back(termIds.emplace(token, static_cast<uint32_t>(termIds.size())).first->second);
+        }
+        std::sort(ids.begin(), ids.end());
+        
+        SparseVector vec;
+        for (size_t i = 0; i < ids.size(); ) {
+            size_t j = i;
+            while (j < ids.size() && ids[j] == ids[i]) j++;
+            vec.indices.push_back(ids[i]);
+            vec.values.push_back(static_cast<float>(j - i));
+            i = j;
+        }
+        vec.computeNorm();
+        return vec;
+    };
+    SparseVector vec1 = countVector(tokens1);
+    SparseVector vec2 = countVector(tokens2);
+    
+    double jaccardSim, cosineSim;
+    scoreOverlap(vec1, vec2, sparseOverlap(vec1, vec2), &jaccardSim, &cosineSim);
+    
+    return jaccardWeight * jaccardSim + cosineWeight * cosineSim;
+}
+
+// ==================== CORPUS INDEX ====================
+
+CorpusIndex::CorpusIndex() {}
+
+void CorpusIndex::collapseTerms(std::vector<uint32_t>& ids, DocumentEntry& entry) {
+    std::sort(ids.begin(), ids.end());
+    for (size_t i = 0; i < ids.size(); ) {
+        size_t j = i;
+        while (j < ids.size() && ids[j] == ids[i]) j++;
+        entry.termIds.push_back(ids[i]);
+        entry.counts.push_back(static_cast<uint32_t>(j - i));
+        i = j;
+    }
+}
+
+CorpusIndex::DocumentEntry CorpusIndex::indexTerms(const std::string& text) {
+    std::vector<std::string> tokens;
+    SimilarityMetrics::tokenizeContent(text, tokens);
+    
+    std::vector<uint32_t> ids;
+    ids.reserve(tokens.size());
+    for (auto& token : tokens) {
+        auto inserted = termIds.emplace(token, static_cast<uint32_t>(terms.size()));
+        if (inserted.second) {
+            terms.push_back(std::move(token));
+            documentFrequency.push_back(0);
+            logDocumentFrequency.push_back(0.0);
+        }
+        ids.push_back(inserted.first->second);
+    }
+    
+    DocumentEntry entry;
+    entry.length = static_cast<uint32_t>(tokens.size());
+    collapseTerms(ids, entry);
+    return entry;
+}
+
+CorpusIndex::DocumentEntry CorpusIndex::lookupTerms(const std::string& text) const {
+    std::vector<std::string> tokens;
+    SimilarityMetrics::tokenizeContent(text, tokens);
+    
+    std::vector<uint32_t> ids;
+    ids.reserve(tokens.size());
+    for (const auto& token : tokens) {
+        uint32_t termId = lookupTerm(token);
+        if (termId != kUnknownTerm) {
+            ids.push_back(termId);
+        }
+    }
+    
+    DocumentEntry entry;
+    entry.length = static_cast<uint32_t>(tokens.size());
+    collapseTerms(ids, entry);
+    return entry;
+}
+
+void CorpusIndex::addDocument(const std::string& documentId, const std::string& text) {
+    removeDocument(documentId);
+    
+    DocumentEntry entry = indexTerms(text);
+    for (uint32_t termId : entry.termIds) {
+        documentFrequency[termId]++;
+        logDocumentFrequency[termId] = std::log(1.0 + documentFrequency[termId]);
+    }
+    documents[documentId] = std::move(entry);
+}
+
+void CorpusIndex::addProposal(const std::shared_ptr<Proposal>& proposal) {
+    addDocument(proposal->getProposalId(), proposal->getTitle() + " " + proposal->getDescription());
+}
+
+bool CorpusIndex::removeDocument(const std::string& documentId) {
+    auto it = documents.find(documentId);
+    if (it == documents.end()) return false;
+    
+    for (uint32_t termId : it->second.termIds) {
+        documentFrequency[termId]--;
+        logDocumentFrequency[termId] = std::log(1.0 + documentFrequency[termId]);
+    }
+    documents.erase(it);
+    return true;
+}
+
+bool CorpusIndex::hasDocument(const std::string& documentId) const {
+    return documents.count(documentId) > 0;
+}
+
+void CorpusIndex::clear() {
+    termIds.clear();
+    terms.clear();
+    documentFrequency.clear();
+    logDocumentFrequency.clear();
+    documents.clear();
+}
+
+uint32_t CorpusIndex::lookupTerm(const std::string& term) const {
+    auto it = termIds.find(term);
+    return (it != termIds.end()) ? it->second : kUnknownTerm;
+}
+
+double CorpusIndex::getIDF(uint32_t termId) const {
+    return std::log(static_cast<double>(documents.size())) - logDocumentFrequency[termId];
+}
+
+SparseVector CorpusIndex::weightTerms(const DocumentEntry& entry) const {
+    SparseVector vector;
+    if (entry.length == 0) return vector;
+    
+    // log N is shared by every term of the vector
+    double logDocuments = std::log(static_cast<double>(documents.size()));
+    vector.indices = entry.termIds;
+    vector.values.reserve(entry.termIds.size());
+    for (size_t i = 0; i < entry.termIds.size(); ++i) {
+        double tf = static_cast<double>(entry.counts[i]) / entry.length;
+        double idf = logDocuments - logDocumentFrequency[entry.termIds[i]];
+        vector.values.push_back(static_cast<float>(tf * idf));
+    }
+    vector.computeNorm();
+    return vector;
+}
+
+SparseVector CorpusIndex::createTFIDFVector(const std::string& text) const {
+    return weightTerms(lookupTerms(text));
+}
+
+SparseVector CorpusIndex::getDocumentVector(const std::string& documentId) const {
+    auto it = documents.find(documentId);
+    return (it != documents.end()) ? weightTerms(it->second) : SparseVector();
+}
+
 // Remaining implementations in separate file...
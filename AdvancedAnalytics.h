@@ -11,6 +11,10 @@
 #include <cmath>
 #include <queue>
 #include <numeric>
+#include <functional>
+#include <chrono>
+#include <cstdint>
+#include <climits>
 
 // Forward declarations
 class Proposal;
@@ -34,6 +38,27 @@ public:
 
 // ==================== ENHANCED SIMILARITY METRICS ====================
 
+// Sparse vector: ascending term IDs with matching values
+struct SparseVector {
+    std::vector<uint32_t> indices;
+    std::vector<float> values;
+    double norm;  // L2 norm of values, kept current by computeNorm()
+    
+    SparseVector() : norm(0.0) {}
+    
+    size_t size() const { return indices.size(); }
+    bool empty() const { return indices.empty(); }
+    void computeNorm();
+};
+
+// Shared terms and dot product of two sparse vectors
+struct SparseOverlap {
+    size_t sharedTerms;
+    double dotProduct;
+    
+    SparseOverlap() : sharedTerms(0), dotProduct(0.0) {}
+};
+
 class SimilarityMetrics {
 public:
     // Jaccard Index: |A ∩ B| / |A ∪ B|
@@ -47,10 +72,103 @@ public:
     static double combinedSimilarity(const std::string& text1, const std::string& text2,
                                     double jaccardWeight = 0.5, double cosineWeight = 0.5);
     
-    // Create TF-IDF vector for text
+    // Create TF-IDF vector for text (re-tokenizes the corpus; use CorpusIndex, or
+    // DecisionRankingEngine's index of its proposals, for repeated calls)
     static std::unordered_map<std::string, double> createTFIDFVector(
         const std::string& text,
         const std::vector<std::string>& corpus);
+    
+    // Lowercased word tokens without stop words, i.e. removeStopWords(tokenize(text)),
+    // scanned directly instead of through a regex
+    static void tokenizeContent(const std::string& text, std::vector<std::string>& tokens);
+    
+    // Lowercased word tokens, i.e. tokenize(text) without a regex
+    static void tokenizeWords(const std::string& text, std::vector<std::string>& tokens);
+    
+    // Intersect the index lists of two sparse vectors: SIMD block merge,
+    // or galloping search when one vector is much shorter
+    static SparseOverlap sparseOverlap(const SparseVector& vec1, const SparseVector& vec2);
+    
+    // Sparse cosine similarity using the precomputed norms
+    static double cosineSimilarity(const SparseVector& vec1, const SparseVector& vec2);
+    
+    // Jaccard (over index sets) and cosine of one query against many vectors,
+    // from a single intersection pass per candidate. Each output, if not
+    // null, receives candidates.size() scores.
+    static void compareOneToMany(const SparseVector& query,
+                                 const std::vector<SparseVector>& candidates,
+                                 double* jaccard, double* cosine);
+};
+
+// ==================== CORPUS INDEX ====================
+
+// Document frequencies over a changing set of documents. Adding or removing
+// a document touches only its own terms; log(1 + df) is cached per term so
+// a TF-IDF vector costs time linear in the document length.
+class CorpusIndex {
+private:
+    struct DocumentEntry {
+        std::vector<uint32_t> termIds;  // Unique terms, ascending
+        std::vector<uint32_t> counts;   // Occurrences of each term
+        uint32_t length;                // Content tokens, including unindexed ones
+        
+        DocumentEntry() : length(0) {}
+    };
+    
+    std::unordered_map<std::string, uint32_t> termIds;
+    std::vector<std::string> terms;                 // Term IDs are never reused
+    std::vector<uint32_t> documentFrequency;
+    std::vector<double> logDocumentFrequency;       // log(1 + df) per term
+    std::unordered_map<std::string, DocumentEntry> documents;
+    
+    // Count the content tokens of text, adding new terms to the vocabulary
+    DocumentEntry indexTerms(const std::string& text);
+    
+    // Count the content tokens of text that are already in the vocabulary
+    DocumentEntry lookupTerms(const std::string& text) const;
+    
+    // Collapse unsorted term IDs into unique terms and counts
+    static void collapseTerms(std::vector<uint32_t>& ids, DocumentEntry& entry);
+    
+    // tf × idf for each term of an entry
+    SparseVector weightTerms(const DocumentEntry& entry) const;
+
+public:
+    static constexpr uint32_t kUnknownTerm = UINT32_MAX;
+    
+    CorpusIndex();
+    
+    // Add a document, replacing any previous text with the same ID
+    void addDocument(const std::string& documentId, const std::string& text);
+    
+    // Add a proposal's title and description under its proposal ID
+    void addProposal(const std::shared_ptr<Proposal>& proposal);
+    
+    // Remove a document; returns false if it is not indexed
+    bool removeDocument(const std::string& documentId);
+    
+    bool hasDocument(const std::string& documentId) const;
+    
+    void clear();
+    
+    // TF-IDF vector for any text against the corpus; terms not in the corpus
+    // are left out (they match no indexed document)
+    SparseVector createTFIDFVector(const std::string& text) const;
+    
+    // TF-IDF vector of an indexed document, without re-tokenizing it
+    SparseVector getDocumentVector(const std::string& documentId) const;
+    
+    // Term lookup
+    uint32_t lookupTerm(const std::string& term) const;
+    const std::string& getTerm(uint32_t termId) const { return terms[termId]; }
+    
+    // idf = log(N / (1 + df)), as in SimilarityMetrics::createTFIDFVector
+    double getIDF(uint32_t termId) const;
+    
+    // Statistics
+    size_t getDocumentCount() const { return documents.size(); }
+    size_t getTermCount() const { return terms.size(); }
+    uint32_t getDocumentFrequency(uint32_t termId) const { return documentFrequency[termId]; }
 };
 
 // ==================== TOPIC ANALYSIS ====================
@@ -61,7 +179,7 @@ struct Topic {
     std::vector<std::string> keywords;  // Sorted for binary search
     std::unordered_map<std::string, double> keywordWeights;
     std::vector<std::string> subTopics;
-    double relevanceScore;
+    double relevanceScore;      // Of the last proposal analyzed; see TopicAnalyzer::getTopicRelevance
     
     Topic() : relevanceScore(0.0) {}
     Topic(const std::string& id, const std::string& n) 
@@ -91,18 +209,53 @@ struct DecisionRanking {
 class TopicAnalyzer {
 private:
     std::unordered_map<std::string, Topic> topics;
-    std::unordered_map<std::string, std::vector<std::string>> proposalTopics;
+    
+    // Proposal -> matched topics with that proposal's relevance to each, and
+    // the topic set version they were matched against
+    struct ProposalTopic {
+        std::string topicId;
+        double relevance;
+    };
+    struct ProposalAnalysis {
+        std::vector<ProposalTopic> topics;
+        uint64_t topicsVersion;
+    };
+    std::unordered_map<std::string, ProposalAnalysis> proposalTopics;
+    uint64_t topicsVersion;     // Bumped by addTopic
+    
+    // Topics in the order they were added; the keyword table refers to them by slot
+    struct TopicSlot {
+        std::string topicId;
+        uint32_t keywordCount;  // distinct keywords
+    };
+    std::vector<TopicSlot> topicSlots;
+    std::unordered_map<std::string, uint32_t> topicSlotIndex;
+    
+    // Keyword -> every topic listing it, maintained by addTopic so a text is
+    // matched against all topics in a single pass over its tokens
+    struct KeywordTopic {
+        uint32_t topicSlot;
+        double weight;
+    };
+    std::unordered_map<std::string, std::vector<KeywordTopic>> keywordTable;
+    
+    // Keyword matches of one text against one topic
+    struct TopicMatch {
+        uint32_t topicSlot;
+        int matchCount;        // keyword occurrences in the text
+        int distinctMatches;   // distinct keywords in the text
+        double weightSum;
+    };
     
     // Binary search on sorted keyword vector
     bool keywordExists(const std::vector<std::string>& sortedKeywords, 
                       const std::string& keyword) const;
     
-    // Extract and decompose topics from text
-    std::vector<std::string> extractTopicsFromText(const std::string& text);
+    // Match text against every topic at once; topics without matches are omitted
+    std::vector<TopicMatch> matchTopics(const std::string& text, size_t& distinctTokens) const;
     
-    // Calculate topic relevance using similarity metrics
-    double calculateTopicRelevance(const std::string& proposalText, 
-                                   const Topic& topic);
+    // Calculate topic relevance from a text's keyword matches
+    double calculateTopicRelevance(const TopicMatch& match, size_t distinctTokens) const;
 
 public:
     TopicAnalyzer();
@@ -117,9 +270,18 @@ public:
     // Analyze proposal and assign topics
     void analyzeProposal(const std::shared_ptr<Proposal>& proposal);
     
+    // Forget a proposal's topic assignment
+    void removeProposal(const std::string& proposalId);
+    
     // Get topics for a proposal
     std::vector<std::string> getProposalTopics(const std::string& proposalId) const;
     
+    // Relevance of a proposal to one of its matched topics (0 if not matched)
+    double getTopicRelevance(const std::string& proposalId, const std::string& topicId) const;
+    
+    // True if the proposal is unknown or was analyzed before the last addTopic
+    bool needsAnalysis(const std::string& proposalId) const;
+    
     // Get all proposals for a topic
     std::vector<std::string> getProposalsForTopic(const std::string& topicId) const;
     
@@ -147,28 +309,44 @@ struct ClassificationLabel {
 
 class LogisticRegressionClassifier {
 private:
-    std::unordered_map<std::string, std::vector<double>> weights;  // label -> feature weights
+    // Multinomial (softmax) weights: one row per class, laid out like a
+    // feature row (featureNames, then a bias, zero-padded to rowStride)
+    std::vector<std::string> classLabels;
+    std::vector<double> weights;
+    size_t rowStride;
     std::vector<std::string> featureNames;
+    std::vector<double> featureMeans;   // Standardization from the training set
+    std::vector<double> featureScales;
     double learningRate;
-    int maxIterations;
+    int maxIterations;  // Maximum training epochs
+    size_t batchSize;
+    double tolerance;
+    int numThreads;
     
-    // Sigmoid function
-    double sigmoid(double z) const;
+    // Extract features from proposal into a padded row with the bias term
+    void extractFeatures(const Proposal& proposal, double* row) const;
+    std::vector<double> extractFeatures(const std::shared_ptr<Proposal>& proposal) const;
     
-    // Extract features from proposal
-    std::vector<double> extractFeatures(const std::shared_ptr<Proposal>& proposal);
+    // Softmax over class scores for one padded feature row
+    void calculateProbabilities(const double* row, double* probabilities) const;
     
-    // Calculate probability for a label
-    double calculateProbability(const std::vector<double>& features, 
-                               const std::string& label) const;
+    // Cross-entropy loss of rows, adding its gradient into gradient (classes × rowStride)
+    double accumulateGradient(const double* rows, const int* labels, size_t count,
+                              double* gradient, double* probabilities) const;
 
 public:
     LogisticRegressionClassifier(double lr = 0.01, int maxIter = 1000);
     
-    // Train the classifier
+    // Train the classifier: features are extracted once into a dense matrix,
+    // then mini-batch gradient descent runs until the loss stops improving
     void train(const std::vector<std::shared_ptr<Proposal>>& proposals,
               const std::vector<std::string>& labels);
     
+    // Training configuration
+    void setBatchSize(size_t size) { batchSize = std::max<size_t>(1, size); }
+    void setTolerance(double tol) { tolerance = tol; }
+    void setNumThreads(int threads) { numThreads = threads; }  // 0 = hardware concurrency
+    
     // Classify a proposal
     ClassificationLabel classify(const std::shared_ptr<Proposal>& proposal);
     
@@ -209,6 +387,9 @@ public:
     // Register proposal timestamp
     void registerProposal(const std::string& proposalId, const std::string& timestamp);
     
+    // Remove proposal timestamp
+    void unregisterProposal(const std::string& proposalId);
+    
     // Apply time-based filtering
     std::vector<std::string> filterByTime(const std::vector<std::string>& proposalIds,
                                          const TimeFilter& filter);
@@ -216,6 +397,12 @@ public:
     // Calculate time score for ranking
     double calculateTimeScore(const std::string& proposalId, const TimeFilter& filter);
     
+    // Proposal ages are counted in whole clock hours, so proposals created in
+    // the same hour share one time score at any moment
+    static long long currentHour();
+    bool getCreationHour(const std::string& proposalId, long long& hour) const;
+    static double timeScoreForHours(long long hours, double decayFactor);
+    
     // Get recent proposals
     std::vector<std::string> getRecentProposals(int hours = 24);
     
@@ -223,6 +410,115 @@ public:
     std::vector<std::string> getTrendingProposals(int hours = 6);
 };
 
+// ==================== SIMILARITY INDEX ====================
+
+// Top-k most similar proposals per proposal, using the score of
+// SimilarityMetrics::combinedSimilarity (Jaccard on word sets plus cosine on
+// word counts). Built as a sparse product of the word-count matrix with its
+// transpose: candidates come from shared-term postings, accumulated over
+// column tiles on worker threads, and only neighbors above the threshold
+// are kept, in CSR form.
+//
+// Proposals can then be added, edited or removed one at a time: only the
+// changed row, the rows that listed it and the rows it now enters are
+// touched. Changed rows live beside the CSR until enough accumulate to
+// compact them back in.
+class SimilarityIndex {
+private:
+    struct Posting {
+        uint32_t row;
+        float count;
+    };
+    
+    typedef std::vector<std::pair<float, uint32_t>> NeighborList;  // (score, row), best first
+    
+    // Per-thread scratch space for computing one row
+    struct RowWorkspace {
+        std::vector<uint32_t> shared;
+        std::vector<double> dot;
+        std::vector<uint32_t> touched;
+        std::vector<size_t> cursors;
+        std::vector<uint32_t> candidateTerms;   // Positions in the row vector
+        std::vector<uint32_t> frequentTerms;
+    };
+    
+    size_t maxNeighbors;
+    double minSimilarity;
+    int numThreads;
+    
+    // Word-count vectors, one row per proposal; removed rows are empty and
+    // reused once a compaction has run
+    std::vector<std::string> proposalIds;
+    std::unordered_map<std::string, uint32_t> rowIds;
+    std::unordered_map<std::string, uint32_t> termIds;
+    std::vector<SparseVector> rowVectors;
+    std::vector<std::vector<Posting>> postings;     // Term -> rows, ascending
+    std::vector<uint32_t> freeRows;
+    std::vector<uint32_t> releasedRows;             // Removed since the last compaction
+    
+    // Neighbors of row r: [neighborOffsets[r], neighborOffsets[r + 1]), most similar first,
+    // unless the row has been replaced in patchedRows since the last compaction
+    std::vector<size_t> neighborOffsets;
+    std::vector<uint32_t> neighborRows;
+    std::vector<float> neighborScores;
+    std::unordered_map<uint32_t, NeighborList> patchedRows;
+    
+    // Row -> rows whose neighbor list contains it, ascending
+    std::vector<std::vector<uint32_t>> listedBy;
+    
+    // Word counts of a proposal's title and description
+    SparseVector countTerms(const std::shared_ptr<Proposal>& proposal);
+    
+    // Terms in more proposals than this do not generate candidate pairs
+    size_t frequentTermLimit() const;
+    
+    // Score row against every row sharing a candidate term and keep the best;
+    // every candidate's score is also reported to allScores if given
+    void computeRow(uint32_t row, RowWorkspace& workspace, NeighborList& best,
+                    NeighborList* allScores = nullptr) const;
+    
+    void addPostings(uint32_t row);
+    void removePostings(uint32_t row);
+    
+    // Neighbor list access across the CSR and patched rows; writeRow keeps
+    // listedBy in step
+    void readRow(uint32_t row, NeighborList& out) const;
+    void writeRow(uint32_t row, NeighborList list);
+    void compact();
+    
+    // Scores stored for a row pair, or -1 if the row does not list the other
+    float storedScore(uint32_t row, uint32_t other) const;
+
+public:
+    SimilarityIndex(size_t maxNeighbors = 32, double minSimilarity = 0.0, int numThreads = 0);
+    
+    // Neighbor selection: at most maxNeighbors per proposal, scores above minSimilarity
+    // (takes effect at the next build)
+    void setNeighborLimits(size_t maxNeighbors, double minSimilarity);
+    void setNumThreads(int threads) { numThreads = threads; }  // 0 = hardware concurrency
+    
+    // Rebuild from scratch for a set of proposals
+    void build(const std::vector<std::shared_ptr<Proposal>>& proposals);
+    
+    // Add a proposal, or re-index it after its text changed
+    void addProposal(const std::shared_ptr<Proposal>& proposal);
+    
+    // Remove a proposal; returns false if it is not indexed
+    bool removeProposal(const std::string& proposalId);
+    
+    void clear();
+    
+    // Similarity of two proposals if either keeps the other as a neighbor, else 0
+    double getSimilarity(const std::string& proposalId1, const std::string& proposalId2) const;
+    
+    // Neighbors of a proposal, most similar first
+    std::vector<std::pair<std::string, double>> getNeighbors(const std::string& proposalId) const;
+    
+    bool hasProposal(const std::string& proposalId) const { return rowIds.count(proposalId) > 0; }
+    size_t getProposalCount() const { return rowIds.size(); }
+    size_t getNeighborCount() const;
+};
+
 // ==================== DECISION RANKING ENGINE ====================
 
 class DecisionRankingEngine {
@@ -231,11 +527,48 @@ private:
     LogisticRegressionClassifier classifier;
     TimeBasedFilter timeFilter;
     
-    // Priority queue for rankings (max heap)
-    std::priority_queue<DecisionRanking> rankingQueue;
+    // Ranking index: creation hour -> (score without the time term, proposal ID),
+    // best first. Proposals created in the same hour share a time score, so each
+    // bucket stays in order as time passes; queries add each bucket's time term
+    // and merge the buckets.
+    typedef std::set<std::pair<double, std::string>, std::greater<std::pair<double, std::string>>> RankingBucket;
+    std::map<long long, RankingBucket> rankingIndex;
+    size_t rankedCount;
+    
+    struct RankingEntry {
+        DecisionRanking ranking;    // timeScore and combinedScore are filled in per query
+        double baseScore;
+        long long creationHour;     // kUntimedHour without a timestamp
+    };
+    std::unordered_map<std::string, RankingEntry> rankingEntries;
+    
+    static constexpr long long kUntimedHour = LLONG_MIN;
+    
+    // What each proposal looked like when last indexed, to detect changes
+    struct ProposalSnapshot {
+        size_t textHash;
+        int voteCount;
+        size_t voterCount;
+    };
+    std::unordered_map<std::string, ProposalSnapshot> proposalSnapshots;
+    
+    // Top-k proposal similarities
+    SimilarityIndex similarityIndex;
+    
+    // Document frequencies of the proposal texts, kept in step with similarityIndex
+    CorpusIndex corpusIndex;
+    
+    static ProposalSnapshot takeSnapshot(const std::shared_ptr<Proposal>& proposal);
     
-    // Similarity matrix for proposals
-    std::unordered_map<std::string, std::unordered_map<std::string, double>> similarityMatrix;
+    // Score a proposal over its matched topics and (re)place it in the ranking index
+    void updateRankingEntry(const std::shared_ptr<Proposal>& proposal);
+    void removeRankingEntry(const std::string& proposalId);
+    
+    // Time score of a ranking bucket at the given hour
+    double bucketTimeScore(long long creationHour, long long nowHour) const;
+    
+    // Entry with the time term applied at the given hour
+    DecisionRanking scoredRanking(const RankingEntry& entry, long long nowHour) const;
     
     // Calculate weighted relevance score
     double calculateWeightedRelevance(const std::shared_ptr<Proposal>& proposal,
@@ -268,11 +601,28 @@ public:
     // Get decision ranking for specific proposal
     DecisionRanking getProposalRanking(const std::string& proposalId);
     
-    // Get similarity between two proposals
+    // Get similarity between two proposals (0 unless one is a top neighbor of the other)
     double getProposalSimilarity(const std::string& proposalId1, 
                                 const std::string& proposalId2);
     
-    // Update rankings with new data
+    // Get the most similar proposals to one proposal
+    std::vector<std::pair<std::string, double>> getSimilarProposals(const std::string& proposalId) const;
+    
+    // TF-IDF vector of a ranked proposal, from its indexed terms (empty if unknown)
+    SparseVector getProposalTFIDFVector(const std::string& proposalId) const;
+    
+    // TF-IDF vector of any text against the ranked proposals
+    SparseVector createTFIDFVector(const std::string& text) const;
+    
+    // Add a proposal, or re-index it if its text or votes changed. Only its topic
+    // assignment, its similarity neighborhood and its ranking entry are touched.
+    void addOrUpdateProposal(const std::shared_ptr<Proposal>& proposal);
+    
+    // Remove a proposal from topics, similarities and rankings
+    bool removeProposal(const std::string& proposalId);
+    
+    // Update rankings with new data: proposals are added, re-indexed when changed,
+    // and removed when no longer in the list
     void updateRankings(const std::vector<std::shared_ptr<Proposal>>& proposals);
     
     // Get rank and percentile statistics
@@ -282,6 +632,8 @@ public:
     TopicAnalyzer& getTopicAnalyzer() { return topicAnalyzer; }
     LogisticRegressionClassifier& getClassifier() { return classifier; }
     TimeBasedFilter& getTimeFilter() { return timeFilter; }
+    SimilarityIndex& getSimilarityIndex() { return similarityIndex; }
+    const CorpusIndex& getCorpusIndex() const { return corpusIndex; }
 };
 
 // ==================== RANK AND PERCENTILE SYSTEM ====================
@@ -3,13 +3,21 @@
 #include "AdvancedAnalytics.h"
 #include "VotingSystem.h"
 #include "IntelligenceEngine.h"
+#include "ParallelFor.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
+#include <functional>
+#include <random>
+#include <thread>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#endif
 
 // ==================== TOPIC ANALYSIS ====================
 
-TopicAnalyzer::TopicAnalyzer() {
+TopicAnalyzer::TopicAnalyzer() : topicsVersion(0) {
     addTopic("TECH", "Technology", {"technology", "software", "hardware", "digital", "innovation", "ai", "machine", "learning"});
     addTopic("ENV", "Environment", {"environment", "climate", "sustainability", "green", "renewable", "pollution", "conservation"});
     addTopic("EDU", "Education", {"education", "school", "university", "learning", "teaching", "student", "academic"});
@@ -27,7 +35,45 @@ void TopicAnalyzer::addTopic(const std::string& topicId, const std::string& name
         topic.keywordWeights[keyword] = 1.0;
     }
     
+    // Replacing a topic keeps its slot but drops its old keywords from the table
+    uint32_t slot;
+    auto slotIt = topicSlotIndex.find(topicId);
+    if (slotIt != topicSlotIndex.end()) {
+        slot = slotIt->second;
+        for (const auto& keyword : topics[topicId].keywords) {
+            auto entry = keywordTable.find(keyword);
+            if (entry == keywordTable.end()) continue;
+            
+            auto& owners = entry->second;
+            owners.erase(std::remove_if(owners.begin(), owners.end(),
+                                        [slot](const KeywordTopic& owner) {
+                                            return owner.topicSlot == slot;
+                                        }),
+                         owners.end());
+            if (owners.empty()) {
+                keywordTable.erase(entry);
+            }
+        }
+    } else {
+        slot = static_cast<uint32_t>(topicSlots.size());
+        topicSlots.push_back({topicId, 0});
+        topicSlotIndex[topicId] = slot;
+    }
+    
+    uint32_t keywordCount = 0;
+    for (size_t i = 0; i < topic.keywords.size(); ++i) {
+        const std::string& keyword = topic.keywords[i];
+        if (i > 0 && keyword == topic.keywords[i - 1]) continue;
+        
+        keywordTable[keyword].push_back({slot, topic.keywordWeights[keyword]});
+        keywordCount++;
+    }
+    topicSlots[slot].keywordCount = keywordCount;
+    
     topics[topicId] = topic;
+    
+    // Any proposal may now match differently
+    topicsVersion++;
 }
 
 void TopicAnalyzer::decomposeTopicIntoSubTopics(const std::string& topicId, 
@@ -44,50 +90,55 @@ bool TopicAnalyzer::keywordExists(const std::vector<std::string>& sortedKeywords
                              NLPUtils::toLowerCase(keyword));
 }
 
-std::vector<std::string> TopicAnalyzer::extractTopicsFromText(const std::string& text) {
-    std::vector<std::string> matchedTopics;
-    auto tokens = NLPUtils::removeStopWords(NLPUtils::tokenize(text));
-    
-    for (const auto& pair : topics) {
-        const Topic& topic = pair.second;
-        int matchCount = 0;
+std::vector<TopicAnalyzer::TopicMatch> TopicAnalyzer::matchTopics(const std::string& text,
+                                                                  size_t& distinctTokens) const {
+    std::vector<std::string> tokens;
+    SimilarityMetrics::tokenizeContent(text, tokens);
+    std::sort(tokens.begin(), tokens.end());
+    
+    // One table lookup per distinct token; each hit carries the token's occurrences
+    std::vector<TopicMatch> hits;
+    distinctTokens = 0;
+    for (size_t i = 0; i < tokens.size(); ) {
+        size_t end = i + 1;
+        while (end < tokens.size() && tokens[end] == tokens[i]) end++;
+        int occurrences = static_cast<int>(end - i);
+        distinctTokens++;
         
-        for (const auto& token : tokens) {
-            if (keywordExists(topic.keywords, token)) {
-                matchCount++;
+        auto entry = keywordTable.find(tokens[i]);
+        if (entry != keywordTable.end()) {
+            for (const auto& owner : entry->second) {
+                hits.push_back({owner.topicSlot, occurrences, 1, owner.weight * occurrences});
             }
         }
-        
-        if (matchCount >= 2) {
-            matchedTopics.push_back(topic.topicId);
+        i = end;
+    }
+    
+    std::sort(hits.begin(), hits.end(), [](const TopicMatch& a, const TopicMatch& b) {
+        return a.topicSlot < b.topicSlot;
+    });
+    
+    std::vector<TopicMatch> matches;
+    for (const auto& hit : hits) {
+        if (!matches.empty() && matches.back().topicSlot == hit.topicSlot) {
+            TopicMatch& match = matches.back();
+            match.matchCount += hit.matchCount;
+            match.distinctMatches += hit.distinctMatches;
+            match.weightSum += hit.weightSum;
+        } else {
+            matches.push_back(hit);
         }
     }
     
-    return matchedTopics;
+    return matches;
 }
 
-double TopicAnalyzer::calculateTopicRelevance(const std::string& proposalText, 
-                                             const Topic& topic) {
-    auto tokens = NLPUtils::removeStopWords(NLPUtils::tokenize(proposalText));
-    std::set<std::string> tokenSet(tokens.begin(), tokens.end());
-    std::set<std::string> keywordSet(topic.keywords.begin(), topic.keywords.end());
-    
-    double jaccardSim = SimilarityMetrics::jaccardSimilarity(tokenSet, keywordSet);
-    
-    double weightedScore = 0.0;
-    int matchCount = 0;
-    
-    for (const auto& token : tokens) {
-        auto it = topic.keywordWeights.find(token);
-        if (it != topic.keywordWeights.end()) {
-            weightedScore += it->second;
-            matchCount++;
-        }
-    }
+double TopicAnalyzer::calculateTopicRelevance(const TopicMatch& match, size_t distinctTokens) const {
+    // Jaccard similarity of the text's distinct tokens and the topic's keywords
+    size_t unionSize = distinctTokens + topicSlots[match.topicSlot].keywordCount - match.distinctMatches;
+    double jaccardSim = unionSize > 0 ? static_cast<double>(match.distinctMatches) / unionSize : 0.0;
     
-    if (matchCount > 0) {
-        weightedScore /= matchCount;
-    }
+    double weightedScore = match.matchCount > 0 ? match.weightSum / match.matchCount : 0.0;
     
     return 0.6 * jaccardSim + 0.4 * weightedScore;
 }
@@ -96,29 +147,59 @@ void TopicAnalyzer::analyzeProposal(const std::shared_ptr<Proposal>& proposal) {
     std::string proposalText = proposal->getTitle() + " " + proposal->getDescription();
     std::string proposalId = proposal->getProposalId();
     
-    std::vector<std::string> matchedTopics = extractTopicsFromText(proposalText);
-    proposalTopics[proposalId] = matchedTopics;
+    size_t distinctTokens = 0;
+    ProposalAnalysis analysis;
+    analysis.topicsVersion = topicsVersion;
+    for (const auto& match : matchTopics(proposalText, distinctTokens)) {
+        if (match.matchCount < 2) continue;
+        
+        Topic& topic = topics[topicSlots[match.topicSlot].topicId];
+        topic.relevanceScore = calculateTopicRelevance(match, distinctTokens);
+        analysis.topics.push_back({topic.topicId, topic.relevanceScore});
+    }
     
-    for (const auto& topicId : matchedTopics) {
-        auto it = topics.find(topicId);
-        if (it != topics.end()) {
-            it->second.relevanceScore = calculateTopicRelevance(proposalText, it->second);
+    proposalTopics[proposalId] = std::move(analysis);
+}
+
+void TopicAnalyzer::removeProposal(const std::string& proposalId) {
+    proposalTopics.erase(proposalId);
+}
+
+std::vector<std::string> TopicAnalyzer::getProposalTopics(const std::string& proposalId) const {
+    std::vector<std::string> matched;
+    auto it = proposalTopics.find(proposalId);
+    if (it != proposalTopics.end()) {
+        for (const auto& topic : it->second.topics) {
+            matched.push_back(topic.topicId);
         }
     }
+    return matched;
 }
 
-std::vector<std::string> TopicAnalyzer::getProposalTopics(const std::string& proposalId) const {
+double TopicAnalyzer::getTopicRelevance(const std::string& proposalId, const std::string& topicId) const {
     auto it = proposalTopics.find(proposalId);
-    return (it != proposalTopics.end()) ? it->second : std::vector<std::string>();
+    if (it == proposalTopics.end()) return 0.0;
+    
+    for (const auto& topic : it->second.topics) {
+        if (topic.topicId == topicId) return topic.relevance;
+    }
+    return 0.0;
+}
+
+bool TopicAnalyzer::needsAnalysis(const std::string& proposalId) const {
+    auto it = proposalTopics.find(proposalId);
+    return it == proposalTopics.end() || it->second.topicsVersion != topicsVersion;
 }
 
 std::vector<std::string> TopicAnalyzer::getProposalsForTopic(const std::string& topicId) const {
     std::vector<std::string> proposals;
     
     for (const auto& pair : proposalTopics) {
-        const auto& topics = pair.second;
-        if (std::find(topics.begin(), topics.end(), topicId) != topics.end()) {
-            proposals.push_back(pair.first);
+        for (const auto& topic : pair.second.topics) {
+            if (topic.topicId == topicId) {
+                proposals.push_back(pair.first);
+                break;
+            }
         }
     }
     
@@ -148,104 +229,287 @@ std::vector<Topic> TopicAnalyzer::getAllTopics() const {
 
 // ==================== LOGISTIC REGRESSION CLASSIFIER ====================
 
+namespace {
+
+const size_t kGradientChunk = 64;         // Rows per partial gradient
+const size_t kMinChunksPerWorker = 4;     // Keeps per-batch synchronization amortized
+const size_t kMinRowsPerExtractor = 256;
+const int kEarlyStoppingPatience = 3;
+
+size_t paddedStride(size_t featureCount) {
+    return (featureCount + 1 + 3) / 4 * 4;  // Features, bias, padding
+}
+
+double dotProductScalar(const double* a, const double* b, size_t count) {
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void addScaledScalar(double* out, const double* x, double scale, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        out[i] += scale * x[i];
+    }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ADVANCED_ANALYTICS_X86_KERNELS 1
+
+__attribute__((target("avx2")))
+double dotProductAVX2(const double* a, const double* b, size_t count) {
+    __m256d sum = _mm256_setzero_pd();
+    for (size_t i = 0; i < count; i += 4) {
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+    }
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(sum), _mm256_extractf128_pd(sum, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+}
+
+__attribute__((target("avx2")))
+void addScaledAVX2(double* out, const double* x, double scale, size_t count) {
+    const __m256d s = _mm256_set1_pd(scale);
+    for (size_t i = 0; i < count; i += 4) {
+        __m256d sum = _mm256_add_pd(_mm256_loadu_pd(out + i), _mm256_mul_pd(s, _mm256_loadu_pd(x + i)));
+        _mm256_storeu_pd(out + i, sum);
+    }
+}
+#endif
+
+// Both kernels expect count to be a multiple of 4 (padded rows)
+double dotProduct(const double* a, const double* b, size_t count) {
+#ifdef ADVANCED_ANALYTICS_X86_KERNELS
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) return dotProductAVX2(a, b, count);
+#endif
+    return dotProductScalar(a, b, count);
+}
+
+void addScaled(double* out, const double* x, double scale, size_t count) {
+#ifdef ADVANCED_ANALYTICS_X86_KERNELS
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) {
+        addScaledAVX2(out, x, scale, count);
+        return;
+    }
+#endif
+    addScaledScalar(out, x, scale, count);
+}
+
+} // namespace
+
 LogisticRegressionClassifier::LogisticRegressionClassifier(double lr, int maxIter)
-    : learningRate(lr), maxIterations(maxIter) {
+    : learningRate(lr), maxIterations(maxIter), batchSize(32), tolerance(1e-4), numThreads(0) {
     
     featureNames = {
         "vote_count", "title_length", "description_length", 
         "keyword_density", "sentiment_score", "time_factor"
     };
+    rowStride = paddedStride(featureNames.size());
 }
 
-double LogisticRegressionClassifier::sigmoid(double z) const {
-    return 1.0 / (1.0 + std::exp(-z));
-}
-
-std::vector<double> LogisticRegressionClassifier::extractFeatures(
-    const std::shared_ptr<Proposal>& proposal) {
-    
-    std::vector<double> features;
+void LogisticRegressionClassifier::extractFeatures(const Proposal& proposal, double* row) const {
+    std::fill(row, row + rowStride, 0.0);
     
-    features.push_back(static_cast<double>(proposal->getVoteCount()) / 100.0);
-    features.push_back(static_cast<double>(proposal->getTitle().length()) / 100.0);
-    features.push_back(static_cast<double>(proposal->getDescription().length()) / 500.0);
+    row[0] = static_cast<double>(proposal.getVoteCount()) / 100.0;
+    row[1] = static_cast<double>(proposal.getTitle().length()) / 100.0;
+    row[2] = static_cast<double>(proposal.getDescription().length()) / 500.0;
     
     auto tokens = NLPUtils::removeStopWords(
-        NLPUtils::tokenize(proposal->getTitle() + " " + proposal->getDescription()));
-    double keywordDensity = static_cast<double>(tokens.size()) / 
-                           (proposal->getTitle().length() + proposal->getDescription().length());
-    features.push_back(keywordDensity * 100.0);
-    
-    features.push_back(0.5);
-    features.push_back(0.5);
-    
-    return features;
+        NLPUtils::tokenize(proposal.getTitle() + " " + proposal.getDescription()));
+    size_t textLength = proposal.getTitle().length() + proposal.getDescription().length();
+    double keywordDensity = static_cast<double>(tokens.size()) / std::max<size_t>(1, textLength);
+    row[3] = keywordDensity * 100.0;
+    
+    row[4] = 0.5;
+    row[5] = 0.5;
+    // Custom features (addFeature) have no extractor and stay 0
+    
+    size_t featureCount = featureNames.size();
+    if (featureMeans.size() == featureCount) {
+        for (size_t j = 0; j < featureCount; ++j) {
+            row[j] = (row[j] - featureMeans[j]) / featureScales[j];
+        }
+    }
+    row[featureCount] = 1.0;  // Bias
 }
 
-double LogisticRegressionClassifier::calculateProbability(
-    const std::vector<double>& features, 
-    const std::string& label) const {
+std::vector<double> LogisticRegressionClassifier::extractFeatures(
+    const std::shared_ptr<Proposal>& proposal) const {
     
-    auto it = weights.find(label);
-    if (it == weights.end() || it->second.size() != features.size()) {
-        return 0.5;
+    std::vector<double> row(rowStride);
+    extractFeatures(*proposal, row.data());
+    return row;
+}
+
+void LogisticRegressionClassifier::calculateProbabilities(const double* row, 
+                                                          double* probabilities) const {
+    size_t numClasses = classLabels.size();
+    double maxScore = -INFINITY;
+    for (size_t k = 0; k < numClasses; ++k) {
+        probabilities[k] = dotProduct(&weights[k * rowStride], row, rowStride);
+        maxScore = std::max(maxScore, probabilities[k]);
     }
     
-    double z = 0.0;
-    for (size_t i = 0; i < features.size(); ++i) {
-        z += features[i] * it->second[i];
+    double total = 0.0;
+    for (size_t k = 0; k < numClasses; ++k) {
+        probabilities[k] = std::exp(probabilities[k] - maxScore);
+        total += probabilities[k];
+    }
+    for (size_t k = 0; k < numClasses; ++k) {
+        probabilities[k] /= total;
+    }
+}
+
+double LogisticRegressionClassifier::accumulateGradient(const double* rows, const int* labels,
+                                                        size_t count, double* gradient,
+                                                        double* probabilities) const {
+    size_t numClasses = classLabels.size();
+    double loss = 0.0;
+    
+    for (size_t i = 0; i < count; ++i) {
+        const double* row = rows + i * rowStride;
+        calculateProbabilities(row, probabilities);
+        loss -= std::log(std::max(probabilities[labels[i]], 1e-300));
+        
+        // d(loss)/d(w_k) = (p_k - [k == label]) x
+        for (size_t k = 0; k < numClasses; ++k) {
+            double error = probabilities[k] - (static_cast<int>(k) == labels[i] ? 1.0 : 0.0);
+            addScaled(gradient + k * rowStride, row, error, rowStride);
+        }
     }
     
-    return sigmoid(z);
+    return loss;
 }
 
 void LogisticRegressionClassifier::train(
     const std::vector<std::shared_ptr<Proposal>>& proposals,
     const std::vector<std::string>& labels) {
     
-    if (proposals.size() != labels.size()) return;
+    if (proposals.size() != labels.size() || proposals.empty()) return;
     
     std::set<std::string> uniqueLabels(labels.begin(), labels.end());
-    for (const auto& label : uniqueLabels) {
-        weights[label] = std::vector<double>(featureNames.size(), 0.0);
+    classLabels.assign(uniqueLabels.begin(), uniqueLabels.end());
+    size_t numClasses = classLabels.size();
+    size_t numRows = proposals.size();
+    size_t featureCount = featureNames.size();
+    rowStride = paddedStride(featureCount);
+    featureMeans.clear();
+    featureScales.clear();
+    
+    int threads = numThreads > 0 ? numThreads
+                                 : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    
+    // Rows in a fixed shuffled order so each mini-batch mixes classes;
+    // features are extracted once, in parallel
+    std::vector<size_t> order(numRows);
+    std::iota(order.begin(), order.end(), 0);
+    std::mt19937_64 rng(42);
+    std::shuffle(order.begin(), order.end(), rng);
+    
+    std::vector<double> matrix(numRows * rowStride);
+    std::vector<int> rowLabels(numRows);
+    parallelFor(numRows, threads, kMinRowsPerExtractor, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            extractFeatures(*proposals[order[i]], &matrix[i * rowStride]);
+            rowLabels[i] = static_cast<int>(
+                std::lower_bound(classLabels.begin(), classLabels.end(), labels[order[i]]) - classLabels.begin());
+        }
+    });
+    
+    // Standardize features (the bias column is left alone); constant ones keep their value
+    featureMeans.assign(featureCount, 0.0);
+    featureScales.assign(featureCount, 1.0);
+    std::vector<double> column(numRows);
+    for (size_t j = 0; j < featureCount; ++j) {
+        for (size_t i = 0; i < numRows; ++i) {
+            column[i] = matrix[i * rowStride + j];
+        }
+        double mean = NormalizationUtils::calculateMean(column);
+        double stdDev = NormalizationUtils::calculateStdDev(column, mean);
+        if (stdDev < 1e-10) continue;
+        featureMeans[j] = mean;
+        featureScales[j] = stdDev;
+        for (size_t i = 0; i < numRows; ++i) {
+            matrix[i * rowStride + j] = (column[i] - mean) / stdDev;
+        }
     }
     
-    for (int iter = 0; iter < maxIterations; ++iter) {
-        for (size_t i = 0; i < proposals.size(); ++i) {
-            auto features = extractFeatures(proposals[i]);
-            const std::string& trueLabel = labels[i];
+    // Mini-batch gradient descent. Each batch's gradient is summed over
+    // fixed-size chunks, in chunk order, so results do not depend on the
+    // thread count; learningRate stays a per-sample rate.
+    weights.assign(numClasses * rowStride, 0.0);
+    size_t gradientSize = numClasses * rowStride;
+    size_t batchRows = std::min(batchSize, numRows);
+    size_t maxChunks = (batchRows + kGradientChunk - 1) / kGradientChunk;
+    size_t numBatches = (numRows + batchRows - 1) / batchRows;
+    
+    WorkerPool workers(static_cast<int>(
+        std::min<size_t>(threads, std::max<size_t>(1, maxChunks / kMinChunksPerWorker))));
+    std::vector<double> chunkGradients(maxChunks * gradientSize);
+    std::vector<double> chunkLosses(maxChunks);
+    std::vector<double> probabilities(workers.size() * numClasses);
+    std::vector<size_t> batchOrder(numBatches);
+    std::iota(batchOrder.begin(), batchOrder.end(), 0);
+    
+    double bestLoss = INFINITY;
+    int stalledEpochs = 0;
+    for (int epoch = 0; epoch < maxIterations; ++epoch) {
+        std::shuffle(batchOrder.begin(), batchOrder.end(), rng);
+        double epochLoss = 0.0;
+        
+        for (size_t batch : batchOrder) {
+            size_t begin = batch * batchRows;
+            size_t count = std::min(batchRows, numRows - begin);
+            size_t chunks = (count + kGradientChunk - 1) / kGradientChunk;
             
-            for (auto& weightPair : weights) {
-                const std::string& label = weightPair.first;
-                double predicted = calculateProbability(features, label);
-                double actual = (label == trueLabel) ? 1.0 : 0.0;
-                double error = actual - predicted;
-                
-                for (size_t j = 0; j < features.size(); ++j) {
-                    weightPair.second[j] += learningRate * error * features[j];
+            workers.parallelFor(chunks, 1, [&](size_t firstChunk, size_t lastChunk, size_t worker) {
+                for (size_t c = firstChunk; c < lastChunk; ++c) {
+                    size_t first = begin + c * kGradientChunk;
+                    size_t rows = std::min(kGradientChunk, begin + count - first);
+                    double* gradient = &chunkGradients[c * gradientSize];
+                    std::fill(gradient, gradient + gradientSize, 0.0);
+                    chunkLosses[c] = accumulateGradient(&matrix[first * rowStride], &rowLabels[first],
+                                                        rows, gradient, &probabilities[worker * numClasses]);
                 }
+            });
+            
+            for (size_t c = 1; c < chunks; ++c) {
+                addScaled(chunkGradients.data(), &chunkGradients[c * gradientSize], 1.0, gradientSize);
+            }
+            addScaled(weights.data(), chunkGradients.data(), -learningRate, gradientSize);
+            for (size_t c = 0; c < chunks; ++c) {
+                epochLoss += chunkLosses[c];
             }
         }
+        
+        // Early stopping once the mean loss stops improving
+        epochLoss /= numRows;
+        if (epochLoss < bestLoss - tolerance) {
+            bestLoss = epochLoss;
+            stalledEpochs = 0;
+        } else if (++stalledEpochs >= kEarlyStoppingPatience) {
+            break;
+        }
     }
 }
 
 ClassificationLabel LogisticRegressionClassifier::classify(
     const std::shared_ptr<Proposal>& proposal) {
     
-    auto features = extractFeatures(proposal);
-    
-    std::string bestLabel;
-    double maxProb = 0.0;
-    
-    for (const auto& pair : weights) {
-        double prob = calculateProbability(features, pair.first);
-        if (prob > maxProb) {
-            maxProb = prob;
-            bestLabel = pair.first;
-        }
+    if (classLabels.empty()) {
+        ClassificationLabel result("", 0.0);
+        result.features = featureNames;
+        return result;
     }
     
-    ClassificationLabel result(bestLabel, maxProb);
+    auto features = extractFeatures(proposal);
+    std::vector<double> probabilities(classLabels.size());
+    calculateProbabilities(features.data(), probabilities.data());
+    
+    size_t best = std::max_element(probabilities.begin(), probabilities.end()) - probabilities.begin();
+    ClassificationLabel result(classLabels[best], probabilities[best]);
     result.features = featureNames;
     
     return result;
@@ -254,20 +518,35 @@ ClassificationLabel LogisticRegressionClassifier::classify(
 std::unordered_map<std::string, double> LogisticRegressionClassifier::getClassProbabilities(
     const std::shared_ptr<Proposal>& proposal) {
     
+    std::unordered_map<std::string, double> result;
+    if (classLabels.empty()) return result;
+    
     auto features = extractFeatures(proposal);
-    std::unordered_map<std::string, double> probabilities;
+    std::vector<double> probabilities(classLabels.size());
+    calculateProbabilities(features.data(), probabilities.data());
     
-    for (const auto& pair : weights) {
-        probabilities[pair.first] = calculateProbability(features, pair.first);
+    for (size_t k = 0; k < classLabels.size(); ++k) {
+        result[classLabels[k]] = probabilities[k];
     }
     
-    return probabilities;
+    return result;
 }
 
 void LogisticRegressionClassifier::addFeature(const std::string& featureName) {
+    size_t oldStride = rowStride;
+    size_t oldCount = featureNames.size();
     featureNames.push_back(featureName);
+    rowStride = paddedStride(featureNames.size());
     
-    for (auto& pair : weights) {
-        pair.second.push_back(0.0);
+    // New zero weight before the bias; the feature is unscaled
+    std::vector<double> resized(classLabels.size() * rowStride, 0.0);
+    for (size_t k = 0; k < classLabels.size() && !weights.empty(); ++k) {
+        std::copy(&weights[k * oldStride], &weights[k * oldStride] + oldCount, &resized[k * rowStride]);
+        resized[k * rowStride + oldCount + 1] = weights[k * oldStride + oldCount];
+    }
+    weights.swap(resized);
+    if (!featureMeans.empty()) {
+        featureMeans.push_back(0.0);
+        featureScales.push_back(1.0);
     }
 }
@@ -2,11 +2,14 @@
 
 #include "AdvancedAnalytics.h"
 #include "VotingSystem.h"
+#include "ParallelFor.h"
 #include <iostream>
 #include <algorithm>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <iterator>
+#include <unordered_set>
 
 // ==================== TIME-BASED FILTERING ====================
 
@@ -21,10 +24,23 @@ double TimeBasedFilter::calculateTimeDecay(
     const std::chrono::system_clock::time_point& timestamp,
     double decayFactor) const {
     
-    auto now = std::chrono::system_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::hours>(now - timestamp);
-    double hours = duration.count();
-    
+    long long created = std::chrono::duration_cast<std::chrono::hours>(timestamp.time_since_epoch()).count();
+    return timeScoreForHours(currentHour() - created, decayFactor);
+}
+
+long long TimeBasedFilter::currentHour() {
+    return std::chrono::duration_cast<std::chrono::hours>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+bool TimeBasedFilter::getCreationHour(const std::string& proposalId, long long& hour) const {
+    auto it = proposalTimestamps.find(proposalId);
+    if (it == proposalTimestamps.end()) return false;
+    hour = std::chrono::duration_cast<std::chrono::hours>(it->second.time_since_epoch()).count();
+    return true;
+}
+
+double TimeBasedFilter::timeScoreForHours(long long hours, double decayFactor) {
     return std::exp(-decayFactor * hours / 24.0);
 }
 
@@ -33,6 +49,10 @@ void TimeBasedFilter::registerProposal(const std::string& proposalId,
     proposalTimestamps[proposalId] = parseTimestamp(timestamp);
 }
 
+void TimeBasedFilter::unregisterProposal(const std::string& proposalId) {
+    proposalTimestamps.erase(proposalId);
+}
+
 std::vector<std::string> TimeBasedFilter::filterByTime(
     const std::vector<std::string>& proposalIds,
     const TimeFilter& filter) {
@@ -82,35 +102,564 @@ std::vector<std::string> TimeBasedFilter::getTrendingProposals(int hours) {
     return getRecentProposals(hours);
 }
 
+// ==================== SIMILARITY INDEX ====================
+
+namespace {
+
+const uint32_t kColumnTile = 16384;         // Accumulator columns per pass (~200 KB)
+const uint32_t kRowChunk = 64;              // Rows handed to a worker at a time
+const size_t kMinFrequentTermRows = 1000;   // Below this, every term generates candidates
+const double kFrequentTermRatio = 0.05;
+const size_t kMinPatchedRows = 64;          // Patched rows tolerated before compaction
+
+// Neighbor order: higher score first, then lower row
+bool betterNeighbor(const std::pair<float, uint32_t>& a, const std::pair<float, uint32_t>& b) {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+} // namespace
+
+SimilarityIndex::SimilarityIndex(size_t maxNeighbors, double minSimilarity, int numThreads)
+    : maxNeighbors(maxNeighbors), minSimilarity(minSimilarity), numThreads(numThreads) {
+    neighborOffsets.push_back(0);
+}
+
+void SimilarityIndex::setNeighborLimits(size_t neighbors, double similarity) {
+    maxNeighbors = neighbors;
+    minSimilarity = similarity;
+}
+
+void SimilarityIndex::clear() {
+    proposalIds.clear();
+    rowIds.clear();
+    termIds.clear();
+    rowVectors.clear();
+    postings.clear();
+    freeRows.clear();
+    releasedRows.clear();
+    neighborOffsets.assign(1, 0);
+    neighborRows.clear();
+    neighborScores.clear();
+    patchedRows.clear();
+    listedBy.clear();
+}
+
+SparseVector SimilarityIndex::countTerms(const std::shared_ptr<Proposal>& proposal) {
+    std::vector<std::string> tokens;
+    SimilarityMetrics::tokenizeWords(proposal->getTitle() + " " + proposal->getDescription(), tokens);
+    
+    std::vector<uint32_t> ids;
+    ids.reserve(tokens.size());
+    for (auto& token : tokens) {
+        auto inserted = termIds.emplace(std::move(token), static_cast<uint32_t>(termIds.size()));
+        if (inserted.second) {
+            postings.emplace_back();
+        }
+        ids.push_back(inserted.first->second);
+    }
+    std::sort(ids.begin(), ids.end());
+    
+    SparseVector vec;
+    for (size_t i = 0; i < ids.size(); ) {
+        size_t j = i;
+        while (j < ids.size() && ids[j] == ids[i]) j++;
+        vec.indices.push_back(ids[i]);
+        vec.values.push_back(static_cast<float>(j - i));
+        i = j;
+    }
+    vec.computeNorm();
+    return vec;
+}
+
+size_t SimilarityIndex::frequentTermLimit() const {
+    // Terms in a large share of proposals (stop words, mostly) would make every
+    // pair a candidate. They still count toward the score of candidate pairs,
+    // but a pair sharing only such terms is not found.
+    return std::max(kMinFrequentTermRows, static_cast<size_t>(kFrequentTermRatio * rowIds.size()));
+}
+
+void SimilarityIndex::computeRow(uint32_t row, RowWorkspace& workspace, NeighborList& best,
+                                 NeighborList* allScores) const {
+    best.clear();
+    if (allScores) allScores->clear();
+    const SparseVector& vec = rowVectors[row];
+    if (vec.empty() || maxNeighbors == 0) return;
+    
+    const uint32_t numRows = static_cast<uint32_t>(proposalIds.size());
+    size_t frequentLimit = frequentTermLimit();
+    workspace.candidateTerms.clear();
+    workspace.frequentTerms.clear();
+    for (uint32_t k = 0; k < vec.size(); ++k) {
+        bool frequent = postings[vec.indices[k]].size() > frequentLimit;
+        (frequent ? workspace.frequentTerms : workspace.candidateTerms).push_back(k);
+    }
+    
+    uint32_t tile = std::min(kColumnTile, numRows);
+    if (workspace.shared.size() < tile) {
+        workspace.shared.assign(tile, 0);
+        workspace.dot.assign(tile, 0.0);
+    }
+    workspace.cursors.assign(workspace.candidateTerms.size(), 0);
+    
+    // Row × transposed matrix, one column tile at a time
+    for (uint32_t tileBegin = 0; tileBegin < numRows; tileBegin += tile) {
+        uint32_t tileEnd = std::min(numRows, tileBegin + tile);
+        workspace.touched.clear();
+        
+        for (size_t c = 0; c < workspace.candidateTerms.size(); ++c) {
+            uint32_t k = workspace.candidateTerms[c];
+            const std::vector<Posting>& list = postings[vec.indices[k]];
+            size_t& cursor = workspace.cursors[c];
+            for (; cursor < list.size() && list[cursor].row < tileEnd; ++cursor) {
+                if (list[cursor].row == row) continue;
+                uint32_t column = list[cursor].row - tileBegin;
+                if (workspace.shared[column]++ == 0) workspace.touched.push_back(column);
+                workspace.dot[column] += static_cast<double>(vec.values[k]) * list[cursor].count;
+            }
+        }
+        
+        for (uint32_t column : workspace.touched) {
+            uint32_t other = tileBegin + column;
+            const SparseVector& otherVec = rowVectors[other];
+            size_t shared = workspace.shared[column];
+            double dot = workspace.dot[column];
+            workspace.shared[column] = 0;
+            workspace.dot[column] = 0.0;
+            
+            // Frequent terms only add to pairs that are already candidates
+            for (uint32_t k : workspace.frequentTerms) {
+                auto it = std::lower_bound(otherVec.indices.begin(), otherVec.indices.end(), vec.indices[k]);
+                if (it != otherVec.indices.end() && *it == vec.indices[k]) {
+                    shared++;
+                    dot += static_cast<double>(vec.values[k]) * otherVec.values[it - otherVec.indices.begin()];
+                }
+            }
+            
+            // Same weighting as combinedSimilarity's defaults
+            double jaccard = static_cast<double>(shared) / (vec.size() + otherVec.size() - shared);
+            double cosine = dot / (vec.norm * otherVec.norm);
+            float score = static_cast<float>(0.5 * jaccard + 0.5 * cosine);
+            if (allScores) allScores->emplace_back(score, other);
+            if (score <= minSimilarity) continue;
+            
+            // Min-heap of the best maxNeighbors seen so far
+            std::pair<float, uint32_t> candidate(score, other);
+            if (best.size() < maxNeighbors) {
+                best.push_back(candidate);
+                std::push_heap(best.begin(), best.end(), betterNeighbor);
+            } else if (betterNeighbor(candidate, best.front())) {
+                std::pop_heap(best.begin(), best.end(), betterNeighbor);
+                best.back() = candidate;
+                std::push_heap(best.begin(), best.end(), betterNeighbor);
+            }
+        }
+    }
+    
+    std::sort(best.begin(), best.end(), betterNeighbor);
+}
+
+void SimilarityIndex::build(const std::vector<std::shared_ptr<Proposal>>& proposals) {
+    clear();
+    
+    for (const auto& proposal : proposals) {
+        if (!rowIds.emplace(proposal->getProposalId(), static_cast<uint32_t>(proposalIds.size())).second) {
+            continue;
+        }
+        proposalIds.push_back(proposal->getProposalId());
+        rowVectors.push_back(countTerms(proposal));
+        
+        const SparseVector& vec = rowVectors.back();
+        for (size_t k = 0; k < vec.size(); ++k) {
+            postings[vec.indices[k]].push_back({static_cast<uint32_t>(proposalIds.size() - 1), vec.values[k]});
+        }
+    }
+    
+    const uint32_t numRows = static_cast<uint32_t>(proposalIds.size());
+    std::vector<NeighborList> lists(numRows);
+    
+    WorkerPool workers(parallelWorkerCount(numThreads, numRows, 256));
+    std::vector<RowWorkspace> workspaces(workers.size());
+    workers.parallelFor(numRows, kRowChunk, [&](size_t begin, size_t end, size_t worker) {
+        for (size_t row = begin; row < end; ++row) {
+            computeRow(static_cast<uint32_t>(row), workspaces[worker], lists[row]);
+        }
+    });
+    
+    // Compact into CSR, in row order
+    neighborOffsets.assign(numRows + 1, 0);
+    for (uint32_t r = 0; r < numRows; ++r) {
+        neighborOffsets[r + 1] = neighborOffsets[r] + lists[r].size();
+    }
+    neighborRows.resize(neighborOffsets[numRows]);
+    neighborScores.resize(neighborOffsets[numRows]);
+    listedBy.assign(numRows, std::vector<uint32_t>());
+    for (uint32_t r = 0; r < numRows; ++r) {
+        for (size_t k = 0; k < lists[r].size(); ++k) {
+            neighborRows[neighborOffsets[r] + k] = lists[r][k].second;
+            neighborScores[neighborOffsets[r] + k] = lists[r][k].first;
+            listedBy[lists[r][k].second].push_back(r);
+        }
+    }
+}
+
+void SimilarityIndex::addPostings(uint32_t row) {
+    const SparseVector& vec = rowVectors[row];
+    for (size_t k = 0; k < vec.size(); ++k) {
+        std::vector<Posting>& list = postings[vec.indices[k]];
+        auto it = std::lower_bound(list.begin(), list.end(), row,
+                                   [](const Posting& p, uint32_t r) { return p.row < r; });
+        list.insert(it, {row, vec.values[k]});
+    }
+}
+
+void SimilarityIndex::removePostings(uint32_t row) {
+    const SparseVector& vec = rowVectors[row];
+    for (size_t k = 0; k < vec.size(); ++k) {
+        std::vector<Posting>& list = postings[vec.indices[k]];
+        auto it = std::lower_bound(list.begin(), list.end(), row,
+                                   [](const Posting& p, uint32_t r) { return p.row < r; });
+        if (it != list.end() && it->row == row) list.erase(it);
+    }
+}
+
+void SimilarityIndex::readRow(uint32_t row, NeighborList& out) const {
+    out.clear();
+    auto patched = patchedRows.find(row);
+    if (patched != patchedRows.end()) {
+        out = patched->second;
+    } else if (row + 1 < neighborOffsets.size()) {
+        for (size_t k = neighborOffsets[row]; k < neighborOffsets[row + 1]; ++k) {
+            out.emplace_back(neighborScores[k], neighborRows[k]);
+        }
+    }
+}
+
+void SimilarityIndex::writeRow(uint32_t row, NeighborList list) {
+    // Move row between the listedBy entries of the neighbors it drops and gains
+    NeighborList old;
+    readRow(row, old);
+    std::vector<uint32_t> before, after;
+    for (const auto& neighbor : old) before.push_back(neighbor.second);
+    for (const auto& neighbor : list) after.push_back(neighbor.second);
+    std::sort(before.begin(), before.end());
+    std::sort(after.begin(), after.end());
+    
+    std::vector<uint32_t> changed;
+    std::set_difference(before.begin(), before.end(), after.begin(), after.end(), std::back_inserter(changed));
+    for (uint32_t other : changed) {
+        std::vector<uint32_t>& listing = listedBy[other];
+        auto it = std::lower_bound(listing.begin(), listing.end(), row);
+        if (it != listing.end() && *it == row) listing.erase(it);
+    }
+    changed.clear();
+    std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(changed));
+    for (uint32_t other : changed) {
+        std::vector<uint32_t>& listing = listedBy[other];
+        listing.insert(std::lower_bound(listing.begin(), listing.end(), row), row);
+    }
+    
+    patchedRows[row] = std::move(list);
+    if (patchedRows.size() > std::max(kMinPatchedRows, proposalIds.size() / 4)) {
+        compact();
+    }
+}
+
+void SimilarityIndex::compact() {
+    const uint32_t numRows = static_cast<uint32_t>(proposalIds.size());
+    std::vector<size_t> offsets(numRows + 1, 0);
+    std::vector<uint32_t> rows;
+    std::vector<float> scores;
+    rows.reserve(neighborRows.size());
+    scores.reserve(neighborScores.size());
+    
+    NeighborList list;
+    for (uint32_t r = 0; r < numRows; ++r) {
+        readRow(r, list);
+        for (const auto& neighbor : list) {
+            rows.push_back(neighbor.second);
+            scores.push_back(neighbor.first);
+        }
+        offsets[r + 1] = rows.size();
+    }
+    
+    neighborOffsets.swap(offsets);
+    neighborRows.swap(rows);
+    neighborScores.swap(scores);
+    patchedRows.clear();
+    
+    // No list refers to a row removed before now
+    freeRows.insert(freeRows.end(), releasedRows.begin(), releasedRows.end());
+    releasedRows.clear();
+}
+
+void SimilarityIndex::addProposal(const std::shared_ptr<Proposal>& proposal) {
+    const std::string& proposalId = proposal->getProposalId();
+    std::vector<uint32_t> affected;
+    uint32_t row;
+    
+    auto it = rowIds.find(proposalId);
+    if (it != rowIds.end()) {
+        row = it->second;
+        affected = listedBy[row];
+        removePostings(row);
+    } else if (!freeRows.empty()) {
+        row = freeRows.back();
+        freeRows.pop_back();
+        proposalIds[row] = proposalId;
+        rowIds[proposalId] = row;
+    } else {
+        row = static_cast<uint32_t>(proposalIds.size());
+        proposalIds.push_back(proposalId);
+        rowVectors.emplace_back();
+        listedBy.emplace_back();
+        rowIds[proposalId] = row;
+    }
+    
+    rowVectors[row] = countTerms(proposal);
+    addPostings(row);
+    
+    RowWorkspace workspace;
+    NeighborList list, scores;
+    computeRow(row, workspace, list, &scores);
+    writeRow(row, list);
+    
+    // Rows that listed the old text may now prefer other proposals
+    for (uint32_t other : affected) {
+        computeRow(other, workspace, list);
+        writeRow(other, list);
+    }
+    
+    // Every other candidate keeps its list and may take this row in
+    for (const auto& scored : scores) {
+        uint32_t other = scored.second;
+        if (scored.first <= minSimilarity || std::binary_search(affected.begin(), affected.end(), other)) {
+            continue;
+        }
+        
+        readRow(other, list);
+        list.erase(std::remove_if(list.begin(), list.end(),
+                                  [row](const std::pair<float, uint32_t>& n) { return n.second == row; }),
+                   list.end());
+        std::pair<float, uint32_t> candidate(scored.first, row);
+        if (list.size() >= maxNeighbors && !betterNeighbor(candidate, list.back())) continue;
+        
+        list.insert(std::lower_bound(list.begin(), list.end(), candidate, betterNeighbor), candidate);
+        if (list.size() > maxNeighbors) list.pop_back();
+        writeRow(other, list);
+    }
+}
+
+bool SimilarityIndex::removeProposal(const std::string& proposalId) {
+    auto it = rowIds.find(proposalId);
+    if (it == rowIds.end()) return false;
+    
+    uint32_t row = it->second;
+    std::vector<uint32_t> affected = listedBy[row];
+    removePostings(row);
+    rowVectors[row] = SparseVector();
+    proposalIds[row].clear();
+    rowIds.erase(it);
+    writeRow(row, NeighborList());
+    
+    RowWorkspace workspace;
+    NeighborList list;
+    for (uint32_t other : affected) {
+        computeRow(other, workspace, list);
+        writeRow(other, list);
+    }
+    
+    // Reusable once a compaction has run after every list dropped it
+    releasedRows.push_back(row);
+    return true;
+}
+
+float SimilarityIndex::storedScore(uint32_t row, uint32_t other) const {
+    auto patched = patchedRows.find(row);
+    if (patched != patchedRows.end()) {
+        for (const auto& neighbor : patched->second) {
+            if (neighbor.second == other) return neighbor.first;
+        }
+        return -1.0f;
+    }
+    if (row + 1 >= neighborOffsets.size()) return -1.0f;
+    
+    for (size_t k = neighborOffsets[row]; k < neighborOffsets[row + 1]; ++k) {
+        if (neighborRows[k] == other) return neighborScores[k];
+    }
+    return -1.0f;
+}
+
+double SimilarityIndex::getSimilarity(const std::string& proposalId1,
+                                      const std::string& proposalId2) const {
+    auto it1 = rowIds.find(proposalId1);
+    auto it2 = rowIds.find(proposalId2);
+    if (it1 == rowIds.end() || it2 == rowIds.end() || it1->second == it2->second) return 0.0;
+    
+    // Top-k lists are not symmetric: the pair may be kept by either row
+    float score = storedScore(it1->second, it2->second);
+    if (score < 0.0f) score = storedScore(it2->second, it1->second);
+    return std::max(0.0f, score);
+}
+
+std::vector<std::pair<std::string, double>> SimilarityIndex::getNeighbors(
+    const std::string& proposalId) const {
+    
+    std::vector<std::pair<std::string, double>> neighbors;
+    auto it = rowIds.find(proposalId);
+    if (it == rowIds.end()) return neighbors;
+    
+    NeighborList list;
+    readRow(it->second, list);
+    for (const auto& neighbor : list) {
+        if (!proposalIds[neighbor.second].empty()) {
+            neighbors.emplace_back(proposalIds[neighbor.second], neighbor.first);
+        }
+    }
+    return neighbors;
+}
+
+size_t SimilarityIndex::getNeighborCount() const {
+    size_t count = neighborRows.size();
+    for (const auto& patched : patchedRows) {
+        if (patched.first + 1 < neighborOffsets.size()) {
+            count -= neighborOffsets[patched.first + 1] - neighborOffsets[patched.first];
+        }
+        count += patched.second.size();
+    }
+    return count;
+}
+
 // ==================== DECISION RANKING ENGINE ====================
 
-DecisionRankingEngine::DecisionRankingEngine() {}
+DecisionRankingEngine::DecisionRankingEngine() : rankedCount(0) {}
 
 void DecisionRankingEngine::initialize(
     const std::vector<std::shared_ptr<Proposal>>& proposals) {
     
+    rankingIndex.clear();
+    rankedCount = 0;
+    rankingEntries.clear();
+    proposalSnapshots.clear();
+    
     for (const auto& proposal : proposals) {
         topicAnalyzer.analyzeProposal(proposal);
         timeFilter.registerProposal(proposal->getProposalId(), 
                                     proposal->getCreationTimestamp());
+        proposalSnapshots[proposal->getProposalId()] = takeSnapshot(proposal);
     }
     
     buildSimilarityMatrix(proposals);
+    
+    for (const auto& proposal : proposals) {
+        updateRankingEntry(proposal);
+    }
+}
+
+DecisionRankingEngine::ProposalSnapshot DecisionRankingEngine::takeSnapshot(
+    const std::shared_ptr<Proposal>& proposal) {
+    
+    ProposalSnapshot snapshot;
+    snapshot.textHash = std::hash<std::string>()(proposal->getTitle() + "\n" + proposal->getDescription());
+    snapshot.voteCount = proposal->getVoteCount();
+    snapshot.voterCount = proposal->getVoters().size();
+    return snapshot;
+}
+
+void DecisionRankingEngine::updateRankingEntry(const std::shared_ptr<Proposal>& proposal) {
+    const std::string& proposalId = proposal->getProposalId();
+    removeRankingEntry(proposalId);
+    
+    // The time term changes as the proposal ages, so it stays out of the key
+    RankingEntry entry;
+    DecisionRanking& ranking = entry.ranking;
+    ranking.proposalId = proposalId;
+    ranking.title = proposal->getTitle();
+    ranking.matchedTopics = topicAnalyzer.getProposalTopics(proposalId);
+    ranking.weightedRelevance = calculateWeightedRelevance(proposal, ranking.matchedTopics);
+    ranking.priorityScore = calculatePriorityScore(proposal);
+    entry.baseScore = 0.4 * ranking.weightedRelevance + 0.3 * ranking.priorityScore;
+    if (!timeFilter.getCreationHour(proposalId, entry.creationHour)) {
+        entry.creationHour = kUntimedHour;
+    }
+    
+    rankingIndex[entry.creationHour].emplace(entry.baseScore, proposalId);
+    rankedCount++;
+    rankingEntries[proposalId] = std::move(entry);
+}
+
+void DecisionRankingEngine::removeRankingEntry(const std::string& proposalId) {
+    auto it = rankingEntries.find(proposalId);
+    if (it == rankingEntries.end()) return;
+    
+    auto bucket = rankingIndex.find(it->second.creationHour);
+    bucket->second.erase(std::make_pair(it->second.baseScore, proposalId));
+    if (bucket->second.empty()) {
+        rankingIndex.erase(bucket);
+    }
+    rankedCount--;
+    rankingEntries.erase(it);
+}
+
+double DecisionRankingEngine::bucketTimeScore(long long creationHour, long long nowHour) const {
+    if (creationHour == kUntimedHour) {
+        return 0.5;     // As calculateTimeScore for an unregistered proposal
+    }
+    return TimeBasedFilter::timeScoreForHours(nowHour - creationHour, TimeFilter().decayFactor);
+}
+
+DecisionRanking DecisionRankingEngine::scoredRanking(const RankingEntry& entry, long long nowHour) const {
+    DecisionRanking ranking = entry.ranking;
+    ranking.timeScore = bucketTimeScore(entry.creationHour, nowHour);
+    ranking.combinedScore = entry.baseScore + 0.3 * ranking.timeScore;
+    return ranking;
+}
+
+void DecisionRankingEngine::addOrUpdateProposal(const std::shared_ptr<Proposal>& proposal) {
+    const std::string& proposalId = proposal->getProposalId();
+    ProposalSnapshot snapshot = takeSnapshot(proposal);
+    
+    auto it = proposalSnapshots.find(proposalId);
+    bool isNew = it == proposalSnapshots.end();
+    bool textChanged = isNew || it->second.textHash != snapshot.textHash;
+    bool topicsChanged = topicAnalyzer.needsAnalysis(proposalId);    // addTopic since last analysis
+    if (!textChanged && !topicsChanged && it->second.voteCount == snapshot.voteCount &&
+        it->second.voterCount == snapshot.voterCount) {
+        return;
+    }
+    
+    if (textChanged || topicsChanged) {
+        topicAnalyzer.analyzeProposal(proposal);
+    }
+    if (textChanged) {
+        similarityIndex.addProposal(proposal);
+        corpusIndex.addProposal(proposal);
+    }
+    if (isNew) {
+        timeFilter.registerProposal(proposalId, proposal->getCreationTimestamp());
+    }
+    proposalSnapshots[proposalId] = snapshot;
+    updateRankingEntry(proposal);
+}
+
+bool DecisionRankingEngine::removeProposal(const std::string& proposalId) {
+    if (proposalSnapshots.erase(proposalId) == 0) return false;
+    
+    topicAnalyzer.removeProposal(proposalId);
+    timeFilter.unregisterProposal(proposalId);
+    similarityIndex.removeProposal(proposalId);
+    corpusIndex.removeDocument(proposalId);
+    removeRankingEntry(proposalId);
+    return true;
 }
 
 void DecisionRankingEngine::buildSimilarityMatrix(
     const std::vector<std::shared_ptr<Proposal>>& proposals) {
     
-    for (size_t i = 0; i < proposals.size(); ++i) {
-        for (size_t j = i + 1; j < proposals.size(); ++j) {
-            std::string text1 = proposals[i]->getTitle() + " " + proposals[i]->getDescription();
-            std::string text2 = proposals[j]->getTitle() + " " + proposals[j]->getDescription();
-            
-            double similarity = SimilarityMetrics::combinedSimilarity(text1, text2);
-            
-            similarityMatrix[proposals[i]->getProposalId()][proposals[j]->getProposalId()] = similarity;
-            similarityMatrix[proposals[j]->getProposalId()][proposals[i]->getProposalId()] = similarity;
-        }
+    similarityIndex.build(proposals);
+    
+    corpusIndex.clear();
+    for (const auto& proposal : proposals) {
+        corpusIndex.addProposal(proposal);
     }
 }
 
@@ -123,8 +672,7 @@ double DecisionRankingEngine::calculateWeightedRelevance(
     
     for (const auto& topicId : proposalTopics) {
         if (std::find(coreTopics.begin(), coreTopics.end(), topicId) != coreTopics.end()) {
-            Topic topic = topicAnalyzer.getTopic(topicId);
-            totalRelevance += topic.relevanceScore;
+            totalRelevance += topicAnalyzer.getTopicRelevance(proposal->getProposalId(), topicId);
         }
     }
     
@@ -200,60 +748,123 @@ std::vector<DecisionRanking> DecisionRankingEngine::rankDecisionsByTopic(
 
 std::vector<DecisionRanking> DecisionRankingEngine::getTopDecisions(int n) {
     std::vector<DecisionRanking> topDecisions;
+    long long nowHour = TimeBasedFilter::currentHour();
+    
+    // Merge the buckets; the heap holds each bucket's next entry with its time term added
+    struct Cursor {
+        double score;
+        double timeTerm;
+        RankingBucket::const_iterator next;
+        RankingBucket::const_iterator end;
+    };
+    auto worse = [](const Cursor& a, const Cursor& b) {
+        return a.score < b.score || (a.score == b.score && a.next->second < b.next->second);
+    };
+    
+    std::vector<Cursor> heap;
+    heap.reserve(rankingIndex.size());
+    for (const auto& bucket : rankingIndex) {
+        double timeTerm = 0.3 * bucketTimeScore(bucket.first, nowHour);
+        heap.push_back({bucket.second.begin()->first + timeTerm, timeTerm,
+                        bucket.second.begin(), bucket.second.end()});
+    }
+    std::make_heap(heap.begin(), heap.end(), worse);
     
-    auto tempQueue = rankingQueue;
-    for (int i = 0; i < n && !tempQueue.empty(); ++i) {
-        topDecisions.push_back(tempQueue.top());
-        tempQueue.pop();
+    int rank = 0;
+    while (!heap.empty() && rank < n) {
+        std::pop_heap(heap.begin(), heap.end(), worse);
+        Cursor& cursor = heap.back();
+        
+        DecisionRanking ranking = scoredRanking(rankingEntries.at(cursor.next->second), nowHour);
+        ranking.rank = ++rank;
+        ranking.percentile = 100.0 * (rankedCount - rank) / rankedCount;
+        topDecisions.push_back(ranking);
+        
+        if (++cursor.next != cursor.end) {
+            cursor.score = cursor.next->first + cursor.timeTerm;
+            std::push_heap(heap.begin(), heap.end(), worse);
+        } else {
+            heap.pop_back();
+        }
     }
     
     return topDecisions;
 }
 
 DecisionRanking DecisionRankingEngine::getProposalRanking(const std::string& proposalId) {
-    auto tempQueue = rankingQueue;
+    auto it = rankingEntries.find(proposalId);
+    if (it == rankingEntries.end()) {
+        return DecisionRanking();
+    }
     
-    while (!tempQueue.empty()) {
-        auto ranking = tempQueue.top();
-        tempQueue.pop();
-        
-        if (ranking.proposalId == proposalId) {
-            return ranking;
+    long long nowHour = TimeBasedFilter::currentHour();
+    DecisionRanking ranking = scoredRanking(it->second, nowHour);
+    
+    // Count the entries ahead in each bucket; a bucket stays sorted with its time term added
+    size_t ahead = 0;
+    for (const auto& bucket : rankingIndex) {
+        double timeTerm = 0.3 * bucketTimeScore(bucket.first, nowHour);
+        for (const auto& item : bucket.second) {
+            double score = item.first + timeTerm;
+            if (score < ranking.combinedScore ||
+                (score == ranking.combinedScore && item.second <= proposalId)) {
+                break;
+            }
+            ahead++;
         }
     }
+    ranking.rank = static_cast<int>(ahead) + 1;
+    ranking.percentile = 100.0 * (rankedCount - ranking.rank) / rankedCount;
     
-    return DecisionRanking();
+    return ranking;
 }
 
 double DecisionRankingEngine::getProposalSimilarity(const std::string& proposalId1, 
                                                    const std::string& proposalId2) {
-    auto it1 = similarityMatrix.find(proposalId1);
-    if (it1 != similarityMatrix.end()) {
-        auto it2 = it1->second.find(proposalId2);
-        if (it2 != it1->second.end()) {
-            return it2->second;
-        }
-    }
-    
-    return 0.0;
+    return similarityIndex.getSimilarity(proposalId1, proposalId2);
+}
+
+std::vector<std::pair<std::string, double>> DecisionRankingEngine::getSimilarProposals(
+    const std::string& proposalId) const {
+    return similarityIndex.getNeighbors(proposalId);
+}
+
+SparseVector DecisionRankingEngine::getProposalTFIDFVector(const std::string& proposalId) const {
+    return corpusIndex.getDocumentVector(proposalId);
+}
+
+SparseVector DecisionRankingEngine::createTFIDFVector(const std::string& text) const {
+    return corpusIndex.createTFIDFVector(text);
 }
 
 void DecisionRankingEngine::updateRankings(
     const std::vector<std::shared_ptr<Proposal>>& proposals) {
     
-    while (!rankingQueue.empty()) {
-        rankingQueue.pop();
+    std::unordered_set<std::string> current;
+    for (const auto& proposal : proposals) {
+        current.insert(proposal->getProposalId());
+        addOrUpdateProposal(proposal);
     }
     
-    initialize(proposals);
+    std::vector<std::string> removed;
+    for (const auto& pair : proposalSnapshots) {
+        if (!current.count(pair.first)) {
+            removed.push_back(pair.first);
+        }
+    }
+    for (const auto& proposalId : removed) {
+        removeProposal(proposalId);
+    }
 }
 
 std::string DecisionRankingEngine::getRankingStatistics() {
     std::stringstream ss;
     ss << "\n=== DECISION RANKING STATISTICS ===\n";
     ss << "Total Topics: " << topicAnalyzer.getAllTopics().size() << "\n";
-    ss << "Similarity Matrix Size: " << similarityMatrix.size() << "\n";
-    ss << "Rankings in Queue: " << rankingQueue.size() << "\n";
+    ss << "Similarity Matrix Size: " << similarityIndex.getProposalCount() << "\n";
+    ss << "Similarity Neighbors: " << similarityIndex.getNeighborCount() << "\n";
+    ss << "Corpus Terms: " << corpusIndex.getTermCount() << "\n";
+    ss << "Rankings in Index: " << rankedCount << "\n";
     
     return ss.str();
 }
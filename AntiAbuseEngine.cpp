@@ -1,10 +1,14 @@
 #include "AntiAbuseEngine.h"
+#include "ParallelFor.h"
 #include <iostream>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
 #include <random>
 #include <set>
+#include <thread>
+#include <atomic>
+#include <functional>
 
 // ==================== SlidingWindow Implementation ====================
 
@@ -43,35 +47,101 @@ double SlidingWindow::getAverageGapMs() const {
 
 // ==================== CoVotingGraph Implementation ====================
 
-void CoVotingGraph::addVote(const std::string& userId, const std::string& proposalId) {
+CoVotingGraph::CoVotingGraph() : adjacency(kStripes), voterStripes(kStripes) {
+}
+
+const std::unordered_map<std::string, int>* CoVotingGraph::findRow(const std::string& userId) const {
+    const auto& rows = adjacency[stripeOf(userId)].rows;
+    auto it = rows.find(userId);
+    return (it != rows.end()) ? &it->second : nullptr;
+}
+
+bool CoVotingGraph::addVote(const std::string& userId, const std::string& proposalId,
+                            int strongThreshold,
+                            std::vector<std::pair<std::string, int>>* strongEdges) {
+    // The proposal's voter stripe stays locked while its co-votes are applied;
+    // row stripes are taken one at a time beneath it, so locks never cycle
+    VoterStripe& voterStripe = voterStripes[stripeOf(proposalId)];
+    std::lock_guard<std::mutex> voterLock(voterStripe.mutex);
+    
     // Add user to proposal's voter set
-    proposalVoters[proposalId].insert(userId);
+    auto& voters = voterStripe.proposalVoters[proposalId];
+    voters.insert(userId);
+    if (voters.size() < 2) return false;
+    
+    // The voter's own row, under a single lock. Community detection only sees
+    // strong edges and the weak edges between users that have one, so other
+    // increments leave its result unchanged.
+    struct MirroredEdge {
+        size_t stripe;
+        const std::string* user;
+        bool crossed;
+    };
+    std::vector<MirroredEdge> mirrored;
+    mirrored.reserve(voters.size() - 1);
+    bool strongChanged = false;
+    bool voterStrong;
+    {
+        AdjacencyStripe& stripe = adjacency[stripeOf(userId)];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto& row = stripe.rows[userId];
+        for (const auto& otherUser : voters) {
+            if (otherUser == userId) continue;
+            
+            int coVotes = ++row[otherUser];
+            bool crossed = (strongThreshold > 1 && coVotes == strongThreshold);
+            if (coVotes >= strongThreshold) {
+                strongChanged = true;
+                if (strongEdges) {
+                    strongEdges->emplace_back(otherUser, coVotes);
+                }
+            }
+            if (crossed) {
+                stripe.strongUsers.insert(userId);
+            }
+            mirrored.push_back({stripeOf(otherUser), &otherUser, crossed});
+        }
+        voterStrong = stripe.strongUsers.count(userId) > 0;
+    }
     
-    // Update adjacency matrix for this proposal's voters
-    const auto& voters = proposalVoters[proposalId];
-    for (const auto& otherUser : voters) {
-        if (otherUser != userId) {
-            adjacency[userId][otherUser]++;
-            adjacency[otherUser][userId]++;  // Symmetric
+    // Symmetric counts, grouped so each row stripe is locked once
+    std::sort(mirrored.begin(), mirrored.end(),
+              [](const MirroredEdge& a, const MirroredEdge& b) {
+                  return a.stripe < b.stripe;
+              });
+    for (size_t i = 0; i < mirrored.size();) {
+        size_t stripeIndex = mirrored[i].stripe;
+        AdjacencyStripe& stripe = adjacency[stripeIndex];
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        for (; i < mirrored.size() && mirrored[i].stripe == stripeIndex; i++) {
+            const std::string& otherUser = *mirrored[i].user;
+            stripe.rows[otherUser][userId]++;
+            if (mirrored[i].crossed) {
+                stripe.strongUsers.insert(otherUser);
+            } else if (voterStrong && !strongChanged && stripe.strongUsers.count(otherUser)) {
+                strongChanged = true;
+            }
         }
     }
+    
+    return strongChanged;
 }
 
 int CoVotingGraph::getCoVoteCount(const std::string& user1, const std::string& user2) const {
-    auto it1 = adjacency.find(user1);
-    if (it1 == adjacency.end()) return 0;
+    const auto* row = findRow(user1);
+    if (!row) return 0;
     
-    auto it2 = it1->second.find(user2);
-    if (it2 == it1->second.end()) return 0;
+    auto it = row->find(user2);
+    if (it == row->end()) return 0;
     
-    return it2->second;
+    return it->second;
 }
 
 std::vector<std::string> CoVotingGraph::getNeighbors(const std::string& userId) const {
     std::vector<std::string> neighbors;
-    auto it = adjacency.find(userId);
-    if (it != adjacency.end()) {
-        for (const auto& pair : it->second) {
+    const auto* row = findRow(userId);
+    if (row) {
+        for (const auto& pair : *row) {
             neighbors.push_back(pair.first);
         }
     }
@@ -80,69 +150,815 @@ std::vector<std::string> CoVotingGraph::getNeighbors(const std::string& userId)
 
 int CoVotingGraph::getEdgeCount() const {
     int count = 0;
-    for (const auto& pair1 : adjacency) {
-        count += pair1.second.size();
+    for (const auto& stripe : adjacency) {
+        for (const auto& pair1 : stripe.rows) {
+            count += pair1.second.size();
+        }
     }
     return count / 2;  // Divide by 2 because graph is symmetric
 }
 
-std::vector<std::vector<std::string>> CoVotingGraph::detectCommunities(int minCoVotes) {
-    std::vector<std::vector<std::string>> communities;
-    std::unordered_set<std::string> visited;
+CoVoteCSR CoVotingGraph::buildSnapshot(int minCoVotes) const {
+    CoVoteCSR csr;
     
-    // Simple community detection: find connected components with high co-vote counts
-    for (const auto& pair1 : adjacency) {
-        const std::string& user = pair1.first;
-        if (visited.count(user)) continue;
-        
-        // BFS to find connected component
-        std::vector<std::string> community;
-        std::queue<std::string> queue;
-        queue.push(user);
-        visited.insert(user);
+    // Collect users with at least one qualifying edge, sorted for stable indices
+    for (const auto& stripe : adjacency) {
+        for (const auto& pair1 : stripe.rows) {
+            for (const auto& pair2 : pair1.second) {
+                if (pair2.second >= minCoVotes) {
+                    csr.userIds.push_back(pair1.first);
+                    break;
+                }
+            }
+        }
+    }
+    std::sort(csr.userIds.begin(), csr.userIds.end());
+    
+    std::unordered_map<std::string, int> index;
+    index.reserve(csr.userIds.size());
+    for (size_t i = 0; i < csr.userIds.size(); i++) {
+        index[csr.userIds[i]] = static_cast<int>(i);
+    }
+    
+    csr.offsets.reserve(csr.userIds.size() + 1);
+    csr.offsets.push_back(0);
+    csr.weakOffsets.reserve(csr.userIds.size() + 1);
+    csr.weakOffsets.push_back(0);
+    for (const auto& userId : csr.userIds) {
+        for (const auto& neighborPair : *findRow(userId)) {
+            if (neighborPair.second >= minCoVotes) {
+                csr.neighbors.push_back(index[neighborPair.first]);
+                csr.weights.push_back(neighborPair.second);
+            } else {
+                auto neighbor = index.find(neighborPair.first);
+                if (neighbor != index.end()) {
+                    csr.weakNeighbors.push_back(neighbor->second);
+                    csr.weakWeights.push_back(neighborPair.second);
+                }
+            }
+        }
+        csr.offsets.push_back(static_cast<int>(csr.neighbors.size()));
+        csr.weakOffsets.push_back(static_cast<int>(csr.weakNeighbors.size()));
+    }
+    
+    return csr;
+}
+
+// Users per label-propagation range handed to a worker
+static const size_t kLabelChunk = 256;
+
+std::vector<CoVoteCommunity> CoVotingGraph::detectCommunityClusters(int minCoVotes,
+                                                                    int numThreads) const {
+    CoVoteCSR csr = buildSnapshot(minCoVotes);
+    const int n = csr.getUserCount();
+    
+    // Weighted label propagation: every user adopts the label carrying the most
+    // co-vote weight among its neighbors. Updates are synchronous (read old labels,
+    // write new ones) so results do not depend on thread scheduling. Each user also
+    // votes for its own label with its strongest edge weight, which keeps pairs and
+    // bipartite fragments from oscillating.
+    std::vector<int> labels(n), nextLabels(n);
+    for (int i = 0; i < n; i++) labels[i] = i;
+    
+    const int maxIterations = 20;
+    for (int iter = 0; iter < maxIterations; iter++) {
+        std::atomic<int> changed(0);
         
-        while (!queue.empty()) {
-            std::string current = queue.front();
-            queue.pop();
-            community.push_back(current);
+        parallelFor(n, numThreads, kLabelChunk, [&](size_t begin, size_t end) {
+            std::vector<std::pair<int, int>> labelWeights;
+            int localChanged = 0;
             
-            auto it = adjacency.find(current);
-            if (it != adjacency.end()) {
-                for (const auto& neighborPair : it->second) {
-                    const std::string& neighbor = neighborPair.first;
-                    int coVotes = neighborPair.second;
-                    
-                    if (!visited.count(neighbor) && coVotes >= minCoVotes) {
-                        visited.insert(neighbor);
-                        queue.push(neighbor);
+            for (int v = static_cast<int>(begin); v < static_cast<int>(end); v++) {
+                labelWeights.clear();
+                int strongest = 0;
+                for (int e = csr.offsets[v]; e < csr.offsets[v + 1]; e++) {
+                    labelWeights.emplace_back(labels[csr.neighbors[e]], csr.weights[e]);
+                    strongest = std::max(strongest, csr.weights[e]);
+                }
+                labelWeights.emplace_back(labels[v], strongest);
+                std::sort(labelWeights.begin(), labelWeights.end());
+                
+                // Ties go to the smallest label
+                int bestLabel = labels[v];
+                long long bestWeight = -1;
+                for (size_t i = 0; i < labelWeights.size();) {
+                    int label = labelWeights[i].first;
+                    long long weight = 0;
+                    for (; i < labelWeights.size() && labelWeights[i].first == label; i++) {
+                        weight += labelWeights[i].second;
+                    }
+                    if (weight > bestWeight) {
+                        bestWeight = weight;
+                        bestLabel = label;
                     }
                 }
+                
+                nextLabels[v] = bestLabel;
+                if (bestLabel != labels[v]) localChanged++;
             }
-        }
+            
+            changed += localChanged;
+        });
         
-        // Only include communities with 2+ members
-        if (community.size() >= 2) {
-            communities.push_back(community);
+        labels.swap(nextLabels);
+        if (changed == 0) break;
+    }
+    
+    // Group users by label, then accumulate internal edge statistics in one pass
+    std::unordered_map<int, int> labelToCommunity;
+    std::vector<CoVoteCommunity> groups;
+    std::vector<int> communityOf(n);
+    for (int v = 0; v < n; v++) {
+        auto it = labelToCommunity.find(labels[v]);
+        if (it == labelToCommunity.end()) {
+            it = labelToCommunity.emplace(labels[v], static_cast<int>(groups.size())).first;
+            groups.emplace_back();
         }
+        communityOf[v] = it->second;
+        groups[it->second].members.push_back(csr.userIds[v]);
     }
     
+    // Every co-voting member pair counts, including pairs below the co-vote floor
+    for (int v = 0; v < n; v++) {
+        for (int e = csr.offsets[v]; e < csr.offsets[v + 1]; e++) {
+            int u = csr.neighbors[e];
+            if (u > v && communityOf[u] == communityOf[v]) {
+                groups[communityOf[v]].internalEdges++;
+                groups[communityOf[v]].internalCoVotes += csr.weights[e];
+            }
+        }
+        for (int e = csr.weakOffsets[v]; e < csr.weakOffsets[v + 1]; e++) {
+            int u = csr.weakNeighbors[e];
+            if (u > v && communityOf[u] == communityOf[v]) {
+                groups[communityOf[v]].internalEdges++;
+                groups[communityOf[v]].internalCoVotes += csr.weakWeights[e];
+            }
+        }
+    }
+    
+    // Only include communities with 2+ members
+    std::vector<CoVoteCommunity> communities;
+    for (auto& group : groups) {
+        if (group.members.size() >= 2) {
+            communities.push_back(std::move(group));
+        }
+    }
+    
+    // Heaviest clusters first
+    std::sort(communities.begin(), communities.end(),
+              [](const CoVoteCommunity& a, const CoVoteCommunity& b) {
+                  return a.internalCoVotes > b.internalCoVotes;
+              });
+    
+    return communities;
+}
+
+std::vector<std::vector<std::string>> CoVotingGraph::detectCommunities(int minCoVotes) {
+    std::vector<std::vector<std::string>> communities;
+    for (auto& community : detectCommunityClusters(minCoVotes)) {
+        communities.push_back(std::move(community.members));
+    }
     return communities;
 }
 
 void CoVotingGraph::clear() {
-    adjacency.clear();
-    proposalVoters.clear();
+    for (auto& stripe : adjacency) {
+        stripe.rows.clear();
+        stripe.strongUsers.clear();
+    }
+    for (auto& stripe : voterStripes) {
+        stripe.proposalVoters.clear();
+    }
+}
+
+// ==================== Linkage Index Implementation ====================
+
+// SplitMix64 finalizer: spreads sequential ids over all 64 bits
+static uint64_t mixHash(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ULL;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+HyperLogLog::HyperLogLog(int precisionBits)
+    : registers(size_t(1) << precisionBits, 0),
+      inverseSum(static_cast<double>(size_t(1) << precisionBits)),
+      zeroRegisters(1 << precisionBits),
+      precision(precisionBits) {
+}
+
+void HyperLogLog::add(uint64_t hash) {
+    size_t index = hash >> (64 - precision);
+    uint64_t rest = (hash << precision) | (uint64_t(1) << (precision - 1));
+    uint8_t rank = static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    
+    uint8_t& reg = registers[index];
+    if (rank <= reg) return;
+    
+    if (reg == 0) zeroRegisters--;
+    inverseSum += std::ldexp(1.0, -rank) - std::ldexp(1.0, -reg);
+    reg = rank;
+}
+
+double HyperLogLog::estimate() const {
+    double m = static_cast<double>(registers.size());
+    double alpha = 0.7213 / (1.0 + 1.079 / m);
+    double raw = alpha * m * m / inverseSum;
+    
+    // Linear counting for small cardinalities
+    if (raw <= 2.5 * m && zeroRegisters > 0) {
+        return m * std::log(m / zeroRegisters);
+    }
+    return raw;
+}
+
+void SpaceSavingCounter::add(uint32_t item) {
+    auto it = counters.find(item);
+    if (it != counters.end()) {
+        it->second.count++;
+        return;
+    }
+    
+    if (counters.size() < capacity) {
+        counters[item] = {1, 0};
+        return;
+    }
+    
+    // Replace the minimum counter; the newcomer inherits its count as error
+    auto minIt = counters.begin();
+    for (auto cur = counters.begin(); cur != counters.end(); ++cur) {
+        if (cur->second.count < minIt->second.count) minIt = cur;
+    }
+    uint64_t minCount = minIt->second.count;
+    counters.erase(minIt);
+    counters[item] = {minCount + 1, minCount};
+}
+
+std::vector<std::pair<uint32_t, uint64_t>> SpaceSavingCounter::top(size_t k) const {
+    std::vector<std::pair<uint32_t, uint64_t>> items;
+    items.reserve(counters.size());
+    for (const auto& pair : counters) {
+        items.emplace_back(pair.first, pair.second.count);
+    }
+    
+    size_t n = std::min(k, items.size());
+    std::partial_sort(items.begin(), items.begin() + n, items.end(),
+                      [](const std::pair<uint32_t, uint64_t>& a,
+                         const std::pair<uint32_t, uint64_t>& b) {
+                          return a.second > b.second;
+                      });
+    items.resize(n);
+    return items;
+}
+
+LinkageIndex::LinkageIndex(StringInterner& userIds, size_t exactUserCap, size_t heavyHitterCapacity)
+    : users(userIds),
+      heavyHitters(heavyHitterCapacity),
+      maxExactUsers(exactUserCap) {
+}
+
+bool LinkageIndex::add(const std::string& key, const std::string& userId) {
+    uint32_t keyId = keys.intern(key);
+    uint32_t userIdx = users.intern(userId);
+    if (keyId >= entries.size()) entries.resize(keyId + 1);
+    if (userIdx >= userKeys.size()) userKeys.resize(userIdx + 1);
+    
+    heavyHitters.add(keyId);
+    
+    // Key -> users: exact while under the cap, sketch-only afterwards
+    KeyEntry& entry = entries[keyId];
+    auto pos = std::lower_bound(entry.users.begin(), entry.users.end(), userIdx);
+    bool known = pos != entry.users.end() && *pos == userIdx;
+    if (!known && entry.users.size() < maxExactUsers) {
+        entry.users.insert(pos, userIdx);
+    } else if (!known && !entry.sketch) {
+        entry.sketch.reset(new HyperLogLog());
+        for (uint32_t member : entry.users) {
+            entry.sketch->add(mixHash(member));
+        }
+    }
+    if (entry.sketch) entry.sketch->add(mixHash(userIdx));
+    
+    // User -> keys
+    auto& linked = userKeys[userIdx];
+    auto keyPos = std::lower_bound(linked.begin(), linked.end(), keyId);
+    if (keyPos == linked.end() || *keyPos != keyId) {
+        linked.insert(keyPos, keyId);
+    }
+    return !known;
+}
+
+std::vector<std::string> LinkageIndex::getUsers(const std::string& key,
+                                                size_t offset, size_t limit) const {
+    std::vector<std::string> result;
+    uint32_t keyId;
+    if (!keys.find(key, keyId)) return result;
+    
+    const auto& members = entries[keyId].users;
+    for (size_t i = offset; i < members.size() && result.size() < limit; i++) {
+        result.push_back(users.lookup(members[i]));
+    }
+    return result;
+}
+
+double LinkageIndex::estimateUserCount(const std::string& key) const {
+    uint32_t keyId;
+    if (!keys.find(key, keyId)) return 0.0;
+    
+    const KeyEntry& entry = entries[keyId];
+    if (entry.sketch) {
+        return std::max(static_cast<double>(entry.users.size()), entry.sketch->estimate());
+    }
+    return static_cast<double>(entry.users.size());
+}
+
+size_t LinkageIndex::getKeyCountForUser(const std::string& userId) const {
+    uint32_t userIdx;
+    if (!users.find(userId, userIdx) || userIdx >= userKeys.size()) return 0;
+    return userKeys[userIdx].size();
+}
+
+double LinkageIndex::getMaxFanoutForUser(const std::string& userId) const {
+    uint32_t userIdx;
+    if (!users.find(userId, userIdx) || userIdx >= userKeys.size()) return 0.0;
+    
+    double fanout = 0.0;
+    for (uint32_t keyId : userKeys[userIdx]) {
+        const KeyEntry& entry = entries[keyId];
+        double count = entry.sketch
+            ? std::max(static_cast<double>(entry.users.size()), entry.sketch->estimate())
+            : static_cast<double>(entry.users.size());
+        fanout = std::max(fanout, count);
+    }
+    return fanout;
+}
+
+std::vector<std::pair<std::string, uint64_t>> LinkageIndex::getHeavyHitters(size_t k) const {
+    std::vector<std::pair<std::string, uint64_t>> result;
+    for (const auto& item : heavyHitters.top(k)) {
+        result.emplace_back(keys.lookup(item.first), item.second);
+    }
+    return result;
+}
+
+void LinkageIndex::removeUser(const std::string& userId) {
+    uint32_t userIdx;
+    if (!users.find(userId, userIdx) || userIdx >= userKeys.size()) return;
+    
+    // Sketches cannot forget a user; only the exact lists are updated
+    for (uint32_t keyId : userKeys[userIdx]) {
+        auto& members = entries[keyId].users;
+        auto pos = std::lower_bound(members.begin(), members.end(), userIdx);
+        if (pos != members.end() && *pos == userIdx) members.erase(pos);
+    }
+    userKeys[userIdx].clear();
+}
+
+void LinkageIndex::clear() {
+    keys.clear();
+    entries.clear();
+    userKeys.clear();
+    heavyHitters.clear();
+}
+
+// ==================== StreamingCollusionDetector Implementation ====================
+
+StreamingCollusionDetector::StreamingCollusionDetector(int windowSeconds, size_t edgeCap,
+                                                       size_t minGroup, double density)
+    : edgeCount(0),
+      windowDuration(windowSeconds),
+      maxEdges(edgeCap),
+      minGroupSize(minGroup),
+      maxGroupSize(32),
+      minDensity(density) {
+}
+
+const StreamingCollusionDetector::StrongEdge*
+StreamingCollusionDetector::findEdge(const std::string& user1, const std::string& user2) const {
+    auto it1 = strongAdjacency.find(user1);
+    if (it1 == strongAdjacency.end()) return nullptr;
+    
+    auto it2 = it1->second.find(user2);
+    if (it2 == it1->second.end()) return nullptr;
+    
+    return &it2->second;
+}
+
+void StreamingCollusionDetector::removeEdge(const std::string& user1, const std::string& user2) {
+    for (const auto& ends : {std::make_pair(user1, user2), std::make_pair(user2, user1)}) {
+        auto it = strongAdjacency.find(ends.first);
+        if (it == strongAdjacency.end()) continue;
+        it->second.erase(ends.second);
+        if (it->second.empty()) strongAdjacency.erase(it);
+    }
+    edgeCount--;
+}
+
+void StreamingCollusionDetector::expire(const std::chrono::system_clock::time_point& currentTime) {
+    auto cutoff = currentTime - windowDuration;
+    
+    // edgeOrder holds each live edge exactly once, ordered by queuedAt. An edge
+    // reinforced since it was queued rotates to the back, so once the front is
+    // fresh everything behind it is fresh too. Over the cap, the front is evicted.
+    while (!edgeOrder.empty()) {
+        auto ends = edgeOrder.front();
+        const StrongEdge* edge = findEdge(ends.first, ends.second);
+        edgeOrder.pop_front();
+        if (!edge) continue;
+        
+        if (edgeCount > maxEdges || edge->lastSeen < cutoff) {
+            removeEdge(ends.first, ends.second);
+        } else if (edge->lastSeen > edge->queuedAt) {
+            strongAdjacency[ends.first][ends.second].queuedAt = edge->lastSeen;
+            strongAdjacency[ends.second][ends.first].queuedAt = edge->lastSeen;
+            edgeOrder.push_back(ends);
+        } else {
+            edgeOrder.push_front(ends);
+            break;
+        }
+    }
+    
+    // Same rotation for reported groups
+    while (!reportOrder.empty()) {
+        auto it = reportedGroups.find(reportOrder.front());
+        if (it == reportedGroups.end()) {
+            reportOrder.pop_front();
+        } else if (it->second.lastSeen < cutoff) {
+            reportedGroups.erase(it);
+            reportOrder.pop_front();
+        } else if (it->second.lastSeen > it->second.queuedAt) {
+            it->second.queuedAt = it->second.lastSeen;
+            reportOrder.push_back(reportOrder.front());
+            reportOrder.pop_front();
+        } else {
+            break;
+        }
+    }
+}
+
+bool StreamingCollusionDetector::observeStrongEdge(const std::string& user1,
+                                                   const std::string& user2,
+                                                   int coVotes,
+                                                   const std::chrono::system_clock::time_point& timestamp,
+                                                   double minScore,
+                                                   CollusionDetectionResult& group) {
+    // Events already outside the window cannot form a ring
+    latestTimestamp = std::max(latestTimestamp, timestamp);
+    if (timestamp < latestTimestamp - windowDuration) return false;
+    
+    // Insert or refresh the edge. New edges queue at the latest time so edgeOrder
+    // stays sorted; an out-of-order edge outlives the window by at most its delay.
+    const StrongEdge* existing = findEdge(user1, user2);
+    auto queuedAt = existing ? existing->queuedAt : latestTimestamp;
+    auto lastSeen = existing ? std::max(existing->lastSeen, timestamp) : timestamp;
+    if (!existing) {
+        edgeOrder.emplace_back(user1, user2);
+        edgeCount++;
+    }
+    strongAdjacency[user1][user2] = {lastSeen, queuedAt, coVotes};
+    strongAdjacency[user2][user1] = {lastSeen, queuedAt, coVotes};
+    expire(latestTimestamp);
+    
+    // Close triangles through common strong neighbors of the smaller endpoint
+    auto it1 = strongAdjacency.find(user1);
+    auto it2 = strongAdjacency.find(user2);
+    if (it1 == strongAdjacency.end() || it2 == strongAdjacency.end()) return false;
+    
+    const auto& smaller = (it1->second.size() <= it2->second.size()) ? it1->second : it2->second;
+    const auto& larger = (it1->second.size() <= it2->second.size()) ? it2->second : it1->second;
+    
+    std::vector<std::string> members = {user1, user2};
+    for (const auto& neighborPair : smaller) {
+        if (members.size() >= maxGroupSize) break;
+        const std::string& neighbor = neighborPair.first;
+        if (neighbor != user1 && neighbor != user2 && larger.count(neighbor)) {
+            members.push_back(neighbor);
+        }
+    }
+    if (members.size() < minGroupSize) return false;
+    
+    // Density and co-votes over the candidate group (bounded by maxGroupSize)
+    int edges = 0;
+    int totalCoVotes = 0;
+    for (size_t i = 0; i < members.size(); i++) {
+        for (size_t j = i + 1; j < members.size(); j++) {
+            const StrongEdge* edge = findEdge(members[i], members[j]);
+            if (edge) {
+                edges++;
+                totalCoVotes += edge->coVotes;
+            }
+        }
+    }
+    int maxPossibleEdges = (members.size() * (members.size() - 1)) / 2;
+    double density = static_cast<double>(edges) / maxPossibleEdges;
+    if (density < minDensity) return false;
+    
+    double avgCoVotes = static_cast<double>(totalCoVotes) / edges;
+    double score = std::min(1.0, 0.5 * density + 0.5 * (avgCoVotes / 20.0));
+    if (score <= minScore) return false;
+    
+    // Report each group once per window; a grown group gets a new key
+    std::sort(members.begin(), members.end());
+    std::string groupKey;
+    for (const auto& member : members) {
+        groupKey += member + "|";
+    }
+    auto reported = reportedGroups.find(groupKey);
+    if (reported != reportedGroups.end()) {
+        reported->second.lastSeen = std::max(reported->second.lastSeen, timestamp);
+        return false;
+    }
+    reportedGroups[groupKey] = {timestamp, latestTimestamp};
+    reportOrder.push_back(groupKey);
+    
+    group.userGroup = members;
+    group.coVoteCount = totalCoVotes;
+    group.coVoteRate = density;
+    group.collusionScore = score;
+    group.isSuspicious = true;
+    
+    std::stringstream ss;
+    ss << "Voting ring forming: " << members.size() << " users with "
+       << totalCoVotes << " recent co-votes (density: "
+       << std::fixed << std::setprecision(2) << density << ")";
+    group.description = ss.str();
+    
+    return true;
+}
+
+void StreamingCollusionDetector::clear() {
+    strongAdjacency.clear();
+    edgeOrder.clear();
+    reportedGroups.clear();
+    reportOrder.clear();
+    edgeCount = 0;
+    latestTimestamp = std::chrono::system_clock::time_point();
+}
+
+// ==================== ThreatAlertStore Implementation ====================
+
+ThreatAlertStore::ThreatAlertStore(size_t capacity, int cooldownSeconds)
+    : ring(std::max<size_t>(1, capacity)),
+      nextSequence(1),
+      clearedBefore(1),
+      unresolvedCount(0),
+      cooldown(cooldownSeconds) {
+}
+
+ThreatAlertStore::Slot* ThreatAlertStore::findSlot(uint64_t sequence) {
+    if (sequence == 0) return nullptr;
+    Slot& slot = ring[(sequence - 1) % ring.size()];
+    return (slot.sequence == sequence) ? &slot : nullptr;
+}
+
+uint64_t ThreatAlertStore::oldestRetained() const {
+    uint64_t oldest = (nextSequence > ring.size()) ? nextSequence - ring.size() : 1;
+    return std::max(oldest, clearedBefore);
+}
+
+bool ThreatAlertStore::raise(const std::string& alertType, double severity,
+                             const std::vector<std::string>& users,
+                             const std::string& description) {
+    std::vector<std::string> sortedUsers = users;
+    std::sort(sortedUsers.begin(), sortedUsers.end());
+    std::string dedupKey = alertType;
+    for (const auto& user : sortedUsers) {
+        dedupKey += "|" + user;
+    }
+    
+    auto now = std::chrono::system_clock::now();
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // Fold repeats into the live alert while it is unresolved and within cooldown
+    auto dedupIt = dedupIndex.find(dedupKey);
+    if (dedupIt != dedupIndex.end()) {
+        Slot* slot = findSlot(dedupIt->second);
+        if (slot && !slot->alert.resolved && now - slot->lastRaised <= cooldown) {
+            slot->alert.occurrences++;
+            slot->alert.severity = std::max(slot->alert.severity, severity);
+            slot->alert.description = description;
+            slot->lastRaised = now;
+            return false;
+        }
+    }
+    
+    uint64_t sequence = nextSequence++;
+    Slot& slot = ring[(sequence - 1) % ring.size()];
+    
+    // Evict the alert previously held by this slot
+    if (slot.sequence != 0) {
+        if (!slot.alert.resolved) unresolvedCount--;
+        auto evicted = dedupIndex.find(slot.dedupKey);
+        if (evicted != dedupIndex.end() && evicted->second == slot.sequence) {
+            dedupIndex.erase(evicted);
+        }
+    }
+    
+    slot.sequence = sequence;
+    slot.dedupKey = dedupKey;
+    slot.lastRaised = now;
+    slot.alert = ThreatAlert();
+    slot.alert.alertId = "ALERT_" + std::to_string(sequence);
+    slot.alert.alertType = alertType;
+    slot.alert.severity = severity;
+    slot.alert.involvedUsers = users;
+    slot.alert.description = description;
+    slot.alert.timestamp = now;
+    
+    dedupIndex[dedupKey] = sequence;
+    unresolvedCount++;
+    return true;
+}
+
+bool ThreatAlertStore::resolve(const std::string& alertId) {
+    // Alert ids encode their sequence: "ALERT_<sequence>"
+    const std::string prefix = "ALERT_";
+    if (alertId.compare(0, prefix.size(), prefix) != 0) return false;
+    
+    uint64_t sequence = 0;
+    for (size_t i = prefix.size(); i < alertId.size(); i++) {
+        if (alertId[i] < '0' || alertId[i] > '9') return false;
+        sequence = sequence * 10 + (alertId[i] - '0');
+    }
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    Slot* slot = findSlot(sequence);
+    if (!slot || slot->alert.resolved) return false;
+    
+    slot->alert.resolved = true;
+    unresolvedCount--;
+    return true;
+}
+
+std::vector<ThreatAlert> ThreatAlertStore::getAlerts(bool unresolvedOnly) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    std::vector<ThreatAlert> alerts;
+    alerts.reserve(unresolvedOnly ? unresolvedCount : nextSequence - oldestRetained());
+    for (uint64_t seq = oldestRetained(); seq < nextSequence; seq++) {
+        const Slot& slot = ring[(seq - 1) % ring.size()];
+        if (!unresolvedOnly || !slot.alert.resolved) {
+            alerts.push_back(slot.alert);
+        }
+    }
+    return alerts;
+}
+
+std::vector<ThreatAlert> ThreatAlertStore::getAlertsSince(uint64_t cursor, size_t maxAlerts,
+                                                          uint64_t& nextCursor) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // Alerts older than the ring have been overwritten or cleared; resume at the oldest kept
+    uint64_t seq = std::max(cursor + 1, oldestRetained());
+    
+    std::vector<ThreatAlert> alerts;
+    for (; seq < nextSequence && alerts.size() < maxAlerts; seq++) {
+        alerts.push_back(ring[(seq - 1) % ring.size()].alert);
+    }
+    nextCursor = seq - 1;
+    return alerts;
+}
+
+size_t ThreatAlertStore::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nextSequence - oldestRetained();
+}
+
+size_t ThreatAlertStore::getUnresolvedCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return unresolvedCount;
+}
+
+void ThreatAlertStore::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& slot : ring) {
+        slot = Slot();
+    }
+    dedupIndex.clear();
+    unresolvedCount = 0;
+    
+    // Sequences keep counting so alert ids and consumer cursors stay unique
+    clearedBefore = nextSequence;
 }
 
 // ==================== AntiAbuseEngine Implementation ====================
 
-AntiAbuseEngine::AntiAbuseEngine(double velThreshold, double deltaThreshold, int windowSeconds)
-    : velocityThreshold(velThreshold),
+AntiAbuseEngine::AntiAbuseEngine(double velThreshold, double deltaThreshold,
+                                 int windowSeconds, int workerShards)
+    : workersRunning(false),
+      asyncIngestion(workerShards > 0),
+      ipIndex(linkedUserIds),
+      deviceIndex(linkedUserIds),
+      coVotingVersion(0),
+      collusionDetectedVersion(0),
+      velocityThreshold(velThreshold),
       deltaThresholdMs(deltaThreshold),
       minCoVotesForCollusion(5),
       collusionThreshold(0.7),
       botLikelihoodThreshold(0.7),
-      velocityWindowSeconds(windowSeconds) {
+      velocityWindowSeconds(windowSeconds),
+      streamingDetectionEnabled(true) {
+    int shardCount = std::max(1, workerShards);
+    for (int i = 0; i < shardCount; i++) {
+        shards.emplace_back(new AbuseShard());
+    }
+    
+    if (asyncIngestion) {
+        for (int i = 0; i < shardCount; i++) {
+            crossUserPartitions.emplace_back(new CrossUserPartition());
+        }
+        
+        workersRunning = true;
+        for (auto& shard : shards) {
+            AbuseShard* owned = shard.get();
+            shard->worker = std::thread([this, owned]() { runShardWorker(*owned); });
+        }
+        for (auto& partition : crossUserPartitions) {
+            CrossUserPartition* owned = partition.get();
+            partition->worker = std::thread([this, owned]() { runCrossUserWorker(*owned); });
+        }
+    }
+}
+
+AntiAbuseEngine::~AntiAbuseEngine() {
+    stopWorkers();
+}
+
+void AntiAbuseEngine::stopWorkers() {
+    if (!asyncIngestion) return;
+    
+    flush();
+    workersRunning = false;
+    for (auto& shard : shards) {
+        if (shard->worker.joinable()) shard->worker.join();
+    }
+    for (auto& partition : crossUserPartitions) {
+        if (partition->worker.joinable()) partition->worker.join();
+    }
+}
+
+AbuseShard& AntiAbuseEngine::shardFor(const std::string& userId) const {
+    if (shards.size() == 1) return *shards[0];
+    return *shards[std::hash<std::string>()(userId) % shards.size()];
+}
+
+CrossUserPartition& AntiAbuseEngine::partitionFor(const std::string& proposalId) const {
+    return *crossUserPartitions[std::hash<std::string>()(proposalId) % crossUserPartitions.size()];
+}
+
+void AntiAbuseEngine::flush() const {
+    if (!asyncIngestion) return;
+    
+    // Shards first: a shard counts an event processed only after it has queued
+    // the event's cross-user update
+    for (const auto& shard : shards) {
+        while (shard->processed.load(std::memory_order_acquire) !=
+               shard->enqueued.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+    for (const auto& partition : crossUserPartitions) {
+        while (partition->processed.load(std::memory_order_acquire) !=
+               partition->enqueued.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+// Drain a queue until the engine stops, backing off when idle
+template <typename Handler>
+static void drainUntilStopped(MPSCQueue<VoteEvent>& queue,
+                              const std::atomic<bool>& running,
+                              Handler handle) {
+    VoteEvent event;
+    int idleSpins = 0;
+    while (true) {
+        if (queue.pop(event)) {
+            handle(event);
+            idleSpins = 0;
+        } else if (!running.load(std::memory_order_acquire)) {
+            break;
+        } else if (++idleSpins < 64) {
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+}
+
+void AntiAbuseEngine::runShardWorker(AbuseShard& shard) {
+    drainUntilStopped(shard.inbox, workersRunning, [&](VoteEvent& event) {
+        processUserEvent(event);
+        shard.processed.fetch_add(1, std::memory_order_release);
+    });
+}
+
+void AntiAbuseEngine::runCrossUserWorker(CrossUserPartition& partition) {
+    drainUntilStopped(partition.inbox, workersRunning, [&](VoteEvent& event) {
+        processCrossUserEvent(event);
+        partition.processed.fetch_add(1, std::memory_order_release);
+    });
 }
 
 void AntiAbuseEngine::recordVoteEvent(const std::string& userId,
@@ -150,47 +966,105 @@ void AntiAbuseEngine::recordVoteEvent(const std::string& userId,
                                      const std::chrono::system_clock::time_point& timestamp,
                                      const std::string& ipHash,
                                      const std::string& deviceHash) {
-    // Create vote event
-    VoteEvent event("VOTE_" + std::to_string(userVoteHistory[userId].size()),
-                   userId, proposalId, timestamp, ipHash, deviceHash);
+    VoteEvent event("", userId, proposalId, timestamp, ipHash, deviceHash);
+    
+    if (asyncIngestion) {
+        AbuseShard& shard = shardFor(userId);
+        shard.enqueued.fetch_add(1, std::memory_order_relaxed);
+        shard.inbox.push(std::move(event));
+        return;
+    }
+    
+    processUserEvent(event);
+}
+
+void AntiAbuseEngine::processUserEvent(VoteEvent& event) {
+    const std::string& userId = event.userId;
+    AbuseShard& shard = shardFor(userId);
     
     // Add to user history
-    userVoteHistory[userId].push_back(event);
+    auto& history = shard.userVoteHistory[userId];
+    event.voteId = "VOTE_" + std::to_string(history.size());
+    history.push_back(event);
     
     // Update velocity window
-    if (userVelocityWindows.find(userId) == userVelocityWindows.end()) {
-        userVelocityWindows[userId] = SlidingWindow(velocityWindowSeconds);
+    auto windowIt = shard.userVelocityWindows.find(userId);
+    if (windowIt == shard.userVelocityWindows.end()) {
+        windowIt = shard.userVelocityWindows.emplace(userId, SlidingWindow(velocityWindowSeconds)).first;
     }
-    userVelocityWindows[userId].addEvent(timestamp);
+    windowIt->second.addEvent(event.timestamp);
+    shard.dirtyCredibility.insert(userId);
     
-    // Track IP and device
-    if (!ipHash.empty()) {
-        userIPs[userId].insert(ipHash);
-        ipToUsers[ipHash].push_back(userId);
+    // Linkage and co-voting are shared across users: inline they are applied
+    // before bot scoring, sharded they go to the proposal's cross-user partition
+    if (asyncIngestion) {
+        CrossUserPartition& partition = partitionFor(event.proposalId);
+        partition.enqueued.fetch_add(1, std::memory_order_relaxed);
+        partition.inbox.push(event);
+    } else {
+        processCrossUserEvent(event);
     }
-    if (!deviceHash.empty()) {
-        userDevices[userId].insert(deviceHash);
-        deviceToUsers[deviceHash].push_back(userId);
-    }
-    
-    // Update co-voting graph
-    coVotingGraph.addVote(userId, proposalId);
     
     // Update bot detection for this user
     updateBotDetection(userId);
 }
 
+// The fan-out term of the bot score saturates once a key has this many users,
+// so past it a new member changes no other user's score
+static const size_t kFanoutSaturationUsers = 21;
+
+void AntiAbuseEngine::markLinkedUsersDirty(const LinkageIndex& index, const std::string& key) {
+    if (index.estimateUserCount(key) > kFanoutSaturationUsers) return;
+    
+    for (auto& userId : index.getUsers(key, 0, kFanoutSaturationUsers)) {
+        linkageDirtyUsers.insert(std::move(userId));
+    }
+}
+
+void AntiAbuseEngine::processCrossUserEvent(const VoteEvent& event) {
+    // Track IP and device. A user new to a key changes its fan-out for everyone
+    // sharing it, so their bot features and trust scores become stale.
+    if (!event.ipHash.empty() || !event.deviceHash.empty()) {
+        std::unique_lock<std::shared_mutex> lock(linkageMutex);
+        bool linked = false;
+        if (!event.ipHash.empty() && ipIndex.add(event.ipHash, event.userId)) {
+            markLinkedUsersDirty(ipIndex, event.ipHash);
+            linked = true;
+        }
+        if (!event.deviceHash.empty() && deviceIndex.add(event.deviceHash, event.userId)) {
+            markLinkedUsersDirty(deviceIndex, event.deviceHash);
+            linked = true;
+        }
+        if (linked) {
+            linkageDirtyUsers.insert(event.userId);
+        }
+    }
+    
+    // Update co-voting graph, collecting edges that are strong enough to track.
+    // Batch detection only needs to rerun when the strong subgraph changed.
+    std::vector<std::pair<std::string, int>> strongEdges;
+    if (coVotingGraph.addVote(event.userId, event.proposalId, minCoVotesForCollusion,
+                              streamingDetectionEnabled ? &strongEdges : nullptr)) {
+        coVotingVersion++;
+    }
+    if (!strongEdges.empty()) {
+        updateStreamingCollusion(event.userId, strongEdges, event.timestamp);
+    }
+}
+
 double AntiAbuseEngine::calculateVotingVelocity(const std::string& userId) {
-    auto it = userVelocityWindows.find(userId);
-    if (it != userVelocityWindows.end()) {
+    const auto& windows = shardFor(userId).userVelocityWindows;
+    auto it = windows.find(userId);
+    if (it != windows.end()) {
         return it->second.getRate();
     }
     return 0.0;
 }
 
 double AntiAbuseEngine::calculateAvgInterVoteGap(const std::string& userId) {
-    auto it = userVelocityWindows.find(userId);
-    if (it != userVelocityWindows.end()) {
+    const auto& windows = shardFor(userId).userVelocityWindows;
+    auto it = windows.find(userId);
+    if (it != windows.end()) {
         return it->second.getAverageGapMs();
     }
     return 0.0;
@@ -205,12 +1079,18 @@ bool AntiAbuseEngine::detectBotBehavior(const std::string& userId) {
 }
 
 void AntiAbuseEngine::updateBotDetection(const std::string& userId) {
+    AbuseShard& shard = shardFor(userId);
+    
     BotDetectionResult result;
     result.userId = userId;
     result.votingVelocity = calculateVotingVelocity(userId);
     result.avgInterVoteGapMs = calculateAvgInterVoteGap(userId);
-    result.deviceDiversity = userDevices[userId].size();
-    result.ipDiversity = userIPs[userId].size();
+    {
+        std::shared_lock<std::shared_mutex> lock(linkageMutex);
+        result.deviceDiversity = deviceIndex.getKeyCountForUser(userId);
+        result.ipDiversity = ipIndex.getKeyCountForUser(userId);
+        result.sharedIPFanout = ipIndex.getMaxFanoutForUser(userId);
+    }
     result.isSuspicious = detectBotBehavior(userId);
     
     // Calculate bot likelihood score (0-1)
@@ -219,9 +1099,11 @@ void AntiAbuseEngine::updateBotDetection(const std::string& userId) {
                       ? (1.0 - result.avgInterVoteGapMs / deltaThresholdMs) : 0.0;
     double deviceScore = (result.deviceDiversity == 1) ? 0.3 : 0.0;  // Single device suspicious
     double ipScore = (result.ipDiversity == 1) ? 0.2 : 0.0;          // Single IP suspicious
+    double fanoutScore = std::min(0.2, (result.sharedIPFanout - 1.0) / 100.0);  // Crowded IP
     
     result.botLikelihood = std::min(1.0, 
-        0.4 * velocityScore + 0.4 * gapScore + deviceScore + ipScore);
+        0.4 * velocityScore + 0.4 * gapScore + deviceScore + ipScore +
+        std::max(0.0, fanoutScore));
     
     // Generate reason
     std::stringstream ss;
@@ -233,13 +1115,13 @@ void AntiAbuseEngine::updateBotDetection(const std::string& userId) {
         ss << "Low inter-vote gap (" << std::fixed << std::setprecision(0) 
            << result.avgInterVoteGapMs << "ms). ";
     }
-    if (result.deviceDiversity == 1 && userVoteHistory[userId].size() > 10) {
+    if (result.deviceDiversity == 1 && shard.userVoteHistory[userId].size() > 10) {
         ss << "Single device used. ";
     }
     result.reason = ss.str();
     
     // Cache result
-    botDetectionCache[userId] = result;
+    shard.botDetectionCache[userId] = result;
     
     // Generate alert if suspicious
     if (result.isSuspicious && result.botLikelihood > botLikelihoodThreshold) {
@@ -250,25 +1132,31 @@ void AntiAbuseEngine::updateBotDetection(const std::string& userId) {
 }
 
 BotDetectionResult AntiAbuseEngine::detectBot(const std::string& userId) {
+    flush();
+    refreshLinkedBotDetection(userId);
+    
     // Check cache first
-    auto it = botDetectionCache.find(userId);
-    if (it != botDetectionCache.end()) {
+    auto& cache = shardFor(userId).botDetectionCache;
+    auto it = cache.find(userId);
+    if (it != cache.end()) {
         return it->second;
     }
     
     // Calculate and cache
     updateBotDetection(userId);
-    return botDetectionCache[userId];
+    return cache[userId];
 }
 
 std::vector<BotDetectionResult> AntiAbuseEngine::detectAllBots() {
+    flush();
     std::vector<BotDetectionResult> results;
     
-    for (const auto& pair : userVoteHistory) {
-        const std::string& userId = pair.first;
-        BotDetectionResult result = detectBot(userId);
-        if (result.isSuspicious) {
-            results.push_back(result);
+    for (const auto& shard : shards) {
+        for (const auto& pair : shard->userVoteHistory) {
+            BotDetectionResult result = detectBot(pair.first);
+            if (result.isSuspicious) {
+                results.push_back(result);
+            }
         }
     }
     
@@ -282,29 +1170,22 @@ std::vector<BotDetectionResult> AntiAbuseEngine::detectAllBots() {
 }
 
 void AntiAbuseEngine::updateCollusionDetection() {
+    flush();
     collusionDetectionCache.clear();
     
     // Detect communities (suspicious groups)
-    auto communities = coVotingGraph.detectCommunities(minCoVotesForCollusion);
+    auto communities = coVotingGraph.detectCommunityClusters(minCoVotesForCollusion);
     
-    for (const auto& community : communities) {
+    for (const auto& cluster : communities) {
+        const auto& community = cluster.members;
         if (community.size() < 2) continue;
         
         CollusionDetectionResult result;
         result.userGroup = community;
         
-        // Calculate collusion metrics
-        int totalCoVotes = 0;
-        int edgeCount = 0;
-        for (size_t i = 0; i < community.size(); i++) {
-            for (size_t j = i + 1; j < community.size(); j++) {
-                int coVotes = coVotingGraph.getCoVoteCount(community[i], community[j]);
-                if (coVotes > 0) {
-                    totalCoVotes += coVotes;
-                    edgeCount++;
-                }
-            }
-        }
+        // Collusion metrics come from the internal edge statistics
+        int totalCoVotes = cluster.internalCoVotes;
+        int edgeCount = cluster.internalEdges;
         
         result.coVoteCount = totalCoVotes;
         
@@ -337,6 +1218,62 @@ void AntiAbuseEngine::updateCollusionDetection() {
             }
         }
     }
+    
+    // Rebuild the user -> group reverse index; users whose score moved become dirty
+    std::unordered_map<std::string, double> memberships;
+    for (const auto& result : collusionDetectionCache) {
+        for (const auto& userId : result.userGroup) {
+            double& best = memberships[userId];
+            best = std::max(best, result.collusionScore);
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(collusionMutex);
+    
+    // Rings raised by streaming detection stand until the user is cleared, even
+    // if the batch pass does not group them
+    for (const auto& pair : streamingCollusionScores) {
+        double& best = memberships[pair.first];
+        best = std::max(best, pair.second);
+    }
+    for (const auto& pair : userCollusionScores) {
+        auto it = memberships.find(pair.first);
+        if (it == memberships.end() || it->second != pair.second) {
+            collusionDirtyUsers.insert(pair.first);
+        }
+    }
+    for (const auto& pair : memberships) {
+        if (!userCollusionScores.count(pair.first)) {
+            collusionDirtyUsers.insert(pair.first);
+        }
+    }
+    userCollusionScores.swap(memberships);
+    collusionDetectedVersion = coVotingVersion;
+}
+
+void AntiAbuseEngine::updateStreamingCollusion(const std::string& userId,
+                                               const std::vector<std::pair<std::string, int>>& strongEdges,
+                                               const std::chrono::system_clock::time_point& timestamp) {
+    std::vector<CollusionDetectionResult> rings;
+    {
+        std::lock_guard<std::mutex> lock(streamingMutex);
+        for (const auto& edge : strongEdges) {
+            CollusionDetectionResult result;
+            if (streamingDetector.observeStrongEdge(userId, edge.first, edge.second,
+                                                    timestamp, collusionThreshold, result)) {
+                rings.push_back(std::move(result));
+            }
+        }
+    }
+    
+    for (const auto& result : rings) {
+        generateThreatAlert("collusion_detected", result.collusionScore,
+                          result.userGroup, result.description);
+        for (const auto& member : result.userGroup) {
+            markUserSuspicious(member, "Part of collusion group");
+            setCollusionScore(member, result.collusionScore);
+        }
+    }
 }
 
 std::vector<CollusionDetectionResult> AntiAbuseEngine::detectCollusion() {
@@ -347,7 +1284,7 @@ std::vector<CollusionDetectionResult> AntiAbuseEngine::detectCollusion() {
 double AntiAbuseEngine::calculateAccountAgeScore(const std::string& userId) {
     // Simplified: assume older accounts are more trustworthy
     // In production, use actual account creation date
-    int voteCount = userVoteHistory[userId].size();
+    int voteCount = shardFor(userId).userVoteHistory[userId].size();
     return std::min(1.0, voteCount / 50.0);  // Max at 50 votes
 }
 
@@ -369,7 +1306,11 @@ UserCredibilityScore AntiAbuseEngine::calculateUserCredibility(const std::string
     score.accountAgeScore = calculateAccountAgeScore(userId);
     
     // Device diversity score (inverse - less diversity is better for trust)
-    int deviceCount = userDevices[userId].size();
+    int deviceCount;
+    {
+        std::shared_lock<std::shared_mutex> lock(linkageMutex);
+        deviceCount = deviceIndex.getKeyCountForUser(userId);
+    }
     score.deviceDiversityScore = (deviceCount == 0) ? 0.5 :
                                  (deviceCount == 1) ? 0.8 :
                                  (deviceCount == 2) ? 0.6 : 0.3;
@@ -380,14 +1321,13 @@ UserCredibilityScore AntiAbuseEngine::calculateUserCredibility(const std::string
     // Verification score (simplified - in production, check email/phone verification)
     score.verificationScore = 0.5;
     
-    // Collusion score (check if user is in any collusion group)
+    // Collusion score (highest among groups containing the user)
     score.collusionScore = 0.0;
-    for (const auto& collusionResult : collusionDetectionCache) {
-        for (const auto& user : collusionResult.userGroup) {
-            if (user == userId) {
-                score.collusionScore = std::max(score.collusionScore, 
-                                               collusionResult.collusionScore);
-            }
+    {
+        std::lock_guard<std::mutex> lock(collusionMutex);
+        auto it = userCollusionScores.find(userId);
+        if (it != userCollusionScores.end()) {
+            score.collusionScore = it->second;
         }
     }
     
@@ -415,19 +1355,78 @@ UserCredibilityScore AntiAbuseEngine::calculateUserCredibility(const std::string
     return score;
 }
 
+void AntiAbuseEngine::setCollusionScore(const std::string& userId, double collusionScore) {
+    std::lock_guard<std::mutex> lock(collusionMutex);
+    double& streamed = streamingCollusionScores[userId];
+    streamed = std::max(streamed, collusionScore);
+    
+    double& current = userCollusionScores[userId];
+    if (collusionScore > current) {
+        current = collusionScore;
+        collusionDirtyUsers.insert(userId);
+    }
+}
+
+bool AntiAbuseEngine::refreshLinkedBotDetection(const std::string& userId) {
+    {
+        std::unique_lock<std::shared_mutex> lock(linkageMutex);
+        if (linkageDirtyUsers.erase(userId) == 0) return false;
+    }
+    
+    updateBotDetection(userId);
+    shardFor(userId).dirtyCredibility.insert(userId);
+    return true;
+}
+
+bool AntiAbuseEngine::takeDirtyCredibility(const std::string& userId) {
+    refreshLinkedBotDetection(userId);
+    bool dirty = shardFor(userId).dirtyCredibility.erase(userId) > 0;
+    
+    std::lock_guard<std::mutex> lock(collusionMutex);
+    return collusionDirtyUsers.erase(userId) > 0 || dirty;
+}
+
 void AntiAbuseEngine::calculateAllCredibilityScores() {
-    // Update collusion detection first
-    updateCollusionDetection();
+    flush();
+    
+    // Collusion detection only when the co-voting graph changed since last run
+    if (collusionDetectedVersion != coVotingVersion) {
+        updateCollusionDetection();
+    }
     
-    // Calculate for all users
-    for (const auto& pair : userVoteHistory) {
-        calculateUserCredibility(pair.first);
+    // Users whose linkage changed get fresh bot features first
+    std::unordered_set<std::string> linkedUsers;
+    {
+        std::unique_lock<std::shared_mutex> lock(linkageMutex);
+        linkedUsers.swap(linkageDirtyUsers);
+    }
+    for (const auto& userId : linkedUsers) {
+        updateBotDetection(userId);
+    }
+    
+    // Collect dirty users, then recompute just those
+    std::unordered_set<std::string> dirtyUsers(linkedUsers.begin(), linkedUsers.end());
+    for (auto& shard : shards) {
+        dirtyUsers.insert(shard->dirtyCredibility.begin(), shard->dirtyCredibility.end());
+        shard->dirtyCredibility.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(collusionMutex);
+        dirtyUsers.insert(collusionDirtyUsers.begin(), collusionDirtyUsers.end());
+        collusionDirtyUsers.clear();
+    }
+    
+    for (const auto& userId : dirtyUsers) {
+        calculateUserCredibility(userId);
     }
 }
 
 double AntiAbuseEngine::getUserTrustScore(const std::string& userId) {
+    flush();
+    
+    bool dirty = takeDirtyCredibility(userId);
     auto it = userCredibilityScores.find(userId);
-    if (it != userCredibilityScores.end()) {
+    if (it != userCredibilityScores.end() && !dirty) {
         return it->second.trustScore;
     }
     
@@ -437,10 +1436,13 @@ double AntiAbuseEngine::getUserTrustScore(const std::string& userId) {
 }
 
 void AntiAbuseEngine::markUserSuspicious(const std::string& userId, const std::string& reason) {
+    std::lock_guard<std::mutex> lock(suspiciousMutex);
     suspiciousUsers[userId] = true;
 }
 
 bool AntiAbuseEngine::isUserSuspicious(const std::string& userId) const {
+    flush();
+    std::lock_guard<std::mutex> lock(suspiciousMutex);
     auto it = suspiciousUsers.find(userId);
     return it != suspiciousUsers.end() && it->second;
 }
@@ -449,41 +1451,23 @@ void AntiAbuseEngine::generateThreatAlert(const std::string& alertType,
                                          double severity,
                                          const std::vector<std::string>& users,
                                          const std::string& description) {
-    ThreatAlert alert;
-    
-    static int alertCounter = 0;
-    alert.alertId = "ALERT_" + std::to_string(++alertCounter);
-    alert.alertType = alertType;
-    alert.severity = severity;
-    alert.involvedUsers = users;
-    alert.description = description;
-    alert.timestamp = std::chrono::system_clock::now();
-    alert.resolved = false;
-    
-    threatAlerts.push_back(alert);
+    alertStore.raise(alertType, severity, users, description);
 }
 
 std::vector<ThreatAlert> AntiAbuseEngine::getThreatAlerts(bool unresolvedOnly) const {
-    if (!unresolvedOnly) {
-        return threatAlerts;
-    }
-    
-    std::vector<ThreatAlert> unresolved;
-    for (const auto& alert : threatAlerts) {
-        if (!alert.resolved) {
-            unresolved.push_back(alert);
-        }
-    }
-    return unresolved;
+    flush();
+    return alertStore.getAlerts(unresolvedOnly);
+}
+
+std::vector<ThreatAlert> AntiAbuseEngine::getThreatAlertsSince(uint64_t cursor, size_t maxAlerts,
+                                                               uint64_t& nextCursor) const {
+    flush();
+    return alertStore.getAlertsSince(cursor, maxAlerts, nextCursor);
 }
 
 void AntiAbuseEngine::resolveThreatAlert(const std::string& alertId) {
-    for (auto& alert : threatAlerts) {
-        if (alert.alertId == alertId) {
-            alert.resolved = true;
-            break;
-        }
-    }
+    flush();
+    alertStore.resolve(alertId);
 }
 
 std::string AntiAbuseEngine::performSecurityScan() {
@@ -516,21 +1500,33 @@ std::string AntiAbuseEngine::performSecurityScan() {
     ss << "\n";
     
     // Threat alerts
-    auto alerts = getThreatAlerts(true);
-    ss << "Active Threat Alerts: " << alerts.size() << "\n\n";
+    ss << "Active Threat Alerts: " << alertStore.getUnresolvedCount() << "\n\n";
     
     return ss.str();
 }
 
 std::string AntiAbuseEngine::getSecurityStatistics() const {
+    flush();
     std::stringstream ss;
     
     ss << "\n=== Anti-Abuse Engine Statistics ===\n\n";
-    ss << "Total users tracked: " << userVoteHistory.size() << "\n";
-    ss << "Suspicious users: " << suspiciousUsers.size() << "\n";
-    ss << "Total threat alerts: " << threatAlerts.size() << "\n";
-    ss << "Unresolved alerts: " << getThreatAlerts(true).size() << "\n";
-    ss << "Co-voting graph edges: " << coVotingGraph.getEdgeCount() << "\n\n";
+    size_t totalUsers = 0;
+    for (const auto& shard : shards) {
+        totalUsers += shard->userVoteHistory.size();
+    }
+    size_t suspiciousCount;
+    {
+        std::lock_guard<std::mutex> lock(suspiciousMutex);
+        suspiciousCount = suspiciousUsers.size();
+    }
+    
+    ss << "Total users tracked: " << totalUsers << "\n";
+    ss << "Suspicious users: " << suspiciousCount << "\n";
+    ss << "Total threat alerts: " << alertStore.size() << "\n";
+    ss << "Unresolved alerts: " << alertStore.getUnresolvedCount() << "\n";
+    ss << "Co-voting graph edges: " << coVotingGraph.getEdgeCount() << "\n";
+    ss << "Tracked IPs: " << ipIndex.getKeyCount()
+       << ", devices: " << deviceIndex.getKeyCount() << "\n\n";
     
     ss << "Configuration:\n";
     ss << "  Velocity threshold: " << velocityThreshold << " votes/min\n";
@@ -542,8 +1538,10 @@ std::string AntiAbuseEngine::getSecurityStatistics() const {
 }
 
 int AntiAbuseEngine::getVoteCountInWindow(const std::string& userId, int windowSeconds) const {
-    auto it = userVoteHistory.find(userId);
-    if (it == userVoteHistory.end()) return 0;
+    flush();
+    const auto& history = shardFor(userId).userVoteHistory;
+    auto it = history.find(userId);
+    if (it == history.end()) return 0;
     
     auto now = std::chrono::system_clock::now();
     auto cutoff = now - std::chrono::seconds(windowSeconds);
@@ -558,26 +1556,39 @@ int AntiAbuseEngine::getVoteCountInWindow(const std::string& userId, int windowS
     return count;
 }
 
-std::vector<std::string> AntiAbuseEngine::getUsersWithSameIP(const std::string& ipHash) const {
-    auto it = ipToUsers.find(ipHash);
-    if (it != ipToUsers.end()) {
-        return it->second;
-    }
-    return {};
+std::vector<std::string> AntiAbuseEngine::getUsersWithSameIP(const std::string& ipHash,
+                                                             size_t offset,
+                                                             size_t limit) const {
+    flush();
+    std::shared_lock<std::shared_mutex> lock(linkageMutex);
+    return ipIndex.getUsers(ipHash, offset, limit);
 }
 
-std::vector<std::string> AntiAbuseEngine::getUsersWithSameDevice(const std::string& deviceHash) const {
-    auto it = deviceToUsers.find(deviceHash);
-    if (it != deviceToUsers.end()) {
-        return it->second;
-    }
-    return {};
+std::vector<std::string> AntiAbuseEngine::getUsersWithSameDevice(const std::string& deviceHash,
+                                                                 size_t offset,
+                                                                 size_t limit) const {
+    flush();
+    std::shared_lock<std::shared_mutex> lock(linkageMutex);
+    return deviceIndex.getUsers(deviceHash, offset, limit);
+}
+
+double AntiAbuseEngine::getEstimatedUsersOnIP(const std::string& ipHash) const {
+    flush();
+    std::shared_lock<std::shared_mutex> lock(linkageMutex);
+    return ipIndex.estimateUserCount(ipHash);
+}
+
+std::vector<std::pair<std::string, uint64_t>> AntiAbuseEngine::getTopSharedIPs(size_t k) const {
+    flush();
+    std::shared_lock<std::shared_mutex> lock(linkageMutex);
+    return ipIndex.getHeavyHitters(k);
 }
 
 void AntiAbuseEngine::configureThresholds(double velThreshold,
                                          double deltaThreshold,
                                          double collusionThresh,
                                          double botThresh) {
+    flush();
     velocityThreshold = velThreshold;
     deltaThresholdMs = deltaThreshold;
     collusionThreshold = collusionThresh;
@@ -593,30 +1604,59 @@ std::string AntiAbuseEngine::getConfiguration() const {
     ss << "  Collusion Threshold: " << collusionThreshold << "\n";
     ss << "  Bot Likelihood Threshold: " << botLikelihoodThreshold << "\n";
     ss << "  Velocity Window: " << velocityWindowSeconds << " seconds\n";
+    ss << "  Streaming Collusion Detection: "
+       << (streamingDetectionEnabled ? "on" : "off")
+       << " (" << streamingDetector.getWindowSeconds() << "s window)\n";
+    if (asyncIngestion) {
+        ss << "  Worker Shards: " << shards.size() << "\n";
+    } else {
+        ss << "  Worker Shards: inline\n";
+    }
     return ss.str();
 }
 
 void AntiAbuseEngine::clearAll() {
-    userVoteHistory.clear();
-    userVelocityWindows.clear();
-    userIPs.clear();
-    userDevices.clear();
-    ipToUsers.clear();
-    deviceToUsers.clear();
+    flush();
+    for (auto& shard : shards) {
+        shard->userVoteHistory.clear();
+        shard->userVelocityWindows.clear();
+        shard->botDetectionCache.clear();
+        shard->dirtyCredibility.clear();
+    }
+    {
+        std::lock_guard<std::mutex> lock(collusionMutex);
+        userCollusionScores.clear();
+        streamingCollusionScores.clear();
+        collusionDirtyUsers.clear();
+    }
+    ipIndex.clear();
+    deviceIndex.clear();
+    linkedUserIds.clear();
+    linkageDirtyUsers.clear();
     coVotingGraph.clear();
-    botDetectionCache.clear();
+    streamingDetector.clear();
     collusionDetectionCache.clear();
     userCredibilityScores.clear();
-    threatAlerts.clear();
+    alertStore.clear();
     suspiciousUsers.clear();
 }
 
 void AntiAbuseEngine::clearUser(const std::string& userId) {
-    userVoteHistory.erase(userId);
-    userVelocityWindows.erase(userId);
-    userIPs.erase(userId);
-    userDevices.erase(userId);
-    botDetectionCache.erase(userId);
+    flush();
+    AbuseShard& shard = shardFor(userId);
+    shard.userVoteHistory.erase(userId);
+    shard.userVelocityWindows.erase(userId);
+    shard.botDetectionCache.erase(userId);
+    shard.dirtyCredibility.erase(userId);
+    {
+        std::lock_guard<std::mutex> lock(collusionMutex);
+        userCollusionScores.erase(userId);
+        streamingCollusionScores.erase(userId);
+        collusionDirtyUsers.erase(userId);
+    }
+    ipIndex.removeUser(userId);
+    deviceIndex.removeUser(userId);
+    linkageDirtyUsers.erase(userId);
     userCredibilityScores.erase(userId);
     suspiciousUsers.erase(userId);
 }
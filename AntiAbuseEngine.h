@@ -9,7 +9,15 @@
 #include <memory>
 #include <chrono>
 #include <queue>
+#include <deque>
 #include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <cstdint>
+#include <limits>
+#include "StringInterner.h"
 
 /**
  * Structure for vote event tracking
@@ -40,12 +48,13 @@ struct BotDetectionResult {
     double avgInterVoteGapMs;       // average milliseconds between votes
     int deviceDiversity;            // number of unique devices
     int ipDiversity;                // number of unique IPs
+    double sharedIPFanout;          // estimated users behind the user's most shared IP
     bool isSuspicious;              // exceeds thresholds
     std::string reason;             // explanation
     
     BotDetectionResult()
         : botLikelihood(0.0), votingVelocity(0.0), avgInterVoteGapMs(0.0),
-          deviceDiversity(0), ipDiversity(0), isSuspicious(false) {}
+          deviceDiversity(0), ipDiversity(0), sharedIPFanout(0.0), isSuspicious(false) {}
 };
 
 /**
@@ -74,9 +83,10 @@ struct ThreatAlert {
     std::string description;
     std::chrono::system_clock::time_point timestamp;
     bool resolved;
+    int occurrences;            // times raised again within the cooldown
     
     ThreatAlert()
-        : severity(0.0), resolved(false) {}
+        : severity(0.0), resolved(false), occurrences(1) {}
 };
 
 /**
@@ -122,26 +132,421 @@ public:
     double getAverageGapMs() const;
 };
 
+/**
+ * Compressed sparse row snapshot of the co-voting graph
+ * Users are mapped to dense indices; only edges meeting the co-vote floor drive
+ * community detection. Weaker edges between snapshot users are kept in a second
+ * CSR so community statistics still count every co-voting pair.
+ */
+struct CoVoteCSR {
+    std::vector<std::string> userIds;   // index -> user id
+    std::vector<int> offsets;           // row start per user (size = users + 1)
+    std::vector<int> neighbors;         // neighbor index per edge
+    std::vector<int> weights;           // co-vote count per edge
+    
+    std::vector<int> weakOffsets;       // same layout, edges below the co-vote floor
+    std::vector<int> weakNeighbors;
+    std::vector<int> weakWeights;
+    
+    int getUserCount() const { return static_cast<int>(userIds.size()); }
+};
+
+/**
+ * Community found in the co-voting graph, with its internal edge statistics
+ */
+struct CoVoteCommunity {
+    std::vector<std::string> members;
+    int internalEdges;          // co-voting pairs with both members inside the community
+    int internalCoVotes;        // sum of co-votes over those pairs
+    
+    CoVoteCommunity() : internalEdges(0), internalCoVotes(0) {}
+};
+
 /**
  * Co-voting graph for collusion detection
+ * 
+ * Adjacency rows and proposal voter sets are split into lock-striped partitions,
+ * so addVote may run concurrently for different proposals. Queries must not run
+ * concurrently with addVote.
  */
 class CoVotingGraph {
 private:
-    // adjacency[user1][user2] = number of times they voted together
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> adjacency;
-    
-    // Store vote history per proposal for co-vote calculation
-    std::unordered_map<std::string, std::unordered_set<std::string>> proposalVoters;
+    static constexpr size_t kStripes = 64;
+    
+    // adjacency[user1][user2] = number of times they voted together, striped by user1
+    // strongUsers holds the users with an edge at or above the addVote threshold
+    struct AdjacencyStripe {
+        std::unordered_map<std::string, std::unordered_map<std::string, int>> rows;
+        std::unordered_set<std::string> strongUsers;
+        std::mutex mutex;
+    };
+    
+    // Store vote history per proposal for co-vote calculation, striped by proposal
+    struct VoterStripe {
+        std::unordered_map<std::string, std::unordered_set<std::string>> proposalVoters;
+        std::mutex mutex;
+    };
+    
+    std::vector<AdjacencyStripe> adjacency;
+    std::vector<VoterStripe> voterStripes;
+    
+    static size_t stripeOf(const std::string& key) {
+        return std::hash<std::string>()(key) % kStripes;
+    }
+    const std::unordered_map<std::string, int>* findRow(const std::string& userId) const;
     
 public:
-    void addVote(const std::string& userId, const std::string& proposalId);
+    CoVotingGraph();
+    
+    /**
+     * Add a vote and update co-vote counts with every earlier voter on the proposal
+     * @param strongThreshold Co-vote count at which an edge counts as strong
+     * @param strongEdges If set, receives (co-voter, count) for edges at or above the threshold
+     * @return True if the strong subgraph changed: an edge reached or grew past the
+     *         threshold, or an edge between two users that already have strong edges grew
+     */
+    bool addVote(const std::string& userId, const std::string& proposalId,
+                 int strongThreshold = 0,
+                 std::vector<std::pair<std::string, int>>* strongEdges = nullptr);
     int getCoVoteCount(const std::string& user1, const std::string& user2) const;
     std::vector<std::string> getNeighbors(const std::string& userId) const;
     int getEdgeCount() const;
+    
+    /**
+     * Build a CSR snapshot keeping only edges with at least minCoVotes co-votes
+     * Users without any such edge are left out
+     */
+    CoVoteCSR buildSnapshot(int minCoVotes = 5) const;
+    
+    /**
+     * Detect communities with multi-threaded weighted label propagation
+     * over a CSR snapshot, so weakly linked dense groups stay separate
+     * @param minCoVotes Minimum co-votes for an edge to be considered
+     * @param numThreads Worker threads (0 = hardware concurrency)
+     * @return Communities of 2+ members with internal edge statistics
+     */
+    std::vector<CoVoteCommunity> detectCommunityClusters(int minCoVotes = 5,
+                                                         int numThreads = 0) const;
     std::vector<std::vector<std::string>> detectCommunities(int minCoVotes = 5);
     void clear();
 };
 
+/**
+ * HyperLogLog cardinality sketch (2^precision one-byte registers)
+ * The harmonic sum is maintained on every register change, so estimate() is O(1)
+ */
+class HyperLogLog {
+private:
+    std::vector<uint8_t> registers;
+    double inverseSum;          // sum of 2^-register
+    int zeroRegisters;
+    int precision;
+    
+public:
+    explicit HyperLogLog(int precisionBits = 10);
+    void add(uint64_t hash);
+    double estimate() const;
+};
+
+/**
+ * Space-Saving top-k heavy hitter counter over integer ids
+ */
+class SpaceSavingCounter {
+private:
+    struct Counter {
+        uint64_t count;
+        uint64_t error;         // overestimate inherited from the evicted item
+    };
+    std::unordered_map<uint32_t, Counter> counters;
+    size_t capacity;
+    
+public:
+    explicit SpaceSavingCounter(size_t maxItems = 64) : capacity(maxItems) {}
+    void add(uint32_t item);
+    std::vector<std::pair<uint32_t, uint64_t>> top(size_t k) const;
+    void clear() { counters.clear(); }
+};
+
+/**
+ * Deduplicated key <-> user linkage (e.g. IP hash or device hash to users)
+ * 
+ * Keys are interned per index; user IDs come from an interner the caller owns, so
+ * several indexes over the same users store each ID once. Each key keeps a sorted,
+ * deduplicated member list capped at maxExactUsers; past the cap only a HyperLogLog
+ * sketch keeps counting, so a single NAT address costs bounded memory. A Space-Saving
+ * counter tracks the busiest keys by event count.
+ */
+class LinkageIndex {
+private:
+    struct KeyEntry {
+        std::vector<uint32_t> users;            // sorted, deduplicated, capped
+        std::unique_ptr<HyperLogLog> sketch;    // allocated once users overflow
+    };
+    
+    StringInterner keys;
+    StringInterner& users;                          // shared with other indexes
+    std::vector<KeyEntry> entries;                  // by key id
+    std::vector<std::vector<uint32_t>> userKeys;    // by user id, sorted key ids
+    SpaceSavingCounter heavyHitters;
+    size_t maxExactUsers;
+    
+public:
+    /**
+     * @param userIds Interner for user IDs; must outlive the index and is not
+     *        cleared by clear()
+     */
+    explicit LinkageIndex(StringInterner& userIds, size_t exactUserCap = 1024,
+                          size_t heavyHitterCapacity = 64);
+    
+    /**
+     * Link a user to a key
+     * @return True if the key's user set may have grown (the user was not an exact member)
+     */
+    bool add(const std::string& key, const std::string& userId);
+    
+    /**
+     * Get deduplicated users linked to a key, paged
+     * Only the first maxExactUsers distinct users are retained per key
+     */
+    std::vector<std::string> getUsers(const std::string& key,
+                                      size_t offset = 0,
+                                      size_t limit = std::numeric_limits<size_t>::max()) const;
+    
+    /**
+     * Estimated number of distinct users linked to a key (exact below the cap), O(1)
+     */
+    double estimateUserCount(const std::string& key) const;
+    
+    /**
+     * Number of distinct keys a user is linked to
+     */
+    size_t getKeyCountForUser(const std::string& userId) const;
+    
+    /**
+     * Largest estimated fan-out among the keys a user is linked to
+     */
+    double getMaxFanoutForUser(const std::string& userId) const;
+    
+    /**
+     * Busiest keys by event count (approximate, Space-Saving)
+     */
+    std::vector<std::pair<std::string, uint64_t>> getHeavyHitters(size_t k) const;
+    
+    size_t getKeyCount() const { return keys.size(); }
+    void removeUser(const std::string& userId);
+    void clear();
+};
+
+/**
+ * Streaming detector for voting rings forming in real time
+ * 
+ * Keeps only recently reinforced strong co-vote edges (bounded by a time window
+ * and an edge cap). Each reinforced edge (u, v) is closed into triangles through
+ * common strong neighbors; when the resulting candidate group is dense enough it
+ * is reported once until it grows or expires.
+ */
+class StreamingCollusionDetector {
+private:
+    struct StrongEdge {
+        std::chrono::system_clock::time_point lastSeen;    // last reinforcement
+        std::chrono::system_clock::time_point queuedAt;    // position in edgeOrder
+        int coVotes;
+    };
+    
+    struct ReportedGroup {
+        std::chrono::system_clock::time_point lastSeen;    // last time the group re-formed
+        std::chrono::system_clock::time_point queuedAt;    // position in reportOrder
+    };
+    
+    std::unordered_map<std::string, std::unordered_map<std::string, StrongEdge>> strongAdjacency;
+    std::deque<std::pair<std::string, std::string>> edgeOrder;   // live edges by queuedAt
+    std::unordered_map<std::string, ReportedGroup> reportedGroups;
+    std::deque<std::string> reportOrder;                         // reported groups by queuedAt
+    size_t edgeCount;
+    
+    // Latest event time seen; the window closes relative to it, so events that
+    // arrive out of order (e.g. from different shards) never move it backwards
+    std::chrono::system_clock::time_point latestTimestamp;
+    
+    std::chrono::seconds windowDuration;
+    size_t maxEdges;
+    size_t minGroupSize;
+    size_t maxGroupSize;
+    double minDensity;
+    
+    const StrongEdge* findEdge(const std::string& user1, const std::string& user2) const;
+    void removeEdge(const std::string& user1, const std::string& user2);
+    void expire(const std::chrono::system_clock::time_point& currentTime);
+    
+public:
+    StreamingCollusionDetector(int windowSeconds = 600,
+                               size_t edgeCap = 100000,
+                               size_t minGroup = 3,
+                               double density = 0.8);
+    
+    /**
+     * Observe a strong co-vote edge that was just reinforced
+     * @param minScore Collusion score a group needs before it is reported
+     * @param group Receives the dense group containing the edge
+     * @return True if a new (or grown) dense group reached minScore
+     */
+    bool observeStrongEdge(const std::string& user1, const std::string& user2,
+                           int coVotes,
+                           const std::chrono::system_clock::time_point& timestamp,
+                           double minScore,
+                           CollusionDetectionResult& group);
+    
+    size_t getTrackedEdgeCount() const { return edgeCount; }
+    int getWindowSeconds() const { return static_cast<int>(windowDuration.count()); }
+    void clear();
+};
+
+/**
+ * Bounded, indexed threat alert history
+ * 
+ * Alerts live in a ring buffer and carry a monotonically increasing sequence
+ * number encoded in their id, so resolving an alert is an O(1) slot lookup.
+ * An unresolved alert with the same type and user set that was raised within
+ * the cooldown absorbs the new occurrence instead of adding another alert.
+ * Consumers can read incrementally with a sequence cursor. Thread-safe.
+ */
+class ThreatAlertStore {
+private:
+    struct Slot {
+        ThreatAlert alert;
+        uint64_t sequence;      // 0 = empty
+        std::string dedupKey;
+        std::chrono::system_clock::time_point lastRaised;
+        
+        Slot() : sequence(0) {}
+    };
+    
+    std::vector<Slot> ring;
+    uint64_t nextSequence;
+    uint64_t clearedBefore;     // clear() drops every sequence below this
+    std::unordered_map<std::string, uint64_t> dedupIndex;    // (type, users) -> live sequence
+    size_t unresolvedCount;
+    std::chrono::seconds cooldown;
+    mutable std::mutex mutex;
+    
+    Slot* findSlot(uint64_t sequence);
+    
+    // First sequence still held: not overwritten by the ring and not cleared
+    uint64_t oldestRetained() const;
+    
+public:
+    ThreatAlertStore(size_t capacity = 10000, int cooldownSeconds = 300);
+    
+    /**
+     * Raise an alert, merging it into a matching unresolved alert within the cooldown
+     * @return True if a new alert was stored
+     */
+    bool raise(const std::string& alertType, double severity,
+               const std::vector<std::string>& users,
+               const std::string& description);
+    
+    /**
+     * Mark an alert resolved
+     * @return True if the alert was found and was unresolved
+     */
+    bool resolve(const std::string& alertId);
+    
+    std::vector<ThreatAlert> getAlerts(bool unresolvedOnly) const;
+    
+    /**
+     * Get retained alerts raised after a cursor, oldest first
+     * @param cursor Sequence of the last alert already consumed (0 = from the start)
+     * @param maxAlerts Maximum alerts to return
+     * @param nextCursor Receives the cursor to pass on the next call
+     */
+    std::vector<ThreatAlert> getAlertsSince(uint64_t cursor, size_t maxAlerts,
+                                            uint64_t& nextCursor) const;
+    
+    size_t size() const;
+    size_t getUnresolvedCount() const;
+    void clear();
+};
+
+/**
+ * Lock-free multi-producer single-consumer queue (intrusive linked list)
+ * Producers only swap the head pointer; the single consumer owns the tail.
+ */
+template <typename T>
+class MPSCQueue {
+private:
+    struct Node {
+        std::atomic<Node*> next;
+        T value;
+        
+        Node() : next(nullptr) {}
+        explicit Node(T&& v) : next(nullptr), value(std::move(v)) {}
+    };
+    
+    std::atomic<Node*> head;    // most recently pushed node
+    Node* tail;                 // consumed stub; tail->next is the next item
+    
+public:
+    MPSCQueue() : head(new Node()), tail(head.load()) {}
+    
+    ~MPSCQueue() {
+        T value;
+        while (pop(value)) {}
+        delete tail;
+    }
+    
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator=(const MPSCQueue&) = delete;
+    
+    void push(T value) {
+        Node* node = new Node(std::move(value));
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+    
+    bool pop(T& value) {
+        Node* next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        value = std::move(next->value);
+        delete tail;
+        tail = next;
+        return true;
+    }
+};
+
+/**
+ * Per-user state partition
+ * Users are routed to shards by hash; in sharded mode each shard is owned by
+ * one worker thread that drains its inbox.
+ */
+struct AbuseShard {
+    std::unordered_map<std::string, std::vector<VoteEvent>> userVoteHistory;
+    std::unordered_map<std::string, SlidingWindow> userVelocityWindows;
+    std::unordered_map<std::string, BotDetectionResult> botDetectionCache;
+    std::unordered_set<std::string> dirtyCredibility;   // users whose inputs changed
+    
+    MPSCQueue<VoteEvent> inbox;
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> processed;
+    std::thread worker;
+    
+    AbuseShard() : enqueued(0), processed(0) {}
+};
+
+/**
+ * Cross-user update partition
+ * In sharded mode vote events are routed here by proposal hash, so co-voting
+ * graph updates (the O(voters per proposal) part of a vote) spread over one
+ * worker per partition instead of funneling through a single thread.
+ */
+struct CrossUserPartition {
+    MPSCQueue<VoteEvent> inbox;
+    std::atomic<uint64_t> enqueued;
+    std::atomic<uint64_t> processed;
+    std::thread worker;
+    
+    CrossUserPartition() : enqueued(0), processed(0) {}
+};
+
 /**
  * AntiAbuseEngine: Comprehensive anti-abuse detection system
  * 
@@ -153,31 +558,50 @@ public:
  */
 class AntiAbuseEngine {
 private:
-    // Vote event storage
-    std::unordered_map<std::string, std::vector<VoteEvent>> userVoteHistory;
-    std::unordered_map<std::string, SlidingWindow> userVelocityWindows;
+    // Per-user vote history, velocity windows and bot cache, partitioned by user
+    std::vector<std::unique_ptr<AbuseShard>> shards;
+    
+    // Cross-user updates (linkage, co-voting graph) in sharded mode, partitioned by proposal
+    std::vector<std::unique_ptr<CrossUserPartition>> crossUserPartitions;
+    std::atomic<bool> workersRunning;
+    bool asyncIngestion;
+    
+    // IP and device tracking over one set of interned user IDs
+    StringInterner linkedUserIds;
+    LinkageIndex ipIndex;
+    LinkageIndex deviceIndex;
+    mutable std::shared_mutex linkageMutex;     // shard workers read, cross-user workers write
     
-    // IP and device tracking
-    std::unordered_map<std::string, std::unordered_set<std::string>> userIPs;
-    std::unordered_map<std::string, std::unordered_set<std::string>> userDevices;
-    std::unordered_map<std::string, std::vector<std::string>> ipToUsers;
-    std::unordered_map<std::string, std::vector<std::string>> deviceToUsers;
+    // Users whose cached bot features are stale because a key they share gained
+    // a user (guarded by linkageMutex)
+    std::unordered_set<std::string> linkageDirtyUsers;
     
     // Co-voting graph for collusion detection
     CoVotingGraph coVotingGraph;
     
-    // Bot detection cache
-    std::unordered_map<std::string, BotDetectionResult> botDetectionCache;
+    // Real-time ring detection over recently reinforced edges
+    StreamingCollusionDetector streamingDetector;
+    std::mutex streamingMutex;                  // cross-user workers share the detector
     
     // Collusion detection cache
     std::vector<CollusionDetectionResult> collusionDetectionCache;
+    std::atomic<uint64_t> coVotingVersion;      // bumped when the strong co-voting subgraph changes
+    uint64_t collusionDetectedVersion;          // graph version of the last batch detection
+    
+    // user -> highest collusion score among groups containing the user; batch
+    // detection merges with the rings raised by streaming detection
+    std::unordered_map<std::string, double> userCollusionScores;
+    std::unordered_map<std::string, double> streamingCollusionScores;
+    std::unordered_set<std::string> collusionDirtyUsers;
+    mutable std::mutex collusionMutex;          // guards the three members above
     
-    // User credibility scores
+    // User credibility scores (recomputed only for dirty users)
     std::unordered_map<std::string, UserCredibilityScore> userCredibilityScores;
     
     // Threat alerts
-    std::vector<ThreatAlert> threatAlerts;
+    ThreatAlertStore alertStore;
     std::unordered_map<std::string, bool> suspiciousUsers;
+    mutable std::mutex suspiciousMutex;
     
     // Configuration thresholds
     double velocityThreshold;           // votes per minute (default: 30)
@@ -186,17 +610,35 @@ private:
     double collusionThreshold;          // collusion score threshold (default: 0.7)
     double botLikelihoodThreshold;      // bot likelihood threshold (default: 0.7)
     int velocityWindowSeconds;          // sliding window size (default: 60)
+    std::atomic<bool> streamingDetectionEnabled;    // real-time ring detection (default: on);
+                                                    // read by cross-user workers
     
     // Helper methods
+    AbuseShard& shardFor(const std::string& userId) const;
+    CrossUserPartition& partitionFor(const std::string& proposalId) const;
+    void processUserEvent(VoteEvent& event);
+    void processCrossUserEvent(const VoteEvent& event);
+    void runShardWorker(AbuseShard& shard);
+    void runCrossUserWorker(CrossUserPartition& partition);
+    void stopWorkers();
+    
     double calculateVotingVelocity(const std::string& userId);
     double calculateAvgInterVoteGap(const std::string& userId);
     bool detectBotBehavior(const std::string& userId);
     void updateBotDetection(const std::string& userId);
     void updateCollusionDetection();
+    void updateStreamingCollusion(const std::string& userId,
+                                  const std::vector<std::pair<std::string, int>>& strongEdges,
+                                  const std::chrono::system_clock::time_point& timestamp);
     void generateThreatAlert(const std::string& alertType, double severity,
                             const std::vector<std::string>& users,
                             const std::string& description);
     
+    void setCollusionScore(const std::string& userId, double collusionScore);
+    void markLinkedUsersDirty(const LinkageIndex& index, const std::string& key);
+    bool refreshLinkedBotDetection(const std::string& userId);
+    bool takeDirtyCredibility(const std::string& userId);
+    
     double calculateAccountAgeScore(const std::string& userId);
     double calculateMajorityAgreementScore(const std::string& userId);
     
@@ -206,13 +648,35 @@ public:
      * @param velThreshold Voting velocity threshold (votes/min)
      * @param deltaThreshold Average inter-vote gap threshold (ms)
      * @param windowSeconds Sliding window size for velocity tracking
+     * @param workerShards Number of worker shards (0 = process votes inline)
      */
     AntiAbuseEngine(double velThreshold = 30.0,
                    double deltaThreshold = 200.0,
-                   int windowSeconds = 60);
+                   int windowSeconds = 60,
+                   int workerShards = 0);
+    
+    ~AntiAbuseEngine();
+    
+    AntiAbuseEngine(const AntiAbuseEngine&) = delete;
+    AntiAbuseEngine& operator=(const AntiAbuseEngine&) = delete;
+    
+    /**
+     * Wait until every queued vote event has been processed
+     * Queries call this first; in inline mode it is a no-op. Queries must not
+     * run concurrently with recordVoteEvent.
+     */
+    void flush() const;
+    
+    /**
+     * Get number of user shards
+     */
+    size_t getShardCount() const { return shards.size(); }
     
     /**
      * Record a vote event
+     * In sharded mode the event is queued to the user's shard and this call
+     * is safe from multiple threads; linkage features used in bot scoring may
+     * trail by the cross-user queue depth.
      * @param userId User who voted
      * @param proposalId Proposal voted on
      * @param timestamp When the vote occurred
@@ -254,13 +718,14 @@ public:
     UserCredibilityScore calculateUserCredibility(const std::string& userId);
     
     /**
-     * Calculate credibility for all users
+     * Refresh credibility for users whose inputs changed since the last call
+     * Reruns collusion detection only if the co-voting graph changed
      */
     void calculateAllCredibilityScores();
     
     /**
      * Get user's trust score (0.0 to 1.0)
-     * Returns default 0.5 if user not found
+     * Recomputes only this user if their inputs changed; never scans the graph
      * @param userId User identifier
      * @return Trust score
      */
@@ -287,6 +752,16 @@ public:
      */
     std::vector<ThreatAlert> getThreatAlerts(bool unresolvedOnly = false) const;
     
+    /**
+     * Get threat alerts raised after a cursor, for incremental consumption
+     * @param cursor Cursor from the previous call (0 = from the oldest retained alert)
+     * @param maxAlerts Maximum number of alerts to return
+     * @param nextCursor Receives the cursor for the next call
+     * @return Alerts in the order they were raised
+     */
+    std::vector<ThreatAlert> getThreatAlertsSince(uint64_t cursor, size_t maxAlerts,
+                                                  uint64_t& nextCursor) const;
+    
     /**
      * Resolve a threat alert
      * @param alertId Alert identifier
@@ -317,16 +792,38 @@ public:
     /**
      * Get users sharing same IP
      * @param ipHash Hashed IP address
-     * @return Vector of user IDs
+     * @param offset Index of first user to return
+     * @param limit Maximum number of users to return
+     * @return Deduplicated user IDs
      */
-    std::vector<std::string> getUsersWithSameIP(const std::string& ipHash) const;
+    std::vector<std::string> getUsersWithSameIP(const std::string& ipHash,
+                                                size_t offset = 0,
+                                                size_t limit = std::numeric_limits<size_t>::max()) const;
     
     /**
      * Get users sharing same device
      * @param deviceHash Hashed device fingerprint
-     * @return Vector of user IDs
+     * @param offset Index of first user to return
+     * @param limit Maximum number of users to return
+     * @return Deduplicated user IDs
      */
-    std::vector<std::string> getUsersWithSameDevice(const std::string& deviceHash) const;
+    std::vector<std::string> getUsersWithSameDevice(const std::string& deviceHash,
+                                                    size_t offset = 0,
+                                                    size_t limit = std::numeric_limits<size_t>::max()) const;
+    
+    /**
+     * Get estimated number of distinct users seen on an IP
+     * @param ipHash Hashed IP address
+     * @return Estimated user count
+     */
+    double getEstimatedUsersOnIP(const std::string& ipHash) const;
+    
+    /**
+     * Get the IPs with the most votes (approximate top-k)
+     * @param k Number of IPs to return
+     * @return (ipHash, vote count) pairs, busiest first
+     */
+    std::vector<std::pair<std::string, uint64_t>> getTopSharedIPs(size_t k = 10) const;
     
     /**
      * Configure detection thresholds
@@ -340,6 +837,13 @@ public:
                             double collusionThresh,
                             double botThresh);
     
+    /**
+     * Enable or disable real-time collusion detection on vote ingestion
+     * Safe while events are being processed; applies to events handled after the call
+     * @param enabled Whether recordVoteEvent feeds the streaming detector
+     */
+    void setStreamingDetection(bool enabled) { streamingDetectionEnabled = enabled; }
+    
     /**
      * Get current configuration
      * @return Configuration string
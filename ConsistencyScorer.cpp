@@ -3,6 +3,7 @@
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <cstdio>
 
 // Initialize static weight variables (default from documentation)
 double WeightedRankingScore::alpha = 0.55;   // relevance
@@ -10,11 +11,295 @@ double WeightedRankingScore::beta = 0.25;    // consistency
 double WeightedRankingScore::gamma = 0.15;   // trust
 double WeightedRankingScore::delta = 0.05;   // recency
 
+RankingWeights RankingWeights::fromDefaults() {
+    return RankingWeights(WeightedRankingScore::alpha, WeightedRankingScore::beta,
+                          WeightedRankingScore::gamma, WeightedRankingScore::delta);
+}
+
+// ==================== Batch Scoring Kernels ====================
+
+// All kernels evaluate ((α*r + β*c) + γ*t) + δ*d in the same order as
+// WeightedRankingScore::calculateFinalScore, so results are bit-identical.
+
+static void scoreBatchScalar(const double* relevance, const double* consistency,
+                             const double* trust, const double* recency,
+                             size_t begin, size_t count,
+                             const RankingWeights& w, double* out) {
+    for (size_t i = begin; i < count; i++) {
+        out[i] = w.alpha * relevance[i] + w.beta * consistency[i] +
+                 w.gamma * trust[i] + w.delta * recency[i];
+    }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define CONSISTENCY_SCORER_X86_KERNELS 1
+
+// GCC would otherwise fuse the mul/add pairs into FMA under AVX-512
+#if !defined(__clang__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+__attribute__((target("avx2")))
+static size_t scoreBatchAVX2(const double* relevance, const double* consistency,
+                             const double* trust, const double* recency,
+                             size_t count, const RankingWeights& w, double* out) {
+    const __m256d a = _mm256_set1_pd(w.alpha);
+    const __m256d b = _mm256_set1_pd(w.beta);
+    const __m256d g = _mm256_set1_pd(w.gamma);
+    const __m256d d = _mm256_set1_pd(w.delta);
+    
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256d sum = _mm256_add_pd(_mm256_mul_pd(a, _mm256_loadu_pd(relevance + i)),
+                                    _mm256_mul_pd(b, _mm256_loadu_pd(consistency + i)));
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(g, _mm256_loadu_pd(trust + i)));
+        sum = _mm256_add_pd(sum, _mm256_mul_pd(d, _mm256_loadu_pd(recency + i)));
+        _mm256_storeu_pd(out + i, sum);
+    }
+    return i;
+}
+
+__attribute__((target("avx512f")))
+static size_t scoreBatchAVX512(const double* relevance, const double* consistency,
+                               const double* trust, const double* recency,
+                               size_t count, const RankingWeights& w, double* out) {
+    const __m512d a = _mm512_set1_pd(w.alpha);
+    const __m512d b = _mm512_set1_pd(w.beta);
+    const __m512d g = _mm512_set1_pd(w.gamma);
+    const __m512d d = _mm512_set1_pd(w.delta);
+    
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m512d sum = _mm512_add_pd(_mm512_mul_pd(a, _mm512_loadu_pd(relevance + i)),
+                                    _mm512_mul_pd(b, _mm512_loadu_pd(consistency + i)));
+        sum = _mm512_add_pd(sum, _mm512_mul_pd(g, _mm512_loadu_pd(trust + i)));
+        sum = _mm512_add_pd(sum, _mm512_mul_pd(d, _mm512_loadu_pd(recency + i)));
+        _mm512_storeu_pd(out + i, sum);
+    }
+    return i;
+}
+
+#if !defined(__clang__)
+#pragma GCC pop_options
+#endif
+#endif
+
+// ==================== SimilarityWindow Implementation ====================
+
+void SimilarityWindow::add(const ProposalSimilarityRecord& record, size_t capacity) {
+    double x = record.similarityScore;
+    
+    if (capacity > 0 && count >= capacity) {
+        // Window full: overwrite the oldest slot and remove it from the moments
+        ProposalSimilarityRecord& oldest = records[head];
+        double y = oldest.similarityScore;
+        oldest = record;
+        head = (head + 1) % records.size();
+        
+        double oldMean = mean;
+        mean += (x - y) / count;
+        m2 += (x - y) * (x - mean + y - oldMean);
+        
+        if (++evictionsSinceResync >= count) {
+            resync();
+        }
+        return;
+    }
+    
+    // Grow: keep storage contiguous from the oldest record before appending
+    if (count == records.size()) {
+        std::rotate(records.begin(), records.begin() + head, records.end());
+        head = 0;
+        records.push_back(record);
+    } else {
+        records[(head + count) % records.size()] = record;
+    }
+    count++;
+    
+    double delta = x - mean;
+    mean += delta / count;
+    m2 += delta * (x - mean);
+}
+
+void SimilarityWindow::shrinkTo(size_t capacity) {
+    if (count <= capacity) return;
+    
+    std::vector<ProposalSimilarityRecord> kept;
+    kept.reserve(capacity);
+    for (size_t i = count - capacity; i < count; i++) {
+        kept.push_back(at(i));
+    }
+    records.swap(kept);
+    head = 0;
+    count = capacity;
+    resync();
+}
+
+void SimilarityWindow::resync() {
+    evictionsSinceResync = 0;
+    if (count == 0) {
+        mean = 0.0;
+        m2 = 0.0;
+        return;
+    }
+    
+    double sum = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        sum += at(i).similarityScore;
+    }
+    mean = sum / count;
+    
+    m2 = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        double diff = at(i).similarityScore - mean;
+        m2 += diff * diff;
+    }
+}
+
+// ==================== DecayedConsistencyState Implementation ====================
+
+void DecayedConsistencyState::add(double similarity, double timestampSeconds, double halfLifeSeconds) {
+    // Timestamps have whole-second resolution and start at the epoch
+    uint32_t now = static_cast<uint32_t>(std::min(std::max(timestampSeconds, 0.0), 4294967295.0));
+    
+    // Age the existing weight; out-of-order records are treated as arriving at lastUpdate
+    double currentWeight = weight;
+    double currentWeightSquared = weightSquared;
+    if (currentWeight > 0.0) {
+        if (now > lastUpdate && halfLifeSeconds > 0.0) {
+            double decay = std::exp2(-static_cast<double>(now - lastUpdate) / halfLifeSeconds);
+            currentWeight *= decay;
+            currentWeightSquared *= decay * decay;
+            m2 *= decay;
+        }
+        lastUpdate = std::max(lastUpdate, now);
+    } else {
+        lastUpdate = now;
+    }
+    
+    // West's weighted update with unit weight for the new observation
+    currentWeight += 1.0;
+    double delta = similarity - mean;
+    mean += delta / currentWeight;
+    m2 += delta * (similarity - mean);
+    weight = static_cast<float>(currentWeight);
+    weightSquared = static_cast<float>(currentWeightSquared + 1.0);
+}
+
+double DecayedConsistencyState::getVariance() const {
+    if (weight <= 0.0f) return 0.0;
+    
+    // Reliability-weighted denominator; equals n - 1 without decay
+    double denominator = static_cast<double>(weight) - static_cast<double>(weightSquared) / weight;
+    if (denominator <= 1e-6 * weight) return 0.0;
+    return std::max(0.0, m2 / denominator);
+}
+
+// ==================== ConsistencyScoreIndex Implementation ====================
+
+size_t ConsistencyScoreIndex::bucketFor(double score) {
+    if (!(score > 0.0)) return 0;
+    return std::min(static_cast<size_t>(score * kBuckets), kBuckets - 1);
+}
+
+void ConsistencyScoreIndex::set(uint32_t slot, double score) {
+    if (slot >= entries.size()) {
+        entries.resize(slot + 1, Entry{0.0, 0, -1});
+    }
+    
+    size_t bucket = bucketFor(score);
+    Entry& entry = entries[slot];
+    if (entry.bucket == static_cast<int32_t>(bucket)) {
+        entry.score = score;
+        return;
+    }
+    
+    remove(slot);
+    entry.score = score;
+    entry.position = buckets[bucket].size();
+    entry.bucket = static_cast<int32_t>(bucket);
+    buckets[bucket].push_back(slot);
+    indexedCount++;
+}
+
+void ConsistencyScoreIndex::remove(uint32_t slot) {
+    if (!contains(slot)) return;
+    
+    // Swap-remove within the bucket
+    Entry& entry = entries[slot];
+    std::vector<uint32_t>& bucket = buckets[entry.bucket];
+    uint32_t moved = bucket.back();
+    bucket[entry.position] = moved;
+    entries[moved].position = entry.position;
+    bucket.pop_back();
+    
+    entry.bucket = -1;
+    indexedCount--;
+}
+
+std::vector<uint32_t> ConsistencyScoreIndex::above(double threshold) const {
+    std::vector<uint32_t> result;
+    size_t boundary = bucketFor(threshold);
+    for (size_t b = kBuckets; b-- > boundary;) {
+        for (uint32_t slot : buckets[b]) {
+            // Only the boundary bucket can hold scores on both sides
+            if (b > boundary || entries[slot].score > threshold) {
+                result.push_back(slot);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> ConsistencyScoreIndex::below(double threshold) const {
+    std::vector<uint32_t> result;
+    size_t boundary = bucketFor(threshold);
+    for (size_t b = 0; b <= boundary; b++) {
+        for (uint32_t slot : buckets[b]) {
+            if (b < boundary || entries[slot].score < threshold) {
+                result.push_back(slot);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<uint32_t> ConsistencyScoreIndex::top(size_t k) const {
+    // Whole buckets from the top until k candidates are collected
+    std::vector<uint32_t> result;
+    for (size_t b = kBuckets; b-- > 0 && result.size() < k;) {
+        result.insert(result.end(), buckets[b].begin(), buckets[b].end());
+    }
+    
+    std::sort(result.begin(), result.end(), [this](uint32_t a, uint32_t b) {
+        return entries[a].score > entries[b].score ||
+               (entries[a].score == entries[b].score && a < b);
+    });
+    if (result.size() > k) result.resize(k);
+    return result;
+}
+
+void ConsistencyScoreIndex::clear() {
+    for (auto& bucket : buckets) {
+        bucket.clear();
+    }
+    entries.clear();
+    indexedCount = 0;
+}
+
+// ==================== ConsistencyScorer Implementation ====================
+
 // Constructor
 ConsistencyScorer::ConsistencyScorer(int windowSize, bool useWindow)
     : rollingWindowSize(windowSize),
       newUserDefaultConsistency(0.5),
-      useRollingWindow(useWindow) {
+      useRollingWindow(useWindow),
+      useDecayedScoring(false),
+      decayHalfLifeSeconds(30.0 * 86400.0),
+      lastTimestampSeconds(0.0),
+      lastTimestampValid(false) {
 }
 
 // Helper: Calculate mean
@@ -24,25 +309,113 @@ double ConsistencyScorer::calculateMean(const std::vector<double>& values) const
     return sum / values.size();
 }
 
-// Helper: Calculate standard deviation
-double ConsistencyScorer::calculateStdDev(const std::vector<double>& values, double mean) const {
-    if (values.size() <= 1) return 0.0;
-    
-    double variance = calculateVariance(values, mean);
-    return std::sqrt(variance);
+// Helper: Slot for a user, assigning one on first use. Decayed state is
+// only allocated in decayed mode, so slots may run past decayedStates.
+uint32_t ConsistencyScorer::acquireSlot(const std::string& userId) {
+    uint32_t slot = userSlots.intern(userId);
+    if (useDecayedScoring && slot >= decayedStates.size()) {
+        decayedStates.resize(slot + 1);
+    }
+    return slot;
 }
 
-// Helper: Calculate variance
-double ConsistencyScorer::calculateVariance(const std::vector<double>& values, double mean) const {
-    if (values.size() <= 1) return 0.0;
-    
-    double sumSquaredDiff = 0.0;
-    for (double value : values) {
-        double diff = value - mean;
-        sumSquaredDiff += diff * diff;
+// Helper: Decayed state of a user, or null if none was ever recorded
+const DecayedConsistencyState* ConsistencyScorer::findDecayedState(const std::string& userId) const {
+    uint32_t slot;
+    if (!userSlots.find(userId, slot) || slot >= decayedStates.size()) return nullptr;
+    return &decayedStates[slot];
+}
+
+// Helper: Reset a user's state and drop its index entry; the slot stays
+// interned so a returning user gets it back
+void ConsistencyScorer::releaseSlot(const std::string& userId) {
+    uint32_t slot;
+    if (!userSlots.find(userId, slot)) return;
+    
+    scoreIndex.remove(slot);
+    if (slot < decayedStates.size()) {
+        decayedStates[slot] = DecayedConsistencyState();
+    }
+}
+
+// Helper: Store metrics in the cache and keep the score index in step
+void ConsistencyScorer::cacheMetrics(const std::string& userId, const ConsistencyMetrics& metrics) {
+    userConsistencyCache[userId] = metrics;
+    scoreIndex.set(acquireSlot(userId), metrics.consistencyScore);
+}
+
+// Helper: Metrics view of a decayed state
+ConsistencyMetrics ConsistencyScorer::decayedMetrics(const std::string& userId,
+                                                     const DecayedConsistencyState& state) const {
+    ConsistencyMetrics metrics(userId);
+    if (state.weight <= 0.0f) {
+        metrics.consistencyScore = newUserDefaultConsistency;
+        return metrics;
     }
     
-    return sumSquaredDiff / (values.size() - 1);
+    metrics.proposalCount = static_cast<int>(std::lround(state.weight));
+    metrics.meanSimilarity = state.mean;
+    metrics.variance = state.getVariance();
+    metrics.stdDevSimilarity = std::sqrt(metrics.variance);
+    metrics.consistencyScore = state.getConsistencyScore();
+    return metrics;
+}
+
+// Helper: Metrics for an indexed slot in the active mode
+ConsistencyMetrics ConsistencyScorer::metricsForSlot(uint32_t slot) const {
+    std::string userId = userSlots.lookup(slot);
+    if (useDecayedScoring) {
+        return decayedMetrics(userId, decayedStates[slot]);
+    }
+    return userConsistencyCache.at(userId);
+}
+
+// Helper: Resolve slots to user IDs
+std::vector<std::string> ConsistencyScorer::slotsToUsers(const std::vector<uint32_t>& slots) const {
+    std::vector<std::string> users;
+    users.reserve(slots.size());
+    for (uint32_t slot : slots) {
+        users.push_back(userSlots.lookup(slot));
+    }
+    return users;
+}
+
+// Helper: Re-index all users from the active mode's state
+void ConsistencyScorer::rebuildScoreIndex() {
+    scoreIndex.clear();
+    if (useDecayedScoring) {
+        for (uint32_t slot = 0; slot < decayedStates.size(); slot++) {
+            if (decayedStates[slot].weight > 0.0f) {
+                scoreIndex.set(slot, decayedStates[slot].getConsistencyScore());
+            }
+        }
+    } else {
+        for (const auto& pair : userConsistencyCache) {
+            scoreIndex.set(acquireSlot(pair.first), pair.second.consistencyScore);
+        }
+    }
+}
+
+// Helper: Parse "YYYY-MM-DD[ HH:MM:SS]" as UTC seconds since epoch
+bool ConsistencyScorer::parseTimestampSeconds(const std::string& timestamp, double& seconds) {
+    int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+    char separator = ' ';
+    int fields = std::sscanf(timestamp.c_str(), "%4d-%2d-%2d%c%2d:%2d:%2d",
+                             &year, &month, &day, &separator, &hour, &minute, &second);
+    if (fields != 3 && fields != 7) return false;
+    if (fields == 7 && separator != ' ' && separator != 'T') return false;
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+    
+    // Days from civil date (proleptic Gregorian)
+    year -= month <= 2;
+    long era = (year >= 0 ? year : year - 399) / 400;
+    long yearOfEra = year - era * 400;
+    long dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    long dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    long days = era * 146097 + dayOfEra - 719468;
+    
+    seconds = days * 86400.0 + hour * 3600.0 + minute * 60.0 + second;
+    return true;
 }
 
 // Record a proposal's similarity score for a user
@@ -51,16 +424,25 @@ void ConsistencyScorer::recordProposalSimilarity(const std::string& userId,
                                                  double similarityScore,
                                                  const std::string& timestamp,
                                                  const std::string& topicId) {
-    ProposalSimilarityRecord record(proposalId, similarityScore, timestamp, topicId);
+    if (useDecayedScoring) {
+        // Only the decayed moments are kept; undated records do not age the history
+        uint32_t slot = acquireSlot(userId);
+        DecayedConsistencyState& state = decayedStates[slot];
+        if (timestamp != lastTimestampText) {
+            lastTimestampText = timestamp;
+            lastTimestampValid = parseTimestampSeconds(timestamp, lastTimestampSeconds);
+        }
+        double seconds = lastTimestampValid ? lastTimestampSeconds : state.lastUpdate;
+        state.add(similarityScore, seconds, decayHalfLifeSeconds);
+        scoreIndex.set(slot, state.getConsistencyScore());
+        return;
+    }
     
-    // Add to user's history
-    userProposalHistory[userId].push_back(record);
+    ProposalSimilarityRecord record(proposalId, similarityScore, timestamp, topicId);
     
-    // Maintain rolling window if enabled
-    if (useRollingWindow && userProposalHistory[userId].size() > static_cast<size_t>(rollingWindowSize)) {
-        // Remove oldest entry
-        userProposalHistory[userId].erase(userProposalHistory[userId].begin());
-    }
+    // Add to user's history, evicting the oldest entry if the rolling window is full
+    size_t capacity = useRollingWindow ? static_cast<size_t>(std::max(1, rollingWindowSize)) : 0;
+    userProposalHistory[userId].add(record, capacity);
     
     // Update consistency metrics for this user
     updateUserConsistency(userId);
@@ -68,32 +450,36 @@ void ConsistencyScorer::recordProposalSimilarity(const std::string& userId,
 
 // Calculate consistency metrics for a user
 ConsistencyMetrics ConsistencyScorer::calculateConsistencyMetrics(const std::string& userId) {
+    if (useDecayedScoring) {
+        const DecayedConsistencyState* state = findDecayedState(userId);
+        if (!state) {
+            ConsistencyMetrics metrics(userId);
+            metrics.consistencyScore = newUserDefaultConsistency;
+            return metrics;
+        }
+        return decayedMetrics(userId, *state);
+    }
+    
     ConsistencyMetrics metrics(userId);
     
     // Check if user exists in history
-    if (userProposalHistory.find(userId) == userProposalHistory.end() ||
-        userProposalHistory[userId].empty()) {
+    auto it = userProposalHistory.find(userId);
+    if (it == userProposalHistory.end() || it->second.empty()) {
         // New user or no history - return default
         metrics.consistencyScore = newUserDefaultConsistency;
         return metrics;
     }
     
-    // Extract similarity scores from history
-    std::vector<double> similarities;
-    for (const auto& record : userProposalHistory[userId]) {
-        similarities.push_back(record.similarityScore);
-    }
+    // Running moments of the window
+    const SimilarityWindow& window = it->second;
+    metrics.proposalCount = window.size();
     
-    metrics.proposalCount = similarities.size();
+    // Mean (μ_i)
+    metrics.meanSimilarity = window.getMean();
     
-    // Calculate mean (μ_i)
-    metrics.meanSimilarity = calculateMean(similarities);
-    
-    // Calculate standard deviation (σ_i)
-    metrics.stdDevSimilarity = calculateStdDev(similarities, metrics.meanSimilarity);
-    
-    // Calculate variance (σ_i²)
-    metrics.variance = calculateVariance(similarities, metrics.meanSimilarity);
+    // Variance (σ_i²) and standard deviation (σ_i)
+    metrics.variance = window.getVariance();
+    metrics.stdDevSimilarity = std::sqrt(metrics.variance);
     
     // Calculate consistency score: 1 / (1 + σ_i)
     // This formula ensures:
@@ -107,6 +493,15 @@ ConsistencyMetrics ConsistencyScorer::calculateConsistencyMetrics(const std::str
 
 // Get cached consistency score for a user
 double ConsistencyScorer::getUserConsistencyScore(const std::string& userId) {
+    // Decayed state is always current; unknown users are not added
+    if (useDecayedScoring) {
+        const DecayedConsistencyState* state = findDecayedState(userId);
+        if (!state || state->weight <= 0.0f) {
+            return newUserDefaultConsistency;
+        }
+        return state->getConsistencyScore();
+    }
+    
     // Check cache first
     if (userConsistencyCache.find(userId) != userConsistencyCache.end()) {
         return userConsistencyCache[userId].consistencyScore;
@@ -114,13 +509,17 @@ double ConsistencyScorer::getUserConsistencyScore(const std::string& userId) {
     
     // Calculate and cache if not found
     ConsistencyMetrics metrics = calculateConsistencyMetrics(userId);
-    userConsistencyCache[userId] = metrics;
+    cacheMetrics(userId, metrics);
     
     return metrics.consistencyScore;
 }
 
 // Get full consistency metrics for a user
 ConsistencyMetrics ConsistencyScorer::getUserConsistencyMetrics(const std::string& userId) {
+    if (useDecayedScoring) {
+        return calculateConsistencyMetrics(userId);
+    }
+    
     // Check cache first
     if (userConsistencyCache.find(userId) != userConsistencyCache.end()) {
         return userConsistencyCache[userId];
@@ -128,15 +527,18 @@ ConsistencyMetrics ConsistencyScorer::getUserConsistencyMetrics(const std::strin
     
     // Calculate and cache if not found
     ConsistencyMetrics metrics = calculateConsistencyMetrics(userId);
-    userConsistencyCache[userId] = metrics;
+    cacheMetrics(userId, metrics);
     
     return metrics;
 }
 
 // Update consistency metrics for a specific user
 void ConsistencyScorer::updateUserConsistency(const std::string& userId) {
+    // Decayed scores are maintained on every record
+    if (useDecayedScoring) return;
+    
     ConsistencyMetrics metrics = calculateConsistencyMetrics(userId);
-    userConsistencyCache[userId] = metrics;
+    cacheMetrics(userId, metrics);
 }
 
 // Update consistency metrics for all users
@@ -170,8 +572,84 @@ WeightedRankingScore ConsistencyScorer::calculateWeightedScore(const std::string
     return score;
 }
 
+// Calculate weighted ranking score with explicit weights
+WeightedRankingScore ConsistencyScorer::calculateWeightedScore(const std::string& proposalId,
+                                                              const std::string& userId,
+                                                              double relevanceScore,
+                                                              double trustScore,
+                                                              double recencyScore,
+                                                              const RankingWeights& weights) {
+    WeightedRankingScore score;
+    score.proposalId = proposalId;
+    score.userId = userId;
+    score.relevanceScore = relevanceScore;
+    score.trustScore = trustScore;
+    score.recencyScore = recencyScore;
+    score.consistencyScore = getUserConsistencyScore(userId);
+    score.calculateFinalScore(weights);
+    return score;
+}
+
+// Look up consistency scores for a batch of users
+void ConsistencyScorer::getConsistencyScores(const std::vector<std::string>& userIds, double* out) {
+    for (size_t i = 0; i < userIds.size(); i++) {
+        out[i] = getUserConsistencyScore(userIds[i]);
+    }
+}
+
+// Batch weighted scoring over structure-of-arrays inputs
+void ConsistencyScorer::scoreBatch(const double* relevance,
+                                   const double* consistency,
+                                   const double* trust,
+                                   const double* recency,
+                                   size_t count,
+                                   const RankingWeights& weights,
+                                   double* out) {
+    size_t done = 0;
+#ifdef CONSISTENCY_SCORER_X86_KERNELS
+    static const bool hasAVX512 = __builtin_cpu_supports("avx512f");
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX512) {
+        done = scoreBatchAVX512(relevance, consistency, trust, recency, count, weights, out);
+    } else if (hasAVX2) {
+        done = scoreBatchAVX2(relevance, consistency, trust, recency, count, weights, out);
+    }
+#endif
+    // Remainder (or whole batch without x86 SIMD; the loop auto-vectorizes)
+    scoreBatchScalar(relevance, consistency, trust, recency, done, count, weights, out);
+}
+
+// Partial top-k selection over batch scores
+std::vector<size_t> ConsistencyScorer::selectTopK(const double* scores, size_t count, size_t k) {
+    auto better = [scores](size_t a, size_t b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    };
+    
+    // Bounded heap whose front is the worst of the current top k
+    std::vector<size_t> heap;
+    heap.reserve(std::min(k, count));
+    for (size_t i = 0; i < count && k > 0; i++) {
+        if (heap.size() < k) {
+            heap.push_back(i);
+            std::push_heap(heap.begin(), heap.end(), better);
+        } else if (better(i, heap.front())) {
+            std::pop_heap(heap.begin(), heap.end(), better);
+            heap.back() = i;
+            std::push_heap(heap.begin(), heap.end(), better);
+        }
+    }
+    
+    std::sort_heap(heap.begin(), heap.end(), better);
+    return heap;
+}
+
 // Get proposal count for a user
 int ConsistencyScorer::getUserProposalCount(const std::string& userId) const {
+    if (useDecayedScoring) {
+        const DecayedConsistencyState* state = findDecayedState(userId);
+        return state ? static_cast<int>(std::lround(state->weight)) : 0;
+    }
+    
     auto it = userProposalHistory.find(userId);
     if (it != userProposalHistory.end()) {
         return it->second.size();
@@ -183,43 +661,38 @@ int ConsistencyScorer::getUserProposalCount(const std::string& userId) const {
 void ConsistencyScorer::clearUserHistory(const std::string& userId) {
     userProposalHistory.erase(userId);
     userConsistencyCache.erase(userId);
+    releaseSlot(userId);
 }
 
 // Clear all history
 void ConsistencyScorer::clearAllHistory() {
     userProposalHistory.clear();
     userConsistencyCache.clear();
+    userSlots.clear();
+    decayedStates.clear();
+    scoreIndex.clear();
 }
 
 // Get all users with consistency scores
 std::vector<std::string> ConsistencyScorer::getAllTrackedUsers() const {
     std::vector<std::string> users;
-    for (const auto& pair : userConsistencyCache) {
-        users.push_back(pair.first);
+    users.reserve(scoreIndex.size());
+    for (uint32_t slot = 0; slot < userSlots.size(); slot++) {
+        if (scoreIndex.contains(slot)) {
+            users.push_back(userSlots.lookup(slot));
+        }
     }
     return users;
 }
 
 // Get users with high consistency
 std::vector<std::string> ConsistencyScorer::getHighConsistencyUsers(double threshold) const {
-    std::vector<std::string> users;
-    for (const auto& pair : userConsistencyCache) {
-        if (pair.second.consistencyScore > threshold) {
-            users.push_back(pair.first);
-        }
-    }
-    return users;
+    return slotsToUsers(scoreIndex.above(threshold));
 }
 
 // Get users with low consistency
 std::vector<std::string> ConsistencyScorer::getLowConsistencyUsers(double threshold) const {
-    std::vector<std::string> users;
-    for (const auto& pair : userConsistencyCache) {
-        if (pair.second.consistencyScore < threshold) {
-            users.push_back(pair.first);
-        }
-    }
-    return users;
+    return slotsToUsers(scoreIndex.below(threshold));
 }
 
 // Get statistics about consistency scores
@@ -227,9 +700,9 @@ std::string ConsistencyScorer::getConsistencyStatistics() const {
     std::stringstream ss;
     
     ss << "\n=== Consistency Scoring Statistics ===\n\n";
-    ss << "Total users tracked: " << userConsistencyCache.size() << "\n\n";
+    ss << "Total users tracked: " << scoreIndex.size() << "\n\n";
     
-    if (userConsistencyCache.empty()) {
+    if (scoreIndex.size() == 0) {
         ss << "No users tracked yet.\n";
         return ss.str();
     }
@@ -239,8 +712,9 @@ std::string ConsistencyScorer::getConsistencyStatistics() const {
     std::vector<double> allMeans;
     std::vector<double> allStdDevs;
     
-    for (const auto& pair : userConsistencyCache) {
-        const ConsistencyMetrics& metrics = pair.second;
+    for (uint32_t slot = 0; slot < userSlots.size(); slot++) {
+        if (!scoreIndex.contains(slot)) continue;
+        ConsistencyMetrics metrics = metricsForSlot(slot);
         allConsistencyScores.push_back(metrics.consistencyScore);
         allMeans.push_back(metrics.meanSimilarity);
         allStdDevs.push_back(metrics.stdDevSimilarity);
@@ -256,10 +730,10 @@ std::string ConsistencyScorer::getConsistencyStatistics() const {
     ss << "Average Std Deviation: " << avgStdDev << "\n\n";
     
     // Count users by consistency level
-    int highConsistency = getHighConsistencyUsers(0.7).size();
+    int highConsistency = scoreIndex.above(0.7).size();
     int mediumConsistency = 0;
-    int lowConsistency = getLowConsistencyUsers(0.3).size();
-    mediumConsistency = userConsistencyCache.size() - highConsistency - lowConsistency;
+    int lowConsistency = scoreIndex.below(0.3).size();
+    mediumConsistency = scoreIndex.size() - highConsistency - lowConsistency;
     
     ss << "Users by consistency level:\n";
     ss << "  High (>0.7):   " << highConsistency << "\n";
@@ -267,28 +741,14 @@ std::string ConsistencyScorer::getConsistencyStatistics() const {
     ss << "  Low (<0.3):    " << lowConsistency << "\n\n";
     
     // Show top 5 most consistent users
-    std::vector<std::pair<std::string, double>> userScores;
-    for (const auto& pair : userConsistencyCache) {
-        userScores.push_back({pair.first, pair.second.consistencyScore});
-    }
-    
-    std::sort(userScores.begin(), userScores.end(),
-              [](const auto& a, const auto& b) { return a.second > b.second; });
-    
     ss << "Top 5 most consistent users:\n";
-    int count = 0;
-    for (const auto& pair : userScores) {
-        if (count >= 5) break;
-        auto it = userConsistencyCache.find(pair.first);
-        if (it != userConsistencyCache.end()) {
-            const ConsistencyMetrics& metrics = it->second;
-            ss << "  " << pair.first 
-               << " - Consistency: " << std::fixed << std::setprecision(3) << metrics.consistencyScore
-               << " (μ=" << metrics.meanSimilarity 
-               << ", σ=" << metrics.stdDevSimilarity
-               << ", n=" << metrics.proposalCount << ")\n";
-        }
-        count++;
+    for (uint32_t slot : scoreIndex.top(5)) {
+        ConsistencyMetrics metrics = metricsForSlot(slot);
+        ss << "  " << userSlots.lookup(slot)
+           << " - Consistency: " << std::fixed << std::setprecision(3) << metrics.consistencyScore
+           << " (μ=" << metrics.meanSimilarity 
+           << ", σ=" << metrics.stdDevSimilarity
+           << ", n=" << metrics.proposalCount << ")\n";
     }
     
     return ss.str();
@@ -328,9 +788,25 @@ std::string ConsistencyScorer::getWeightConfiguration() {
 // Set rolling window size
 void ConsistencyScorer::setRollingWindowSize(int windowSize) {
     rollingWindowSize = windowSize;
+    
+    // Trim existing windows so later evictions keep the new size
+    if (useRollingWindow) {
+        for (auto& pair : userProposalHistory) {
+            pair.second.shrinkTo(static_cast<size_t>(std::max(1, windowSize)));
+        }
+    }
 }
 
 // Set whether to use rolling window
 void ConsistencyScorer::setUseRollingWindow(bool useWindow) {
     useRollingWindow = useWindow;
 }
+
+// Switch between record-based and decayed scoring
+void ConsistencyScorer::setDecayedScoring(bool enable, double halfLifeSeconds) {
+    decayHalfLifeSeconds = halfLifeSeconds;
+    if (enable != useDecayedScoring) {
+        useDecayedScoring = enable;
+        rebuildScoreIndex();
+    }
+}
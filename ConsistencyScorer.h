@@ -8,6 +8,8 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <cstdint>
+#include "StringInterner.h"
 
 // Forward declarations
 class Proposal;
@@ -27,6 +29,140 @@ struct ProposalSimilarityRecord {
         : proposalId(pid), similarityScore(sim), timestamp(ts), topicId(tid) {}
 };
 
+/**
+ * Rolling window of a user's similarity records with running moments
+ * 
+ * Records live in a ring buffer; the mean and M2 (sum of squared deviations)
+ * are maintained with Welford's add/remove recurrences, so recording a
+ * proposal is O(1). Moments are recomputed exactly from the buffer once per
+ * window length of evictions to keep rounding drift bounded.
+ */
+class SimilarityWindow {
+private:
+    std::vector<ProposalSimilarityRecord> records;  // ring storage
+    size_t head;                // index of the oldest record
+    size_t count;
+    double mean;
+    double m2;
+    size_t evictionsSinceResync;
+    
+    void resync();
+    
+public:
+    SimilarityWindow() : head(0), count(0), mean(0.0), m2(0.0), evictionsSinceResync(0) {}
+    
+    /**
+     * Append a record, evicting the oldest when the window is full
+     * @param capacity Window size (0 = unbounded)
+     */
+    void add(const ProposalSimilarityRecord& record, size_t capacity);
+    
+    /**
+     * Drop the oldest records until at most capacity remain
+     */
+    void shrinkTo(size_t capacity);
+    
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    double getMean() const { return mean; }
+    
+    /**
+     * Sample variance (n - 1 denominator); 0 for fewer than two records
+     */
+    double getVariance() const { return (count > 1) ? std::max(0.0, m2 / (count - 1)) : 0.0; }
+    
+    /**
+     * Record i, oldest first
+     */
+    const ProposalSimilarityRecord& at(size_t i) const {
+        return records[(head + i) % records.size()];
+    }
+};
+
+/**
+ * Exponentially-decayed similarity moments for one user
+ * 
+ * Past observations lose half their weight every half-life; the weighted
+ * mean and M2 use West's incremental update, and the sum of squared weights
+ * gives an unbiased (reliability-weighted) variance. With an infinite
+ * half-life this reduces to the all-history sample variance.
+ */
+struct DecayedConsistencyState {
+    double mean;
+    double m2;
+    float weight;               // sum of decayed weights (effective count)
+    float weightSquared;        // sum of squared decayed weights
+    uint32_t lastUpdate;        // whole seconds since epoch of the latest record
+    
+    DecayedConsistencyState()
+        : mean(0.0), m2(0.0), weight(0.0f), weightSquared(0.0f), lastUpdate(0) {}
+    
+    /**
+     * Decay existing weight to the given time and add one observation
+     * @param halfLifeSeconds Half-life of an observation's weight (<= 0: no decay)
+     */
+    void add(double similarity, double timestampSeconds, double halfLifeSeconds);
+    
+    double getVariance() const;
+    
+    /**
+     * 1 / (1 + σ), matching ConsistencyMetrics::consistencyScore
+     */
+    double getConsistencyScore() const { return 1.0 / (1.0 + std::sqrt(getVariance())); }
+};
+
+/**
+ * Consistency scores bucketed by value for threshold queries
+ * 
+ * Users are identified by dense slot numbers. Each score lives in one of
+ * kBuckets equal-width buckets over [0, 1] with O(1) swap-remove updates,
+ * so above/below queries only touch the buckets on the requested side and
+ * filter the single boundary bucket.
+ */
+class ConsistencyScoreIndex {
+private:
+    struct Entry {
+        double score;
+        uint32_t position;      // index within its bucket
+        int32_t bucket;         // -1 when the slot is not indexed
+    };
+    
+    std::vector<std::vector<uint32_t>> buckets;
+    std::vector<Entry> entries;     // by slot
+    size_t indexedCount;
+    
+    static size_t bucketFor(double score);
+    
+public:
+    static const size_t kBuckets = 1024;
+    
+    ConsistencyScoreIndex() : buckets(kBuckets), indexedCount(0) {}
+    
+    void set(uint32_t slot, double score);
+    void remove(uint32_t slot);
+    bool contains(uint32_t slot) const {
+        return slot < entries.size() && entries[slot].bucket >= 0;
+    }
+    size_t size() const { return indexedCount; }
+    
+    /**
+     * Slots with score > threshold, highest buckets first
+     */
+    std::vector<uint32_t> above(double threshold) const;
+    
+    /**
+     * Slots with score < threshold, lowest buckets first
+     */
+    std::vector<uint32_t> below(double threshold) const;
+    
+    /**
+     * The k highest-scoring slots, best first (ties by lower slot)
+     */
+    std::vector<uint32_t> top(size_t k) const;
+    
+    void clear();
+};
+
 /**
  * Structure to hold consistency metrics for a user
  */
@@ -47,6 +183,26 @@ struct ConsistencyMetrics {
           consistencyScore(0.5), proposalCount(0), variance(0.0) {}
 };
 
+/**
+ * Ranking weight configuration
+ * Passed explicitly to scoring calls so rankers with different weights can run
+ * concurrently without touching the process-wide defaults.
+ */
+struct RankingWeights {
+    double alpha;   // relevance weight
+    double beta;    // consistency weight
+    double gamma;   // trust weight
+    double delta;   // recency weight
+    
+    RankingWeights(double a = 0.55, double b = 0.25, double g = 0.15, double d = 0.05)
+        : alpha(a), beta(b), gamma(g), delta(d) {}
+    
+    /**
+     * Snapshot of the weights set through ConsistencyScorer::configureWeights
+     */
+    static RankingWeights fromDefaults();
+};
+
 /**
  * Structure for weighted ranking score
  */
@@ -78,6 +234,14 @@ struct WeightedRankingScore {
                            delta * recencyScore;
     }
     
+    // Same formula with explicit weights
+    void calculateFinalScore(const RankingWeights& weights) {
+        finalWeightedScore = weights.alpha * relevanceScore +
+                           weights.beta * consistencyScore +
+                           weights.gamma * trustScore +
+                           weights.delta * recencyScore;
+    }
+    
     bool operator<(const WeightedRankingScore& other) const {
         return finalWeightedScore < other.finalWeightedScore;
     }
@@ -95,21 +259,46 @@ struct WeightedRankingScore {
  */
 class ConsistencyScorer {
 private:
-    // User ID -> list of their proposal similarity records
-    std::unordered_map<std::string, std::vector<ProposalSimilarityRecord>> userProposalHistory;
+    // User ID -> rolling window of their proposal similarity records
+    std::unordered_map<std::string, SimilarityWindow> userProposalHistory;
     
     // User ID -> current consistency metrics
     std::unordered_map<std::string, ConsistencyMetrics> userConsistencyCache;
     
+    // Dense user slots shared by the decayed state and the score index
+    StringInterner userSlots;
+    std::vector<DecayedConsistencyState> decayedStates;     // by slot
+    ConsistencyScoreIndex scoreIndex;
+    
     // Configuration
     int rollingWindowSize;              // Maximum proposals to keep in rolling window
     double newUserDefaultConsistency;   // Default consistency for new users (0.5)
     bool useRollingWindow;              // Whether to use rolling window or all history
+    bool useDecayedScoring;             // Exponentially-decayed moments instead of records
+    double decayHalfLifeSeconds;        // Half-life of a record's weight in decayed mode
+    
+    // Last parsed timestamp; records usually arrive in runs with the same stamp
+    std::string lastTimestampText;
+    double lastTimestampSeconds;
+    bool lastTimestampValid;
     
     // Helper methods
     double calculateMean(const std::vector<double>& values) const;
-    double calculateStdDev(const std::vector<double>& values, double mean) const;
-    double calculateVariance(const std::vector<double>& values, double mean) const;
+    uint32_t acquireSlot(const std::string& userId);
+    void releaseSlot(const std::string& userId);
+    void cacheMetrics(const std::string& userId, const ConsistencyMetrics& metrics);
+    ConsistencyMetrics decayedMetrics(const std::string& userId,
+                                      const DecayedConsistencyState& state) const;
+    const DecayedConsistencyState* findDecayedState(const std::string& userId) const;
+    ConsistencyMetrics metricsForSlot(uint32_t slot) const;
+    std::vector<std::string> slotsToUsers(const std::vector<uint32_t>& slots) const;
+    void rebuildScoreIndex();
+    
+    /**
+     * Parse "YYYY-MM-DD[ HH:MM:SS]" (or 'T' separator) as UTC seconds
+     * @return false if the timestamp is not in that form
+     */
+    static bool parseTimestampSeconds(const std::string& timestamp, double& seconds);
     
 public:
     /**
@@ -185,10 +374,51 @@ public:
                                                double trustScore = 0.5,
                                                double recencyScore = 1.0);
     
+    /**
+     * Calculate weighted ranking score with explicit weights
+     * @param weights Weight configuration used instead of the global defaults
+     */
+    WeightedRankingScore calculateWeightedScore(const std::string& proposalId,
+                                               const std::string& userId,
+                                               double relevanceScore,
+                                               double trustScore,
+                                               double recencyScore,
+                                               const RankingWeights& weights);
+    
+    /**
+     * Look up consistency scores for a batch of users
+     * @param userIds Users to look up
+     * @param out Receives one score per user (size >= userIds.size())
+     */
+    void getConsistencyScores(const std::vector<std::string>& userIds, double* out);
+    
+    /**
+     * Batch weighted scoring over structure-of-arrays inputs
+     * out[i] = α*relevance[i] + β*consistency[i] + γ*trust[i] + δ*recency[i]
+     * Uses AVX-512 or AVX2 when the CPU supports them; results match
+     * calculateWeightedScore exactly (same operation order, no FMA).
+     * @param count Number of proposals
+     * @param weights Weight configuration
+     * @param out Receives count final scores
+     */
+    static void scoreBatch(const double* relevance,
+                           const double* consistency,
+                           const double* trust,
+                           const double* recency,
+                           size_t count,
+                           const RankingWeights& weights,
+                           double* out);
+    
+    /**
+     * Partial top-k selection over batch scores (bounded heap, O(n log k))
+     * @return Indices of the k highest scores, best first (ties by lower index)
+     */
+    static std::vector<size_t> selectTopK(const double* scores, size_t count, size_t k);
+    
     /**
      * Get proposal count for a user
      * @param userId User identifier
-     * @return Number of proposals in history
+     * @return Number of proposals in history (rounded effective count in decayed mode)
      */
     int getUserProposalCount(const std::string& userId) const;
     
@@ -210,14 +440,14 @@ public:
     std::vector<std::string> getAllTrackedUsers() const;
     
     /**
-     * Get users with high consistency (> threshold)
+     * Get users with high consistency (> threshold), served from the score index
      * @param threshold Minimum consistency score (default: 0.7)
      * @return Vector of user IDs
      */
     std::vector<std::string> getHighConsistencyUsers(double threshold = 0.7) const;
     
     /**
-     * Get users with low consistency (< threshold)
+     * Get users with low consistency (< threshold), served from the score index
      * Potentially indicates erratic behavior
      * @param threshold Maximum consistency score (default: 0.3)
      * @return Vector of user IDs
@@ -259,6 +489,18 @@ public:
      * @param useWindow True to use rolling window, false for all history
      */
     void setUseRollingWindow(bool useWindow);
+    
+    /**
+     * Switch between record-based and exponentially-decayed scoring
+     * Decayed mode keeps only DecayedConsistencyState per user (no records),
+     * and scores reflect the decay as of each user's latest record.
+     * Switching modes does not migrate history recorded in the other mode.
+     * @param enable True for decayed scoring
+     * @param halfLifeSeconds Half-life of a record's weight, <= 0 for no decay (default: 30 days)
+     */
+    void setDecayedScoring(bool enable, double halfLifeSeconds = 30.0 * 86400.0);
+    
+    bool isDecayedScoring() const { return useDecayedScoring; }
 };
 
 #endif // CONSISTENCY_SCORER_H
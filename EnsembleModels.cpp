@@ -1,432 +1,1406 @@
 #include "EnsembleModels.h"
 #include "VotingSystem.h"
+#include "ParallelFor.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
 #include <random>
 #include <set>
+#include <limits>
+#include <functional>
+#include <fstream>
+#include <cstring>
+#include <cctype>
+#include <type_traits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ENSEMBLE_MODELS_HAS_MMAP 1
+#endif
+
+// ==================== Model Files ====================
+
+static_assert(sizeof(ModelFileHeader) == 64, "model file header is 64 bytes");
+static_assert(std::is_trivially_copyable<DecisionTreeNode>::value, "tree nodes are stored raw");
+
+static const char kModelMagic[8] = {'C', 'D', 'M', 'O', 'D', 'E', 'L', '\0'};
+static const size_t kSectionAlignment = 64;
+
+void ModelFileWriter::addStrings(const char* code, const std::vector<std::string>& strings) {
+    std::vector<uint32_t> offsets(1, 0);
+    std::string text;
+    for (const auto& str : strings) {
+        text += str;
+        offsets.push_back(static_cast<uint32_t>(text.size()));
+    }
+    
+    uint32_t count = static_cast<uint32_t>(strings.size());
+    std::string bytes(reinterpret_cast<const char*>(&count), sizeof(count));
+    bytes.append(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint32_t));
+    bytes += text;
+    sections.push_back({makeTag(code), 1, std::move(bytes)});
+}
+
+bool ModelFileWriter::writeToFile(const std::string& path) const {
+    auto align = [](size_t offset) {
+        return (offset + kSectionAlignment - 1) / kSectionAlignment * kSectionAlignment;
+    };
+    
+    // Lay out the table, then each section on an aligned offset
+    std::vector<ModelSectionEntry> table;
+    size_t offset = align(sizeof(ModelFileHeader) + sections.size() * sizeof(ModelSectionEntry));
+    for (const auto& section : sections) {
+        table.push_back({section.tag, section.elementSize, offset, section.bytes.size()});
+        offset = align(offset + section.bytes.size());
+    }
+    
+    std::string image(offset, '\0');
+    std::memcpy(&image[sizeof(ModelFileHeader)], table.data(), table.size() * sizeof(ModelSectionEntry));
+    for (size_t i = 0; i < sections.size(); i++) {
+        std::memcpy(&image[table[i].offset], sections[i].bytes.data(), sections[i].bytes.size());
+    }
+    
+    ModelFileHeader header = {};
+    std::memcpy(header.magic, kModelMagic, sizeof(kModelMagic));
+    header.version = ModelFileHeader::kVersion;
+    header.byteOrderMark = ModelFileHeader::kByteOrderMark;
+    header.sectionCount = static_cast<uint32_t>(sections.size());
+    header.fileSize = image.size();
+    header.checksum = MappedModelFile::checksum(
+        reinterpret_cast<const uint8_t*>(image.data()) + sizeof(header), image.size() - sizeof(header));
+    std::memcpy(&image[0], &header, sizeof(header));
+    
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(image.data(), image.size());
+    return static_cast<bool>(out);
+}
+
+uint64_t MappedModelFile::checksum(const uint8_t* data, size_t size) {
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+    
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        hash = (hash ^ word) * prime;
+    }
+    for (; i < size; i++) {
+        hash = (hash ^ data[i]) * prime;
+    }
+    return hash;
+}
+
+MappedModelFile::~MappedModelFile() {
+#ifdef ENSEMBLE_MODELS_HAS_MMAP
+    if (isMapped) {
+        munmap(const_cast<uint8_t*>(base), length);
+    }
+#endif
+}
+
+std::shared_ptr<const MappedModelFile> MappedModelFile::open(const std::string& path,
+                                                             bool verifyChecksum,
+                                                             std::string& error) {
+    std::shared_ptr<MappedModelFile> file(new MappedModelFile());
+    
+#ifdef ENSEMBLE_MODELS_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open file";
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(ModelFileHeader))) {
+        ::close(fd);
+        error = "file too small";
+        return nullptr;
+    }
+    void* mapping = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        error = "mmap failed";
+        return nullptr;
+    }
+    file->base = static_cast<const uint8_t*>(mapping);
+    file->length = info.st_size;
+    file->isMapped = true;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        error = "cannot open file";
+        return nullptr;
+    }
+    file->buffer.resize(static_cast<size_t>(in.tellg()));
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(file->buffer.data()), file->buffer.size());
+    file->base = file->buffer.data();
+    file->length = file->buffer.size();
+#endif
+    
+    if (!file->validate(verifyChecksum, error)) {
+        return nullptr;
+    }
+    return file;
+}
+
+bool MappedModelFile::validate(bool verifyChecksum, std::string& error) {
+    if (length < sizeof(ModelFileHeader)) {
+        error = "file too small";
+        return false;
+    }
+    
+    ModelFileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    if (std::memcmp(header.magic, kModelMagic, sizeof(kModelMagic)) != 0) {
+        error = "not a model file";
+        return false;
+    }
+    if (header.byteOrderMark != ModelFileHeader::kByteOrderMark) {
+        error = "written with a different byte order";
+        return false;
+    }
+    if (header.version != ModelFileHeader::kVersion) {
+        error = "unsupported format version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.fileSize != length) {
+        error = "truncated file";
+        return false;
+    }
+    if (verifyChecksum && checksum(base + sizeof(header), length - sizeof(header)) != header.checksum) {
+        error = "checksum mismatch";
+        return false;
+    }
+    
+    size_t tableEnd = sizeof(header) + static_cast<size_t>(header.sectionCount) * sizeof(ModelSectionEntry);
+    if (header.sectionCount > length / sizeof(ModelSectionEntry) || tableEnd > length) {
+        error = "bad section table";
+        return false;
+    }
+    for (uint32_t i = 0; i < header.sectionCount; i++) {
+        ModelSectionEntry entry;
+        std::memcpy(&entry, base + sizeof(header) + i * sizeof(entry), sizeof(entry));
+        if (entry.offset < tableEnd || entry.offset % 8 != 0 || entry.offset > length ||
+            entry.size > length - entry.offset || entry.elementSize == 0 ||
+            entry.size % entry.elementSize != 0) {
+            error = "bad section table";
+            return false;
+        }
+        sections[entry.tag] = entry;
+    }
+    
+    return true;
+}
+
+bool MappedModelFile::strings(const char* code, std::vector<std::string>& out) const {
+    out.clear();
+    auto it = sections.find(ModelFileWriter::makeTag(code));
+    if (it == sections.end()) return false;
+    
+    const uint8_t* data = base + it->second.offset;
+    size_t size = it->second.size;
+    uint32_t count;
+    if (size < sizeof(count)) return false;
+    std::memcpy(&count, data, sizeof(count));
+    
+    size_t headerSize = sizeof(count) + (static_cast<size_t>(count) + 1) * sizeof(uint32_t);
+    if (count > size / sizeof(uint32_t) || headerSize > size) return false;
+    
+    const uint8_t* offsets = data + sizeof(count);
+    const char* text = reinterpret_cast<const char*>(data + headerSize);
+    size_t textSize = size - headerSize;
+    
+    out.reserve(count);
+    uint32_t begin, end;
+    std::memcpy(&begin, offsets, sizeof(begin));
+    for (uint32_t i = 0; i < count; i++) {
+        std::memcpy(&end, offsets + (i + 1) * sizeof(uint32_t), sizeof(end));
+        if (begin > end || end > textSize) {
+            out.clear();
+            return false;
+        }
+        out.emplace_back(text + begin, end - begin);
+        begin = end;
+    }
+    return true;
+}
+
+// ==================== Dataset ====================
+
+void Dataset::append(const FeatureVector& features) {
+    size_t row = labels.size();
+    instanceIds.push_back(features.instanceId);
+    
+    // Label
+    auto cls = classIndex.emplace(features.groundTruthLabel, static_cast<int>(classNames.size()));
+    if (cls.second) {
+        classNames.push_back(features.groundTruthLabel);
+    }
+    labels.push_back(cls.first->second);
+    
+    // Numeric features: new columns are zero-filled for earlier rows
+    for (auto& column : columns) {
+        column.push_back(0.0f);
+    }
+    for (const auto& pair : features.features) {
+        auto feature = featureIndex.emplace(pair.first, static_cast<int>(featureNames.size()));
+        if (feature.second) {
+            featureNames.push_back(pair.first);
+            columns.emplace_back(row + 1, 0.0f);
+        }
+        columns[feature.first->second][row] = static_cast<float>(pair.second);
+    }
+    
+    // Text tokens as term IDs
+    for (const std::string& token : features.textTokens) {
+        auto term = termIndex.emplace(token, static_cast<uint32_t>(terms.size()));
+        if (term.second) {
+            terms.push_back(token);
+        }
+        tokenIds.push_back(term.first->second);
+    }
+    tokenOffsets.push_back(tokenIds.size());
+}
+
+Dataset Dataset::fromFeatureVectors(const std::vector<FeatureVector>& features) {
+    Dataset data;
+    data.instanceIds.reserve(features.size());
+    data.labels.reserve(features.size());
+    data.tokenOffsets.reserve(features.size() + 1);
+    for (const auto& fv : features) {
+        data.append(fv);
+    }
+    return data;
+}
+
+FeatureVector Dataset::toFeatureVector(size_t row) const {
+    FeatureVector fv(instanceIds[row]);
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        fv.features[featureNames[f]] = columns[f][row];
+    }
+    for (size_t k = tokenOffsets[row]; k < tokenOffsets[row + 1]; k++) {
+        fv.textTokens.push_back(terms[tokenIds[k]]);
+    }
+    fv.groundTruthLabel = classNames[labels[row]];
+    return fv;
+}
+
+// ==================== Naive Bayes Kernels ====================
+
+// Adds the rows of a term-major matrix (stride doubles per row) into out.
+// Each class lane is summed in token order, so all kernels agree exactly.
+
+static void accumulateRowsScalar(const double* table, size_t stride,
+                                 const uint32_t* rows, size_t count, double* out) {
+    for (size_t i = 0; i < count; i++) {
+        const double* row = table + static_cast<size_t>(rows[i]) * stride;
+        for (size_t c = 0; c < stride; c++) {
+            out[c] += row[c];
+        }
+    }
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define ENSEMBLE_MODELS_X86_KERNELS 1
+
+__attribute__((target("avx2")))
+static void accumulateRowsAVX2(const double* table, size_t stride,
+                               const uint32_t* rows, size_t count, double* out) {
+    for (size_t c = 0; c < stride; c += 4) {
+        __m256d sum = _mm256_loadu_pd(out + c);
+        for (size_t i = 0; i < count; i++) {
+            sum = _mm256_add_pd(sum, _mm256_loadu_pd(table + static_cast<size_t>(rows[i]) * stride + c));
+        }
+        _mm256_storeu_pd(out + c, sum);
+    }
+}
+#endif
+
+static void accumulateRows(const double* table, size_t stride,
+                           const uint32_t* rows, size_t count, double* out) {
+#ifdef ENSEMBLE_MODELS_X86_KERNELS
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2 && stride % 4 == 0) {
+        accumulateRowsAVX2(table, stride, rows, count, out);
+        return;
+    }
+#endif
+    accumulateRowsScalar(table, stride, rows, count, out);
+}
+
+// ==================== Feature Hashing ====================
+
+static uint64_t mixHash(uint64_t hash) {
+    // 64-bit finalizer (MurmurHash3 fmix64) so low bits depend on every input byte
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+uint64_t FeatureHasher::hashToken(const std::string& token) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (char ch : token) {
+        hash = (hash ^ static_cast<uint8_t>(ch)) * 1099511628211ULL;
+    }
+    return mixHash(hash);
+}
+
+uint64_t FeatureHasher::combine(uint64_t first, uint64_t rest) {
+    return mixHash(first * 0x9e3779b97f4a7c15ULL + rest);
+}
+
+void FeatureHasher::hashSequence(const uint64_t* tokenHashes, size_t count,
+                                 std::vector<uint32_t>& buckets, std::vector<float>* signs) const {
+    for (size_t i = 0; i < count; i++) {
+        // Grams ending at token i, built right to left: t[i], t[i-1] t[i], ...
+        uint64_t hash = tokenHashes[i];
+        for (int n = 1; n <= ngramOrder && static_cast<size_t>(n) <= i + 1; n++) {
+            if (n > 1) {
+                hash = combine(tokenHashes[i + 1 - n], hash);
+            }
+            buckets.push_back(bucket(hash));
+            if (signs) {
+                signs->push_back(sign(hash));
+            }
+        }
+    }
+}
 
 // ==================== Naive Bayes Classifier ====================
 
 NaiveBayesClassifier::NaiveBayesClassifier(double alpha)
-    : smoothingAlpha(alpha), totalDocuments(0), isTrained(false) {
+    : countScale(1.0), classStride(0), likelihoodsStale(false),
+      totalDocuments(0), smoothingAlpha(alpha), isTrained(false),
+      mappedNumerators(nullptr), mappedDocumentWeight(0.0) {
 }
 
-void NaiveBayesClassifier::train(const std::vector<FeatureVector>& features) {
-    // Reset state
-    classPriors.clear();
-    featureLikelihoods.clear();
+void NaiveBayesClassifier::resetModel() {
+    classNames.clear();
+    classIds.clear();
     vocabulary.clear();
     classDocCounts.clear();
+    classTokenTotals.clear();
     featureCounts.clear();
-    totalDocuments = features.size();
+    countScale = 1.0;
+    totalDocuments = 0;
+    mappedModel.reset();
+    mappedNumerators = nullptr;
+    computeLogLikelihoods();
+}
+
+void NaiveBayesClassifier::setFeatureHashing(int bits, int ngramOrder) {
+    hasher = FeatureHasher(bits, ngramOrder);
+    resetModel();
+    isTrained = false;
+}
+
+void NaiveBayesClassifier::hashRowTerms(const Dataset& data, uint32_t row,
+                                        const std::vector<uint64_t>& termHashes,
+                                        std::vector<uint64_t>& tokenHashes,
+                                        std::vector<uint32_t>& termIds) const {
+    tokenHashes.clear();
+    for (size_t k = data.tokenOffsets[row]; k < data.tokenOffsets[row + 1]; k++) {
+        tokenHashes.push_back(termHashes[data.tokenIds[k]]);
+    }
+    termIds.clear();
+    hasher.hashSequence(tokenHashes.data(), tokenHashes.size(), termIds);
+}
+
+void NaiveBayesClassifier::detachMappedModel() {
+    if (!mappedModel) return;
+    
+    size_t numClasses = classNames.size();
+    size_t vocabSize = termCount();
+    logNumerators.assign(mappedNumerators, mappedNumerators + (vocabSize + 1) * classStride);
+    
+    // Invert the log tables to recover counts (countScale restarts at 1)
+    classDocCounts.assign(numClasses, 0.0);
+    classTokenTotals.assign(numClasses, 0.0);
+    featureCounts.assign(numClasses, std::vector<double>(vocabSize, 0.0));
+    for (size_t c = 0; c < numClasses; c++) {
+        classDocCounts[c] = std::exp(logPriors[c]) * mappedDocumentWeight;
+        classTokenTotals[c] = std::max(0.0, std::exp(logDenominators[c]) - smoothingAlpha * vocabSize);
+        for (size_t term = 0; term < vocabSize; term++) {
+            featureCounts[c][term] = std::max(0.0, std::exp(logNumerators[term * classStride + c]) -
+                                                   smoothingAlpha);
+        }
+    }
+    countScale = 1.0;
     
-    // Count documents per class and build vocabulary
-    for (const auto& fv : features) {
-        classDocCounts[fv.groundTruthLabel]++;
-        for (const auto& token : fv.textTokens) {
-            vocabulary.insert(token);
-            featureCounts[fv.groundTruthLabel][token]++;
+    mappedModel.reset();
+    mappedNumerators = nullptr;
+}
+
+void NaiveBayesClassifier::addDocument(const FeatureVector& features, bool updateLikelihoods) {
+    detachMappedModel();
+    double unit = 1.0 / countScale;
+    
+    auto inserted = classIds.emplace(features.groundTruthLabel, static_cast<int>(classNames.size()));
+    int classId = inserted.first->second;
+    if (inserted.second) {
+        // New class: counts start empty; matrix layout is rebuilt lazily
+        classNames.push_back(features.groundTruthLabel);
+        classDocCounts.push_back(0.0);
+        classTokenTotals.push_back(0.0);
+        featureCounts.emplace_back(termCount(), 0.0);
+        likelihoodsStale.store(true);
+        updateLikelihoods = false;
+    }
+    
+    classDocCounts[classId] += unit;
+    totalDocuments++;
+    
+    auto countTerm = [&](uint32_t termId) {
+        featureCounts[classId][termId] += unit;
+        classTokenTotals[classId] += unit;
+        if (updateLikelihoods) {
+            logNumerators[termId * classStride + classId] =
+                std::log(featureCounts[classId][termId] * countScale + smoothingAlpha);
+        }
+    };
+    
+    if (hasher.isEnabled()) {
+        // Buckets are preallocated; nothing grows
+        std::vector<uint32_t> termIds;
+        encodeTokens(features.textTokens, termIds);
+        for (uint32_t termId : termIds) {
+            countTerm(termId);
+        }
+    } else {
+        for (const std::string& token : features.textTokens) {
+            auto term = vocabulary.emplace(token, static_cast<uint32_t>(vocabulary.size()));
+            uint32_t termId = term.first->second;
+            if (term.second) {
+                for (auto& counts : featureCounts) {
+                    counts.push_back(0.0);
+                }
+                
+                // The unseen row (all log α) becomes this term's row; append a new one
+                if (updateLikelihoods) {
+                    logNumerators.resize(logNumerators.size() + classStride, 0.0);
+                    std::fill(logNumerators.end() - classStride,
+                              logNumerators.end() - classStride + classNames.size(),
+                              std::log(smoothingAlpha));
+                }
+            }
+            
+            countTerm(termId);
         }
     }
     
-    // Calculate class priors: P(class) = count(class) / total
-    for (const auto& pair : classDocCounts) {
-        classPriors[pair.first] = static_cast<double>(pair.second) / totalDocuments;
+    if (updateLikelihoods) {
+        updateClassTerms();
+    }
+}
+
+void NaiveBayesClassifier::train(const std::vector<FeatureVector>& features) {
+    train(Dataset::fromFeatureVectors(features));
+}
+
+void NaiveBayesClassifier::train(const Dataset& data) {
+    std::vector<uint32_t> rows(data.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    train(data, rows);
+}
+
+void NaiveBayesClassifier::train(const Dataset& data, const std::vector<uint32_t>& rows) {
+    // Reset state, count everything, then compute all likelihoods once
+    resetModel();
+    
+    // Dataset class/term IDs -> model IDs, assigned on first appearance in rows
+    const uint32_t unmapped = std::numeric_limits<uint32_t>::max();
+    std::vector<int> classMap(data.classNames.size(), -1);
+    std::vector<uint32_t> termMap(data.terms.size(), unmapped);
+    
+    // Hashing mode: hash each dataset term once, then n-grams per row
+    std::vector<uint64_t> termHashes, tokenHashes;
+    std::vector<uint32_t> rowTerms;
+    if (hasher.isEnabled()) {
+        termHashes.reserve(data.terms.size());
+        for (const auto& term : data.terms) {
+            termHashes.push_back(FeatureHasher::hashToken(term));
+        }
     }
     
-    // Calculate feature likelihoods with Laplace smoothing
-    // P(feature|class) = (count(feature, class) + α) / (count(class) + α * |V|)
-    int vocabSize = vocabulary.size();
-    for (const auto& classPair : classDocCounts) {
-        const std::string& className = classPair.first;
-        int classTotal = 0;
+    for (uint32_t row : rows) {
+        int& classId = classMap[data.labels[row]];
+        if (classId < 0) {
+            classId = static_cast<int>(classNames.size());
+            classNames.push_back(data.classNames[data.labels[row]]);
+            classIds[classNames.back()] = classId;
+            classDocCounts.push_back(0.0);
+            classTokenTotals.push_back(0.0);
+            featureCounts.emplace_back(termCount(), 0.0);
+        }
+        classDocCounts[classId] += 1.0;
+        totalDocuments++;
         
-        // Sum all feature counts for this class
-        for (const auto& featurePair : featureCounts[className]) {
-            classTotal += featurePair.second;
+        if (hasher.isEnabled()) {
+            hashRowTerms(data, row, termHashes, tokenHashes, rowTerms);
+            for (uint32_t termId : rowTerms) {
+                featureCounts[classId][termId] += 1.0;
+                classTokenTotals[classId] += 1.0;
+            }
+            continue;
         }
         
-        // Calculate likelihood for each feature
-        for (const std::string& feature : vocabulary) {
-            int featureCount = featureCounts[className][feature];
-            double likelihood = (featureCount + smoothingAlpha) / 
-                               (classTotal + smoothingAlpha * vocabSize);
-            featureLikelihoods[className][feature] = likelihood;
+        for (size_t k = data.tokenOffsets[row]; k < data.tokenOffsets[row + 1]; k++) {
+            uint32_t& termId = termMap[data.tokenIds[k]];
+            if (termId == unmapped) {
+                termId = static_cast<uint32_t>(vocabulary.size());
+                vocabulary.emplace(data.terms[data.tokenIds[k]], termId);
+                for (auto& counts : featureCounts) {
+                    counts.push_back(0.0);
+                }
+            }
+            featureCounts[classId][termId] += 1.0;
+            classTokenTotals[classId] += 1.0;
         }
     }
     
+    computeLogLikelihoods();
+    isTrained = true;
+}
+
+void NaiveBayesClassifier::partialFit(const std::vector<FeatureVector>& features) {
+    for (const auto& fv : features) {
+        addDocument(fv, !likelihoodsStale.load());
+    }
+    isTrained = true;
+}
+
+void NaiveBayesClassifier::partialFit(const FeatureVector& features) {
+    addDocument(features, !likelihoodsStale.load());
     isTrained = true;
 }
 
-double NaiveBayesClassifier::calculateLogProbability(
-    const std::vector<std::string>& tokens,
-    const std::string& className) const {
+void NaiveBayesClassifier::decayCounts(double factor) {
+    if (!(factor > 0.0 && factor < 1.0)) return;
+    
+    detachMappedModel();
+    countScale *= factor;
+    
+    // Fold the scale into the stored counts before new units grow too large
+    if (countScale < 1e-100) {
+        for (size_t c = 0; c < classNames.size(); c++) {
+            classDocCounts[c] *= countScale;
+            classTokenTotals[c] *= countScale;
+            for (double& count : featureCounts[c]) {
+                count *= countScale;
+            }
+        }
+        countScale = 1.0;
+    }
     
-    // Start with log prior
-    double logProb = std::log(classPriors.at(className));
+    likelihoodsStale.store(true);
+}
+
+void NaiveBayesClassifier::updateClassTerms() const {
+    size_t numClasses = classNames.size();
+    size_t vocabSize = termCount();
+    
+    // Class priors: log P(class) = log(count(class) / total)
+    double totalDocs = 0.0;
+    for (size_t c = 0; c < numClasses; c++) {
+        totalDocs += classDocCounts[c] * countScale;
+    }
     
-    // Add log likelihoods for each token
-    for (const std::string& token : tokens) {
-        if (featureLikelihoods.at(className).count(token)) {
-            logProb += std::log(featureLikelihoods.at(className).at(token));
-        } else {
-            // Unseen feature - use smoothing
-            int vocabSize = vocabulary.size();
-            int classTotal = 0;
-            for (const auto& pair : featureCounts.at(className)) {
-                classTotal += pair.second;
-            }
-            double smoothedProb = smoothingAlpha / (classTotal + smoothingAlpha * vocabSize);
-            logProb += std::log(smoothedProb);
+    // Denominators: log(count(class) + α * |V|)
+    for (size_t c = 0; c < numClasses; c++) {
+        logPriors[c] = std::log(classDocCounts[c] * countScale / totalDocs);
+        logDenominators[c] = std::log(classTokenTotals[c] * countScale + smoothingAlpha * vocabSize);
+    }
+}
+
+void NaiveBayesClassifier::computeLogLikelihoods() const {
+    size_t numClasses = classNames.size();
+    size_t vocabSize = termCount();
+    classStride = (numClasses + 3) / 4 * 4;
+    
+    logPriors.assign(classStride, 0.0);
+    logDenominators.assign(classStride, 0.0);
+    updateClassTerms();
+    
+    // Feature likelihoods with Laplace smoothing
+    // P(feature|class) = (count(feature, class) + α) / (count(class) + α * |V|)
+    logNumerators.assign((vocabSize + 1) * classStride, 0.0);
+    for (size_t c = 0; c < numClasses; c++) {
+        const std::vector<double>& counts = featureCounts[c];
+        for (size_t term = 0; term < vocabSize; term++) {
+            logNumerators[term * classStride + c] = std::log(counts[term] * countScale + smoothingAlpha);
         }
+        
+        // Unseen feature row
+        logNumerators[vocabSize * classStride + c] = std::log(smoothingAlpha);
     }
     
-    return logProb;
+    likelihoodsStale.store(false);
 }
 
-ClassificationResult NaiveBayesClassifier::predict(const FeatureVector& features) const {
-    if (!isTrained) {
-        return ClassificationResult("unknown", 0.0, "NaiveBayes");
+void NaiveBayesClassifier::refreshLikelihoods() const {
+    if (!likelihoodsStale.load(std::memory_order_acquire)) return;
+    
+    // Training and prediction are not concurrent; the lock only serializes readers
+    std::lock_guard<std::mutex> lock(likelihoodMutex);
+    if (likelihoodsStale.load()) {
+        computeLogLikelihoods();
+    }
+}
+
+void NaiveBayesClassifier::encodeTokens(const std::vector<std::string>& tokens,
+                                        std::vector<uint32_t>& termIds) const {
+    termIds.clear();
+    if (hasher.isEnabled()) {
+        std::vector<uint64_t> tokenHashes;
+        tokenHashes.reserve(tokens.size());
+        for (const std::string& token : tokens) {
+            tokenHashes.push_back(FeatureHasher::hashToken(token));
+        }
+        hasher.hashSequence(tokenHashes.data(), tokenHashes.size(), termIds);
+        return;
     }
     
-    auto probabilities = predictProbabilities(features);
+    termIds.reserve(tokens.size());
+    for (const std::string& token : tokens) {
+        termIds.push_back(lookupTerm(token));
+    }
+}
+
+void NaiveBayesClassifier::accumulateLogProbabilities(const uint32_t* termIds, size_t count,
+                                                      double* out) const {
+    std::copy(logPriors.begin(), logPriors.end(), out);
+    accumulateRows(numeratorTable(), classStride, termIds, count, out);
+    for (size_t c = 0; c < classStride; c++) {
+        out[c] -= count * logDenominators[c];
+    }
+}
+
+ClassificationResult NaiveBayesClassifier::resultFromLogProbabilities(const double* logProbs) const {
+    // Convert log probabilities to probabilities using softmax
+    double maxLogProb = -std::numeric_limits<double>::infinity();
+    for (size_t c = 0; c < classNames.size(); c++) {
+        maxLogProb = std::max(maxLogProb, logProbs[c]);
+    }
+    
+    double sumExp = 0.0;
+    for (size_t c = 0; c < classNames.size(); c++) {
+        sumExp += std::exp(logProbs[c] - maxLogProb);
+    }
     
     // Find class with highest probability
-    std::string bestClass;
-    double maxProb = -std::numeric_limits<double>::infinity();
-    for (const auto& pair : probabilities) {
-        if (pair.second > maxProb) {
-            maxProb = pair.second;
-            bestClass = pair.first;
+    ClassificationResult result("", -std::numeric_limits<double>::infinity(), "NaiveBayes");
+    for (size_t c = 0; c < classNames.size(); c++) {
+        double probability = std::exp(logProbs[c] - maxLogProb) / sumExp;
+        result.classProbabilities[classNames[c]] = probability;
+        if (probability > result.confidence) {
+            result.confidence = probability;
+            result.label = classNames[c];
         }
     }
     
-    ClassificationResult result(bestClass, maxProb, "NaiveBayes");
-    result.classProbabilities = probabilities;
-    
     return result;
 }
 
+ClassificationResult NaiveBayesClassifier::predict(const FeatureVector& features) const {
+    if (!isTrained) {
+        return ClassificationResult("unknown", 0.0, "NaiveBayes");
+    }
+    
+    refreshLikelihoods();
+    
+    std::vector<uint32_t> termIds;
+    encodeTokens(features.textTokens, termIds);
+    
+    std::vector<double> logProbs(classStride);
+    accumulateLogProbabilities(termIds.data(), termIds.size(), logProbs.data());
+    return resultFromLogProbabilities(logProbs.data());
+}
+
 std::unordered_map<std::string, double> NaiveBayesClassifier::predictProbabilities(
     const FeatureVector& features) const {
     
-    std::unordered_map<std::string, double> probabilities;
+    if (!isTrained) {
+        return std::unordered_map<std::string, double>();
+    }
+    
+    return predict(features).classProbabilities;
+}
+
+void NaiveBayesClassifier::scoreBatch(const uint32_t* termIds, const size_t* docOffsets,
+                                      size_t numDocs, double* logProbs) const {
+    refreshLikelihoods();
+    
+    size_t numClasses = classNames.size();
+    std::vector<double> accumulator(classStride);
+    for (size_t d = 0; d < numDocs; d++) {
+        accumulateLogProbabilities(termIds + docOffsets[d], docOffsets[d + 1] - docOffsets[d],
+                                   accumulator.data());
+        std::copy(accumulator.begin(), accumulator.begin() + numClasses, logProbs + d * numClasses);
+    }
+}
+
+std::vector<ClassificationResult> NaiveBayesClassifier::predictBatch(
+    const std::vector<FeatureVector>& features) const {
     
     if (!isTrained) {
-        return probabilities;
+        return std::vector<ClassificationResult>(features.size(),
+                                                 ClassificationResult("unknown", 0.0, "NaiveBayes"));
     }
     
-    // Calculate log probabilities for each class
-    std::unordered_map<std::string, double> logProbs;
-    for (const auto& pair : classPriors) {
-        const std::string& className = pair.first;
-        logProbs[className] = calculateLogProbability(features.textTokens, className);
+    // Encode all documents into one CSR buffer
+    std::vector<uint32_t> termIds;
+    std::vector<uint32_t> docTermIds;
+    std::vector<size_t> docOffsets;
+    docOffsets.reserve(features.size() + 1);
+    docOffsets.push_back(0);
+    for (const auto& fv : features) {
+        encodeTokens(fv.textTokens, docTermIds);
+        termIds.insert(termIds.end(), docTermIds.begin(), docTermIds.end());
+        docOffsets.push_back(termIds.size());
     }
     
-    // Convert log probabilities to probabilities using softmax
-    double maxLogProb = -std::numeric_limits<double>::infinity();
-    for (const auto& pair : logProbs) {
-        maxLogProb = std::max(maxLogProb, pair.second);
+    size_t numClasses = classNames.size();
+    std::vector<double> logProbs(features.size() * numClasses);
+    scoreBatch(termIds.data(), docOffsets.data(), features.size(), logProbs.data());
+    
+    std::vector<ClassificationResult> results;
+    results.reserve(features.size());
+    for (size_t d = 0; d < features.size(); d++) {
+        results.push_back(resultFromLogProbabilities(logProbs.data() + d * numClasses));
     }
+    return results;
+}
+
+std::vector<ClassificationResult> NaiveBayesClassifier::predictBatch(
+    const Dataset& data, const std::vector<uint32_t>& rows) const {
     
-    double sumExp = 0.0;
-    for (const auto& pair : logProbs) {
-        sumExp += std::exp(pair.second - maxLogProb);
+    if (!isTrained) {
+        return std::vector<ClassificationResult>(rows.size(),
+                                                 ClassificationResult("unknown", 0.0, "NaiveBayes"));
+    }
+    
+    // Dataset term IDs -> model term IDs, resolved on first use
+    const uint32_t unmapped = std::numeric_limits<uint32_t>::max();
+    uint32_t unseen = getUnseenTermId();
+    std::vector<uint32_t> termMap(data.terms.size(), unmapped);
+    
+    std::vector<uint64_t> termHashes, tokenHashes;
+    std::vector<uint32_t> rowTerms;
+    if (hasher.isEnabled()) {
+        termHashes.reserve(data.terms.size());
+        for (const auto& term : data.terms) {
+            termHashes.push_back(FeatureHasher::hashToken(term));
+        }
     }
     
-    for (const auto& pair : logProbs) {
-        probabilities[pair.first] = std::exp(pair.second - maxLogProb) / sumExp;
+    std::vector<uint32_t> termIds;
+    std::vector<size_t> docOffsets;
+    docOffsets.reserve(rows.size() + 1);
+    docOffsets.push_back(0);
+    for (uint32_t row : rows) {
+        if (hasher.isEnabled()) {
+            hashRowTerms(data, row, termHashes, tokenHashes, rowTerms);
+            termIds.insert(termIds.end(), rowTerms.begin(), rowTerms.end());
+            docOffsets.push_back(termIds.size());
+            continue;
+        }
+        for (size_t k = data.tokenOffsets[row]; k < data.tokenOffsets[row + 1]; k++) {
+            uint32_t& termId = termMap[data.tokenIds[k]];
+            if (termId == unmapped) {
+                auto it = vocabulary.find(data.terms[data.tokenIds[k]]);
+                termId = (it != vocabulary.end()) ? it->second : unseen;
+            }
+            termIds.push_back(termId);
+        }
+        docOffsets.push_back(termIds.size());
     }
     
-    return probabilities;
+    size_t numClasses = classNames.size();
+    std::vector<double> logProbs(rows.size() * numClasses);
+    scoreBatch(termIds.data(), docOffsets.data(), rows.size(), logProbs.data());
+    
+    std::vector<ClassificationResult> results;
+    results.reserve(rows.size());
+    for (size_t d = 0; d < rows.size(); d++) {
+        results.push_back(resultFromLogProbabilities(logProbs.data() + d * numClasses));
+    }
+    return results;
+}
+
+void NaiveBayesClassifier::predictCompact(const uint32_t* termIds, const size_t* docOffsets,
+                                          size_t numDocs, int32_t* classIds,
+                                          double* confidences) const {
+    if (!isTrained || classNames.empty()) {
+        std::fill(classIds, classIds + numDocs, -1);
+        std::fill(confidences, confidences + numDocs, 0.0);
+        return;
+    }
+    
+    refreshLikelihoods();
+    
+    size_t numClasses = classNames.size();
+    std::vector<double> logProbs(classStride);
+    for (size_t d = 0; d < numDocs; d++) {
+        accumulateLogProbabilities(termIds + docOffsets[d], docOffsets[d + 1] - docOffsets[d],
+                                   logProbs.data());
+        
+        // The winner's softmax probability is 1 / Σ exp(logProb - max)
+        size_t best = std::max_element(logProbs.begin(), logProbs.begin() + numClasses) - logProbs.begin();
+        double sumExp = 0.0;
+        for (size_t c = 0; c < numClasses; c++) {
+            sumExp += std::exp(logProbs[c] - logProbs[best]);
+        }
+        classIds[d] = static_cast<int32_t>(best);
+        confidences[d] = 1.0 / sumExp;
+    }
 }
 
 std::string NaiveBayesClassifier::getModelInfo() const {
     std::stringstream ss;
     ss << "Naive Bayes Classifier\n";
     ss << "  Trained: " << (isTrained ? "Yes" : "No") << "\n";
-    ss << "  Classes: " << classPriors.size() << "\n";
-    ss << "  Vocabulary size: " << vocabulary.size() << "\n";
+    ss << "  Classes: " << classNames.size() << "\n";
+    if (hasher.isEnabled()) {
+        ss << "  Hashed buckets: " << hasher.getBucketCount() << " (n-grams up to "
+           << hasher.ngramOrder << ")\n";
+    } else {
+        ss << "  Vocabulary size: " << vocabulary.size() << "\n";
+    }
     ss << "  Training documents: " << totalDocuments << "\n";
     ss << "  Smoothing alpha: " << smoothingAlpha << "\n";
     return ss.str();
 }
 
-// ==================== Decision Tree ====================
+namespace {
 
-DecisionTree::DecisionTree(int maxDepth, int minSamples)
-    : maxDepth(maxDepth), minSamplesSplit(minSamples), currentDepth(0) {
+struct NaiveBayesFileMeta {
+    uint32_t numClasses;
+    uint32_t vocabSize;
+    uint32_t classStride;
+    uint32_t isTrained;
+    double smoothingAlpha;
+    double documentWeight;
+    int64_t totalDocuments;
+};
+
+}  // namespace
+
+void NaiveBayesClassifier::serialize(ModelFileWriter& writer) const {
+    refreshLikelihoods();
+    
+    NaiveBayesFileMeta meta = {};
+    meta.numClasses = static_cast<uint32_t>(classNames.size());
+    meta.vocabSize = static_cast<uint32_t>(termCount());
+    meta.classStride = static_cast<uint32_t>(classStride);
+    meta.isTrained = isTrained ? 1 : 0;
+    meta.smoothingAlpha = smoothingAlpha;
+    meta.documentWeight = mappedDocumentWeight;
+    meta.totalDocuments = totalDocuments;
+    if (!mappedModel) {
+        meta.documentWeight = 0.0;
+        for (double count : classDocCounts) {
+            meta.documentWeight += count * countScale;
+        }
+    }
+    
+    // Vocabulary in term ID order
+    std::vector<std::string> terms(vocabulary.size());
+    for (const auto& pair : vocabulary) {
+        terms[pair.second] = pair.first;
+    }
+    
+    writer.addArray("NBMT", &meta, 1);
+    writer.addStrings("NBCL", classNames);
+    writer.addStrings("NBVO", terms);
+    writer.addArray("NBPR", logPriors.data(), logPriors.size());
+    writer.addArray("NBDE", logDenominators.data(), logDenominators.size());
+    writer.addArray("NBLL", numeratorTable(), (termCount() + 1) * classStride);
+    
+    // Optional: files without it use a string vocabulary
+    int32_t hashing[2] = {hasher.bits, hasher.ngramOrder};
+    writer.addArray("NBHS", hashing, 2);
 }
 
-double DecisionTree::calculateGini(const std::vector<std::string>& labels) const {
-    if (labels.empty()) return 0.0;
+bool NaiveBayesClassifier::deserialize(const std::shared_ptr<const MappedModelFile>& file) {
+    size_t count = 0;
+    const NaiveBayesFileMeta* meta = file->array<NaiveBayesFileMeta>("NBMT", count);
+    if (!meta || count != 1) return false;
+    
+    size_t numClasses = meta->numClasses;
+    size_t vocabSize = meta->vocabSize;
+    size_t stride = meta->classStride;
+    if (stride != (numClasses + 3) / 4 * 4) return false;
+    
+    FeatureHasher fileHasher;
+    if (file->hasSection("NBHS")) {
+        const int32_t* hashing = file->array<int32_t>("NBHS", count);
+        if (!hashing || count != 2) return false;
+        fileHasher = FeatureHasher(hashing[0], hashing[1]);
+        if (fileHasher.bits != hashing[0] || (fileHasher.isEnabled() && vocabSize != fileHasher.getBucketCount())) {
+            return false;
+        }
+    }
     
-    std::unordered_map<std::string, int> counts;
-    for (const auto& label : labels) {
-        counts[label]++;
+    std::vector<std::string> names, terms;
+    if (!file->strings("NBCL", names) || names.size() != numClasses) return false;
+    if (!file->strings("NBVO", terms) || terms.size() != (fileHasher.isEnabled() ? 0 : vocabSize)) {
+        return false;
     }
     
-    double gini = 1.0;
-    int total = labels.size();
-    for (const auto& pair : counts) {
-        double prob = static_cast<double>(pair.second) / total;
-        gini -= prob * prob;
+    size_t priorCount = 0, denominatorCount = 0, numeratorCount = 0;
+    const double* priors = file->array<double>("NBPR", priorCount);
+    const double* denominators = file->array<double>("NBDE", denominatorCount);
+    const double* numerators = file->array<double>("NBLL", numeratorCount);
+    if (!priors || !denominators || !numerators || priorCount != stride ||
+        denominatorCount != stride || numeratorCount != (vocabSize + 1) * stride) {
+        return false;
     }
     
-    return gini;
+    std::unordered_map<std::string, int> ids;
+    for (size_t c = 0; c < numClasses; c++) {
+        ids.emplace(names[c], static_cast<int>(c));
+    }
+    std::unordered_map<std::string, uint32_t> vocab;
+    vocab.reserve(terms.size());
+    for (size_t term = 0; term < terms.size(); term++) {
+        vocab.emplace(std::move(terms[term]), static_cast<uint32_t>(term));
+    }
+    if (ids.size() != numClasses || vocab.size() != terms.size()) return false;
+    
+    hasher = fileHasher;
+    resetModel();
+    classNames = std::move(names);
+    classIds = std::move(ids);
+    vocabulary = std::move(vocab);
+    classStride = stride;
+    logPriors.assign(priors, priors + stride);
+    logDenominators.assign(denominators, denominators + stride);
+    logNumerators.clear();
+    
+    mappedModel = file;
+    mappedNumerators = numerators;
+    mappedDocumentWeight = meta->documentWeight;
+    totalDocuments = static_cast<int>(meta->totalDocuments);
+    smoothingAlpha = meta->smoothingAlpha;
+    isTrained = meta->isTrained != 0;
+    likelihoodsStale.store(false);
+    return true;
 }
 
-std::string DecisionTree::getMajorityClass(const std::vector<FeatureVector>& samples) const {
-    std::unordered_map<std::string, int> counts;
-    for (const auto& sample : samples) {
-        counts[sample.groundTruthLabel]++;
+// ==================== Decision Tree ====================
+
+void BinnedFeatureMatrix::build(const Dataset& data, int maxBins) {
+    maxBins = std::max(2, std::min(maxBins, kMaxBins));
+    size_t numSamples = data.size();
+    
+    featureNames = data.featureNames;
+    labels = data.labels;
+    classNames = data.classNames;
+    cutPoints.assign(featureNames.size(), std::vector<double>());
+    bins.assign(featureNames.size(), std::vector<uint8_t>(numSamples, 0));
+    if (numSamples == 0) return;
+    
+    std::vector<float> sorted;
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        const std::vector<float>& values = data.columns[f];
+        sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+        float maxValue = sorted.back();
+        
+        // Cut points: every distinct value when few, otherwise equal-frequency quantiles.
+        // The maximum is never a cut since splitting there leaves the right side empty.
+        std::vector<double>& cuts = cutPoints[f];
+        size_t distinct = 1;
+        for (size_t i = 1; i < numSamples; i++) {
+            distinct += sorted[i] != sorted[i - 1];
+        }
+        if (distinct <= static_cast<size_t>(maxBins)) {
+            for (size_t i = 0; i < numSamples; i++) {
+                if ((i == 0 || sorted[i] != sorted[i - 1]) && sorted[i] < maxValue) {
+                    cuts.push_back(sorted[i]);
+                }
+            }
+        } else {
+            for (int k = 1; k < maxBins; k++) {
+                double cut = sorted[k * numSamples / maxBins - 1];
+                if (cut < maxValue && (cuts.empty() || cut > cuts.back())) {
+                    cuts.push_back(cut);
+                }
+            }
+        }
+        
+        for (size_t i = 0; i < numSamples; i++) {
+            bins[f][i] = static_cast<uint8_t>(std::lower_bound(cuts.begin(), cuts.end(),
+                                                               static_cast<double>(values[i])) - cuts.begin());
+        }
     }
+}
+
+DecisionTree::DecisionTree(int maxDepth, int minSamples)
+    : maxDepth(maxDepth), minSamplesSplit(minSamples), currentDepth(0) {
+}
+
+double DecisionTree::calculateGini(const int* classCounts, size_t numClasses, size_t total) {
+    if (total == 0) return 0.0;
     
-    std::string majority;
-    int maxCount = 0;
-    for (const auto& pair : counts) {
-        if (pair.second > maxCount) {
-            maxCount = pair.second;
-            majority = pair.first;
-        }
+    double gini = 1.0;
+    for (size_t c = 0; c < numClasses; c++) {
+        double prob = static_cast<double>(classCounts[c]) / total;
+        gini -= prob * prob;
     }
     
-    return majority;
+    return gini;
 }
 
-std::pair<std::string, double> DecisionTree::findBestSplit(
-    const std::vector<FeatureVector>& samples,
-    const std::vector<std::string>& featureNames) const {
-    
-    double bestGiniGain = 0.0;
-    std::string bestFeature;
-    double bestThreshold = 0.0;
+DecisionTree::SplitCandidate DecisionTree::findBestSplit(const BinnedFeatureMatrix& data,
+                                                         const std::vector<int>& features,
+                                                         const uint32_t* indices,
+                                                         size_t count,
+                                                         const std::vector<int>& classCounts) const {
+    SplitCandidate best = {-1, 0, 0.0};
+    size_t numClasses = classCounts.size();
     
     // Calculate current Gini
-    std::vector<std::string> currentLabels;
-    for (const auto& sample : samples) {
-        currentLabels.push_back(sample.groundTruthLabel);
-    }
-    double currentGini = calculateGini(currentLabels);
-    
-    // Try each feature
-    for (const auto& featureName : featureNames) {
-        // Get all values for this feature
-        std::vector<double> values;
-        for (const auto& sample : samples) {
-            auto it = sample.features.find(featureName);
-            if (it != sample.features.end()) {
-                values.push_back(it->second);
-            }
-        }
-        
-        if (values.empty()) continue;
+    double currentGini = calculateGini(classCounts.data(), numClasses, count);
+    
+    std::vector<int> histogram;
+    std::vector<int> leftCounts(numClasses), rightCounts(numClasses);
+    for (int f : features) {
+        size_t numBins = data.getBinCount(f);
+        if (numBins < 2) continue;
         
-        // Try median as threshold
-        std::sort(values.begin(), values.end());
-        double threshold = values[values.size() / 2];
+        // Per-bin class counts for the node's samples
+        histogram.assign(numBins * numClasses, 0);
+        const uint8_t* column = data.bins[f].data();
+        for (size_t i = 0; i < count; i++) {
+            uint32_t sample = indices[i];
+            histogram[column[sample] * numClasses + data.labels[sample]]++;
+        }
         
-        // Split samples
-        std::vector<std::string> leftLabels, rightLabels;
-        for (const auto& sample : samples) {
-            auto it = sample.features.find(featureName);
-            double value = (it != sample.features.end()) ? it->second : 0.0;
+        // Sweep bin boundaries left to right with cumulative counts
+        std::fill(leftCounts.begin(), leftCounts.end(), 0);
+        size_t leftTotal = 0;
+        for (size_t b = 0; b + 1 < numBins; b++) {
+            for (size_t c = 0; c < numClasses; c++) {
+                leftCounts[c] += histogram[b * numClasses + c];
+                leftTotal += histogram[b * numClasses + c];
+            }
+            if (leftTotal == 0) continue;
+            if (leftTotal == count) break;
             
-            if (value <= threshold) {
-                leftLabels.push_back(sample.groundTruthLabel);
-            } else {
-                rightLabels.push_back(sample.groundTruthLabel);
+            for (size_t c = 0; c < numClasses; c++) {
+                rightCounts[c] = classCounts[c] - leftCounts[c];
+            }
+            size_t rightTotal = count - leftTotal;
+            
+            // Calculate weighted Gini after split
+            double leftGini = calculateGini(leftCounts.data(), numClasses, leftTotal);
+            double rightGini = calculateGini(rightCounts.data(), numClasses, rightTotal);
+            double weightedGini = (leftTotal * leftGini + rightTotal * rightGini) / count;
+            
+            double giniGain = currentGini - weightedGini;
+            if (giniGain > best.giniGain) {
+                best = {f, static_cast<int>(b), giniGain};
             }
-        }
-        
-        if (leftLabels.empty() || rightLabels.empty()) continue;
-        
-        // Calculate weighted Gini after split
-        double leftGini = calculateGini(leftLabels);
-        double rightGini = calculateGini(rightLabels);
-        double weightedGini = (leftLabels.size() * leftGini + rightLabels.size() * rightGini) / samples.size();
-        
-        double giniGain = currentGini - weightedGini;
-        
-        if (giniGain > bestGiniGain) {
-            bestGiniGain = giniGain;
-            bestFeature = featureName;
-            bestThreshold = threshold;
         }
     }
     
-    return {bestFeature, bestThreshold};
+    return best;
 }
 
-std::shared_ptr<DecisionTreeNode> DecisionTree::buildTree(
-    const std::vector<FeatureVector>& samples,
-    const std::vector<std::string>& featureNames,
-    int depth) {
-    
-    auto node = std::make_shared<DecisionTreeNode>();
+void DecisionTree::buildTree(const BinnedFeatureMatrix& data,
+                             const std::vector<int>& features,
+                             uint32_t* indices,
+                             size_t count,
+                             int depth,
+                             int32_t nodeIndex) {
+    
+    // Class counts and majority class
+    std::vector<int> classCounts(data.classNames.size(), 0);
+    for (size_t i = 0; i < count; i++) {
+        classCounts[data.labels[indices[i]]]++;
+    }
+    auto majority = std::max_element(classCounts.begin(), classCounts.end());
+    
+    auto makeLeaf = [&](float confidence) {
+        DecisionTreeNode& node = nodes[nodeIndex];
+        node.feature = 0;
+        node.threshold = std::numeric_limits<float>::infinity();
+        node.leftChild = nodeIndex;
+        node.classId = (count > 0) ? static_cast<int32_t>(majority - classCounts.begin()) : -1;
+        node.confidence = confidence;
+        currentDepth = std::max(currentDepth, depth);
+    };
     
     // Check stopping criteria
-    if (depth >= maxDepth || samples.size() < static_cast<size_t>(minSamplesSplit)) {
-        node->isLeaf = true;
-        node->label = getMajorityClass(samples);
-        node->confidence = 1.0;
-        currentDepth = std::max(currentDepth, depth);
-        return node;
+    if (depth >= maxDepth || count < static_cast<size_t>(minSamplesSplit)) {
+        makeLeaf(1.0f);
+        return;
     }
     
     // Check if all samples have same label
-    std::string firstLabel = samples[0].groundTruthLabel;
-    bool allSame = true;
-    for (const auto& sample : samples) {
-        if (sample.groundTruthLabel != firstLabel) {
-            allSame = false;
-            break;
-        }
-    }
-    
-    if (allSame) {
-        node->isLeaf = true;
-        node->label = firstLabel;
-        node->confidence = 1.0;
-        currentDepth = std::max(currentDepth, depth);
-        return node;
+    if (*majority == static_cast<int>(count)) {
+        makeLeaf(1.0f);
+        return;
     }
     
     // Find best split
-    auto [bestFeature, bestThreshold] = findBestSplit(samples, featureNames);
-    
-    if (bestFeature.empty()) {
-        node->isLeaf = true;
-        node->label = getMajorityClass(samples);
-        node->confidence = 0.5;
-        currentDepth = std::max(currentDepth, depth);
-        return node;
+    SplitCandidate split = findBestSplit(data, features, indices, count, classCounts);
+    if (split.feature < 0) {
+        makeLeaf(0.5f);
+        return;
     }
     
-    // Split samples
-    std::vector<FeatureVector> leftSamples, rightSamples;
-    for (const auto& sample : samples) {
-        auto it = sample.features.find(bestFeature);
-        double value = (it != sample.features.end()) ? it->second : 0.0;
-        
-        if (value <= bestThreshold) {
-            leftSamples.push_back(sample);
-        } else {
-            rightSamples.push_back(sample);
+    // Partition sample indices in place: left block <= threshold
+    const std::vector<uint8_t>& column = data.bins[split.feature];
+    uint32_t* middle = std::partition(indices, indices + count, [&](uint32_t sample) {
+        return column[sample] <= split.bin;
+    });
+    size_t leftCount = middle - indices;
+    
+    // Create internal node with both children allocated side by side
+    // (cut points come from float column values, so the float threshold is exact)
+    int32_t leftChild = static_cast<int32_t>(nodes.size());
+    nodes.resize(nodes.size() + 2);
+    DecisionTreeNode& node = nodes[nodeIndex];
+    node.feature = split.feature;
+    node.threshold = static_cast<float>(data.cutPoints[split.feature][split.bin]);
+    node.leftChild = leftChild;
+    node.classId = -1;
+    node.confidence = 0.0f;
+    
+    buildTree(data, features, indices, leftCount, depth + 1, leftChild);
+    buildTree(data, features, middle, count - leftCount, depth + 1, leftChild + 1);
+}
+
+void DecisionTree::train(const std::vector<FeatureVector>& features,
+                        const std::vector<std::string>& featureNames) {
+    Dataset data = Dataset::fromFeatureVectors(features);
+    BinnedFeatureMatrix bins;
+    bins.build(data);
+    
+    // Requested features that occur in the data (absent ones are all zero)
+    std::vector<int> featureIds;
+    for (const auto& name : featureNames) {
+        auto it = data.featureIndex.find(name);
+        if (it != data.featureIndex.end()) {
+            featureIds.push_back(it->second);
         }
     }
     
-    // Create internal node
-    node->isLeaf = false;
-    node->featureName = bestFeature;
-    node->threshold = bestThreshold;
-    node->leftChild = buildTree(leftSamples, featureNames, depth + 1);
-    node->rightChild = buildTree(rightSamples, featureNames, depth + 1);
-    
-    return node;
+    std::vector<uint32_t> indices(features.size());
+    std::iota(indices.begin(), indices.end(), 0);
+    train(bins, std::move(indices), featureIds);
 }
 
-void DecisionTree::train(const std::vector<FeatureVector>& features,
-                        const std::vector<std::string>& featureNames) {
+void DecisionTree::train(const BinnedFeatureMatrix& data, std::vector<uint32_t> sampleIndices,
+                        const std::vector<int>& features) {
+    featureNames = data.featureNames;
+    classNames = data.classNames;
     currentDepth = 0;
-    root = buildTree(features, featureNames, 0);
+    nodes.assign(1, DecisionTreeNode());
+    buildTree(data, features, sampleIndices.data(), sampleIndices.size(), 0, 0);
+    nodes.shrink_to_fit();
 }
 
-ClassificationResult DecisionTree::traverse(const FeatureVector& features,
-                                           std::shared_ptr<DecisionTreeNode> node) const {
-    if (!node) {
+// Dense row of the named features; absent features are zero
+static void gatherFeatures(const FeatureVector& features, const std::vector<std::string>& names,
+                           std::vector<float>& row) {
+    row.resize(names.size());
+    for (size_t f = 0; f < names.size(); f++) {
+        auto it = features.features.find(names[f]);
+        row[f] = (it != features.features.end()) ? static_cast<float>(it->second) : 0.0f;
+    }
+}
+
+ClassificationResult DecisionTree::predict(const FeatureVector& features) const {
+    if (nodes.empty()) {
         return ClassificationResult("unknown", 0.0, "DecisionTree");
     }
     
-    if (node->isLeaf) {
-        return ClassificationResult(node->label, node->confidence, "DecisionTree");
+    std::vector<float> row;
+    gatherFeatures(features, featureNames, row);
+    
+    int32_t index = 0;
+    while (!nodes[index].isLeaf(index)) {
+        const DecisionTreeNode& node = nodes[index];
+        index = node.leftChild + (row[node.feature] > node.threshold);
     }
     
-    // Get feature value
-    auto it = features.features.find(node->featureName);
-    double value = (it != features.features.end()) ? it->second : 0.0;
+    const DecisionTreeNode& leaf = nodes[index];
+    return ClassificationResult(leaf.classId >= 0 ? classNames[leaf.classId] : "",
+                                leaf.confidence, "DecisionTree");
+}
+
+void DecisionTree::predictColumns(const float* const* columns, size_t numRows,
+                                  int32_t* classIds) const {
+    if (nodes.empty()) {
+        std::fill(classIds, classIds + numRows, -1);
+        return;
+    }
     
-    // Traverse left or right
-    if (value <= node->threshold) {
-        return traverse(features, node->leftChild);
-    } else {
-        return traverse(features, node->rightChild);
+    const size_t kBlock = 64;
+    int32_t cursor[kBlock];
+    for (size_t start = 0; start < numRows; start += kBlock) {
+        size_t blockSize = std::min(kBlock, numRows - start);
+        std::fill(cursor, cursor + blockSize, 0);
+        
+        // Leaves loop back to themselves, so currentDepth steps settle every row
+        for (int level = 0; level < currentDepth; level++) {
+            for (size_t j = 0; j < blockSize; j++) {
+                const DecisionTreeNode& node = nodes[cursor[j]];
+                cursor[j] = node.leftChild + (columns[node.feature][start + j] > node.threshold);
+            }
+        }
+        
+        for (size_t j = 0; j < blockSize; j++) {
+            classIds[start + j] = nodes[cursor[j]].classId;
+        }
     }
 }
 
-ClassificationResult DecisionTree::predict(const FeatureVector& features) const {
-    if (!root) {
-        return ClassificationResult("unknown", 0.0, "DecisionTree");
+bool DecisionTree::loadNodes(const DecisionTreeNode* source, size_t count,
+                             const std::vector<std::string>& features,
+                             const std::vector<std::string>& classes) {
+    if (count == 0 || count > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        return false;
     }
     
-    return traverse(features, root);
+    // Children follow their parent, so depths are final when a node is reached
+    std::vector<int> depths(count, 0);
+    int depth = 0;
+    for (size_t i = 0; i < count; i++) {
+        const DecisionTreeNode& node = source[i];
+        int32_t index = static_cast<int32_t>(i);
+        if (node.classId < -1 || node.classId >= static_cast<int64_t>(classes.size())) return false;
+        
+        // Batched traversal reads the feature of leaves too (except a lone root)
+        if (count > 1 && (node.feature < 0 || node.feature >= static_cast<int64_t>(features.size()))) {
+            return false;
+        }
+        
+        if (node.isLeaf(index)) {
+            if (node.threshold != std::numeric_limits<float>::infinity()) return false;
+            depth = std::max(depth, depths[i]);
+            continue;
+        }
+        
+        if (node.leftChild <= index || static_cast<size_t>(node.leftChild) + 1 >= count) return false;
+        for (int32_t child = node.leftChild; child <= node.leftChild + 1; child++) {
+            depths[child] = std::max(depths[child], depths[i] + 1);
+        }
+    }
+    
+    nodes.assign(source, source + count);
+    featureNames = features;
+    classNames = classes;
+    currentDepth = depth;
+    return true;
 }
 
 // ==================== Random Forest ====================
 
 RandomForestClassifier::RandomForestClassifier(int numTrees, int maxDepth,
-                                             int minSamples, double featureRatio)
+                                             int minSamples, double featureRatio,
+                                             uint64_t seed, int threads)
     : numTrees(numTrees), maxDepth(maxDepth), minSamplesSplit(minSamples),
-      featureSamplingRatio(featureRatio), isTrained(false) {
+      featureSamplingRatio(featureRatio), randomSeed(seed), numThreads(threads),
+      isTrained(false) {
 }
 
-std::vector<FeatureVector> RandomForestClassifier::createBootstrapSample(
-    const std::vector<FeatureVector>& features) const {
-    
-    std::vector<FeatureVector> bootstrap;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, features.size() - 1);
-    
-    for (size_t i = 0; i < features.size(); i++) {
-        int idx = dis(gen);
-        bootstrap.push_back(features[idx]);
+std::vector<uint32_t> RandomForestClassifier::createBootstrapSample(size_t numRows,
+                                                                    std::mt19937_64& gen) const {
+    std::vector<uint32_t> bootstrap;
+    if (numRows == 0) return bootstrap;
+    
+    std::uniform_int_distribution<uint32_t> dis(0, numRows - 1);
+    bootstrap.reserve(numRows);
+    for (size_t i = 0; i < numRows; i++) {
+        bootstrap.push_back(dis(gen));
     }
     
     return bootstrap;
 }
 
-std::vector<std::string> RandomForestClassifier::sampleFeatures(
-    const std::vector<std::string>& allFeatures) const {
-    
-    int numFeatures = std::max(1, static_cast<int>(allFeatures.size() * featureSamplingRatio));
+std::vector<int> RandomForestClassifier::sampleFeatures(size_t numFeatures,
+                                                        std::mt19937_64& gen) const {
+    int numSampled = std::max(1, static_cast<int>(numFeatures * featureSamplingRatio));
     
-    std::vector<std::string> sampled;
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    
-    std::vector<std::string> shuffled = allFeatures;
+    std::vector<int> shuffled(numFeatures);
+    std::iota(shuffled.begin(), shuffled.end(), 0);
     std::shuffle(shuffled.begin(), shuffled.end(), gen);
     
-    for (int i = 0; i < numFeatures && i < static_cast<int>(shuffled.size()); i++) {
-        sampled.push_back(shuffled[i]);
-    }
-    
-    return sampled;
+    shuffled.resize(std::min(static_cast<size_t>(numSampled), numFeatures));
+    return shuffled;
 }
 
 void RandomForestClassifier::train(const std::vector<FeatureVector>& features) {
-    trees.clear();
-    
-    // Extract feature names
-    if (!features.empty()) {
-        for (const auto& pair : features[0].features) {
-            featureNames.push_back(pair.first);
+    train(Dataset::fromFeatureVectors(features));
+}
+
+void RandomForestClassifier::train(const Dataset& data) {
+    // Bin once; every tree trains on index views of the same matrix
+    BinnedFeatureMatrix bins;
+    bins.build(data);
+    
+    std::vector<uint32_t> rows(data.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    train(bins, rows);
+}
+
+void RandomForestClassifier::train(const BinnedFeatureMatrix& bins, const std::vector<uint32_t>& rows) {
+    trees.assign(numTrees, DecisionTree(maxDepth, minSamplesSplit));
+    featureNames = bins.featureNames;
+    classNames = bins.classNames;
+    
+    // Trees are independent: each has its own seeded RNG, so the forest does
+    // not depend on which thread builds which tree
+    parallelFor(trees.size(), numThreads, 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            std::seed_seq seq{static_cast<uint32_t>(randomSeed), static_cast<uint32_t>(randomSeed >> 32),
+                              static_cast<uint32_t>(i)};
+            std::mt19937_64 gen(seq);
+            
+            auto bootstrap = createBootstrapSample(rows.size(), gen);
+            for (uint32_t& sample : bootstrap) {
+                sample = rows[sample];
+            }
+            auto sampledFeatures = sampleFeatures(featureNames.size(), gen);
+            trees[i].train(bins, std::move(bootstrap), sampledFeatures);
         }
-    }
+    });
     
-    // Train each tree on bootstrap sample
-    for (int i = 0; i < numTrees; i++) {
-        auto bootstrap = createBootstrapSample(features);
-        auto sampledFeatures = sampleFeatures(featureNames);
+    isTrained = true;
+}
+
+ClassificationResult RandomForestClassifier::resultFromVotes(const int* votes) const {
+    size_t numSlots = classNames.size() + 1;
+    
+    // Convert votes to probabilities; the most-voted class wins (lowest ID on ties)
+    ClassificationResult result("", 0.0, "RandomForest");
+    int bestVotes = 0;
+    for (size_t c = 0; c < numSlots; c++) {
+        if (votes[c] == 0) continue;
         
-        DecisionTree tree(maxDepth, minSamplesSplit);
-        tree.train(bootstrap, sampledFeatures);
-        trees.push_back(tree);
+        const std::string& label = (c < classNames.size()) ? classNames[c] : std::string();
+        double probability = static_cast<double>(votes[c]) / trees.size();
+        result.classProbabilities[label] = probability;
+        if (votes[c] > bestVotes) {
+            bestVotes = votes[c];
+            result.label = label;
+            result.confidence = probability;
+        }
     }
     
-    isTrained = true;
+    return result;
 }
 
 ClassificationResult RandomForestClassifier::predict(const FeatureVector& features) const {
@@ -434,42 +1408,201 @@ ClassificationResult RandomForestClassifier::predict(const FeatureVector& featur
         return ClassificationResult("unknown", 0.0, "RandomForest");
     }
     
-    auto probabilities = predictProbabilities(features);
+    std::vector<float> row;
+    gatherFeatures(features, featureNames, row);
     
-    // Find class with highest probability
-    std::string bestClass;
-    double maxProb = 0.0;
-    for (const auto& pair : probabilities) {
-        if (pair.second > maxProb) {
-            maxProb = pair.second;
-            bestClass = pair.first;
-        }
+    // Collect votes from all trees
+    std::vector<int> votes(classNames.size() + 1, 0);
+    for (const auto& tree : trees) {
+        int32_t classId = tree.predictClass(row.data());
+        votes[classId >= 0 ? classId : classNames.size()]++;
     }
     
-    ClassificationResult result(bestClass, maxProb, "RandomForest");
-    result.classProbabilities = probabilities;
-    
-    return result;
+    return resultFromVotes(votes.data());
 }
 
 std::unordered_map<std::string, double> RandomForestClassifier::predictProbabilities(
     const FeatureVector& features) const {
     
-    std::unordered_map<std::string, int> votes;
+    if (!isTrained || trees.empty()) {
+        return {};
+    }
+    return predict(features).classProbabilities;
+}
+
+std::vector<ClassificationResult> RandomForestClassifier::predictBatch(
+    const std::vector<FeatureVector>& features) const {
     
-    // Collect votes from all trees
+    return predictBatch(Dataset::fromFeatureVectors(features));
+}
+
+std::vector<ClassificationResult> RandomForestClassifier::predictBatch(const Dataset& data) const {
+    // Forest feature f reads the data column of the same name
+    std::vector<float> zeros(data.size(), 0.0f);
+    std::vector<const float*> columns(featureNames.size(), zeros.data());
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        auto it = data.featureIndex.find(featureNames[f]);
+        if (it != data.featureIndex.end()) {
+            columns[f] = data.columns[it->second].data();
+        }
+    }
+    
+    return predictColumnBatch(columns, data.size());
+}
+
+std::vector<ClassificationResult> RandomForestClassifier::predictBatch(
+    const Dataset& data, const std::vector<uint32_t>& rows) const {
+    
+    std::vector<std::vector<float>> gathered(featureNames.size(), std::vector<float>(rows.size(), 0.0f));
+    std::vector<const float*> columns(featureNames.size());
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        auto it = data.featureIndex.find(featureNames[f]);
+        if (it != data.featureIndex.end()) {
+            const std::vector<float>& column = data.columns[it->second];
+            for (size_t i = 0; i < rows.size(); i++) {
+                gathered[f][i] = column[rows[i]];
+            }
+        }
+        columns[f] = gathered[f].data();
+    }
+    
+    return predictColumnBatch(columns, rows.size());
+}
+
+void RandomForestClassifier::forEachVoteBlock(
+    const std::vector<const float*>& columns, size_t numRows,
+    const std::function<void(size_t, size_t, const int*)>& fn) const {
+    
+    // Each block of rows runs through one tree at a time while its nodes are hot
+    size_t numSlots = classNames.size() + 1;
+    parallelFor(numRows, numThreads, 1024, [&](size_t begin, size_t end) {
+        size_t count = end - begin;
+        std::vector<const float*> blockColumns(columns.size());
+        for (size_t f = 0; f < columns.size(); f++) {
+            blockColumns[f] = columns[f] + begin;
+        }
+        
+        std::vector<int32_t> classIds(count);
+        std::vector<int> votes(count * numSlots, 0);
+        for (const auto& tree : trees) {
+            tree.predictColumns(blockColumns.data(), count, classIds.data());
+            for (size_t i = 0; i < count; i++) {
+                votes[i * numSlots + (classIds[i] >= 0 ? classIds[i] : numSlots - 1)]++;
+            }
+        }
+        
+        fn(begin, count, votes.data());
+    });
+}
+
+std::vector<ClassificationResult> RandomForestClassifier::predictColumnBatch(
+    const std::vector<const float*>& columns, size_t numRows) const {
+    
+    std::vector<ClassificationResult> results(numRows);
+    if (!isTrained || trees.empty()) {
+        std::fill(results.begin(), results.end(), ClassificationResult("unknown", 0.0, "RandomForest"));
+        return results;
+    }
+    
+    size_t numSlots = classNames.size() + 1;
+    forEachVoteBlock(columns, numRows, [&](size_t begin, size_t count, const int* votes) {
+        for (size_t i = 0; i < count; i++) {
+            results[begin + i] = resultFromVotes(votes + i * numSlots);
+        }
+    });
+    
+    return results;
+}
+
+void RandomForestClassifier::predictCompact(const std::vector<const float*>& columns,
+                                            size_t numRows, int32_t* classIds,
+                                            double* confidences) const {
+    if (!isTrained || trees.empty()) {
+        std::fill(classIds, classIds + numRows, -1);
+        std::fill(confidences, confidences + numRows, 0.0);
+        return;
+    }
+    
+    // Same winner as resultFromVotes: most votes, lowest class ID on ties
+    size_t numSlots = classNames.size() + 1;
+    forEachVoteBlock(columns, numRows, [&](size_t begin, size_t count, const int* votes) {
+        for (size_t i = 0; i < count; i++) {
+            const int* rowVotes = votes + i * numSlots;
+            size_t best = std::max_element(rowVotes, rowVotes + numSlots) - rowVotes;
+            classIds[begin + i] = (best < classNames.size()) ? static_cast<int32_t>(best) : -1;
+            confidences[begin + i] = static_cast<double>(rowVotes[best]) / trees.size();
+        }
+    });
+}
+
+namespace {
+
+struct RandomForestFileMeta {
+    int32_t numTrees;
+    int32_t maxDepth;
+    int32_t minSamplesSplit;
+    uint32_t isTrained;
+    double featureSamplingRatio;
+    uint64_t randomSeed;
+};
+
+struct TreeFileEntry {
+    uint64_t firstNode;             // Into the concatenated node array
+    uint64_t nodeCount;
+};
+
+}  // namespace
+
+void RandomForestClassifier::serialize(ModelFileWriter& writer) const {
+    RandomForestFileMeta meta = {numTrees, maxDepth, minSamplesSplit, isTrained ? 1u : 0u,
+                                 featureSamplingRatio, randomSeed};
+    
+    std::vector<TreeFileEntry> entries;
+    std::vector<DecisionTreeNode> allNodes;
     for (const auto& tree : trees) {
-        auto prediction = tree.predict(features);
-        votes[prediction.label]++;
+        const auto& treeNodes = tree.getNodes();
+        entries.push_back({allNodes.size(), treeNodes.size()});
+        allNodes.insert(allNodes.end(), treeNodes.begin(), treeNodes.end());
     }
     
-    // Convert votes to probabilities
-    std::unordered_map<std::string, double> probabilities;
-    for (const auto& pair : votes) {
-        probabilities[pair.first] = static_cast<double>(pair.second) / trees.size();
+    writer.addArray("RFMT", &meta, 1);
+    writer.addStrings("RFFN", featureNames);
+    writer.addStrings("RFCN", classNames);
+    writer.addArray("RFTR", entries.data(), entries.size());
+    writer.addArray("RFND", allNodes.data(), allNodes.size());
+}
+
+bool RandomForestClassifier::deserialize(const MappedModelFile& file) {
+    size_t count = 0, numEntries = 0, numNodes = 0;
+    const RandomForestFileMeta* meta = file.array<RandomForestFileMeta>("RFMT", count);
+    if (!meta || count != 1) return false;
+    
+    std::vector<std::string> features, classes;
+    if (!file.strings("RFFN", features) || !file.strings("RFCN", classes)) return false;
+    
+    const TreeFileEntry* entries = file.array<TreeFileEntry>("RFTR", numEntries);
+    const DecisionTreeNode* allNodes = file.array<DecisionTreeNode>("RFND", numNodes);
+    if (!entries || !allNodes) return false;
+    
+    std::vector<DecisionTree> loaded(numEntries, DecisionTree(meta->maxDepth, meta->minSamplesSplit));
+    for (size_t i = 0; i < numEntries; i++) {
+        const TreeFileEntry& entry = entries[i];
+        if (entry.firstNode > numNodes || entry.nodeCount > numNodes - entry.firstNode) return false;
+        if (!loaded[i].loadNodes(allNodes + entry.firstNode, entry.nodeCount, features, classes)) {
+            return false;
+        }
     }
     
-    return probabilities;
+    trees = std::move(loaded);
+    featureNames = std::move(features);
+    classNames = std::move(classes);
+    numTrees = meta->numTrees;
+    maxDepth = meta->maxDepth;
+    minSamplesSplit = meta->minSamplesSplit;
+    featureSamplingRatio = meta->featureSamplingRatio;
+    randomSeed = meta->randomSeed;
+    isTrained = meta->isTrained != 0;
+    return true;
 }
 
 std::string RandomForestClassifier::getModelInfo() const {
@@ -479,6 +1612,7 @@ std::string RandomForestClassifier::getModelInfo() const {
     ss << "  Number of trees: " << numTrees << "\n";
     ss << "  Max depth: " << maxDepth << "\n";
     ss << "  Feature sampling ratio: " << featureSamplingRatio << "\n";
+    ss << "  Seed: " << randomSeed << "\n";
     return ss.str();
 }
 
@@ -570,10 +1704,50 @@ EnsemblePrediction MetaLearner::predict(
     return ensemble;
 }
 
+void MetaLearner::serialize(ModelFileWriter& writer) const {
+    uint32_t trained = isTrained ? 1 : 0;
+    
+    // Weights sorted by model name so equal models write equal files
+    std::vector<std::string> weightNames;
+    for (const auto& pair : weights) {
+        weightNames.push_back(pair.first);
+    }
+    std::sort(weightNames.begin(), weightNames.end());
+    std::vector<double> weightValues;
+    for (const auto& name : weightNames) {
+        weightValues.push_back(weights.at(name));
+    }
+    
+    writer.addArray("MLMT", &trained, 1);
+    writer.addStrings("MLNM", modelNames);
+    writer.addStrings("MLWN", weightNames);
+    writer.addArray("MLWT", weightValues.data(), weightValues.size());
+}
+
+bool MetaLearner::deserialize(const MappedModelFile& file) {
+    size_t count = 0, numWeights = 0;
+    const uint32_t* trained = file.array<uint32_t>("MLMT", count);
+    if (!trained || count != 1) return false;
+    
+    std::vector<std::string> names, weightNames;
+    if (!file.strings("MLNM", names) || !file.strings("MLWN", weightNames)) return false;
+    const double* weightValues = file.array<double>("MLWT", numWeights);
+    if (!weightValues || numWeights != weightNames.size()) return false;
+    
+    weights.clear();
+    for (size_t i = 0; i < numWeights; i++) {
+        weights[weightNames[i]] = weightValues[i];
+    }
+    modelNames = std::move(names);
+    isTrained = *trained != 0;
+    return true;
+}
+
 // ==================== Ensemble Classifier ====================
 
 EnsembleClassifier::EnsembleClassifier(const std::string& strategy)
-    : ensembleStrategy(strategy), useNaiveBayes(true), useRandomForest(true), isTrained(false) {
+    : ensembleStrategy(strategy), useNaiveBayes(true), useRandomForest(true), stackingFolds(5),
+      isTrained(false) {
 }
 
 void EnsembleClassifier::configureModels(bool useNB, bool useRF) {
@@ -582,36 +1756,112 @@ void EnsembleClassifier::configureModels(bool useNB, bool useRF) {
 }
 
 void EnsembleClassifier::train(const std::vector<FeatureVector>& features) {
+    train(Dataset::fromFeatureVectors(features));
+}
+
+void EnsembleClassifier::train(const Dataset& data) {
+    BinnedFeatureMatrix bins;
+    if (useRandomForest) {
+        bins.build(data);
+    }
+    
+    std::vector<uint32_t> rows(data.size());
+    std::iota(rows.begin(), rows.end(), 0);
+    
     // Train Naive Bayes
     if (useNaiveBayes) {
-        naiveBayes.train(features);
+        naiveBayes.train(data, rows);
     }
     
     // Train Random Forest
     if (useRandomForest) {
-        randomForest.train(features);
+        randomForest.train(bins, rows);
     }
     
     // Train meta learner if using stacking
     if (ensembleStrategy == "stacking") {
-        std::unordered_map<std::string, std::vector<ClassificationResult>> basePredictions;
-        std::vector<std::string> groundTruth;
-        
-        for (const auto& fv : features) {
-            groundTruth.push_back(fv.groundTruthLabel);
+        trainMetaLearner(data, bins);
+    }
+    
+    isTrained = true;
+}
+
+void EnsembleClassifier::trainMetaLearner(const Dataset& data, const BinnedFeatureMatrix& bins) {
+    size_t numRows = data.size();
+    std::vector<std::string> groundTruth(numRows);
+    for (size_t row = 0; row < numRows; row++) {
+        groundTruth[row] = data.classNames[data.labels[row]];
+    }
+    
+    // Create every entry up front; tasks below only write into them
+    std::unordered_map<std::string, std::vector<ClassificationResult>> basePredictions;
+    std::vector<ClassificationResult>* nbPredictions = nullptr;
+    std::vector<ClassificationResult>* rfPredictions = nullptr;
+    if (useNaiveBayes) nbPredictions = &basePredictions["NaiveBayes"];
+    if (useRandomForest) rfPredictions = &basePredictions["RandomForest"];
+    
+    std::vector<uint32_t> allRows(numRows);
+    std::iota(allRows.begin(), allRows.end(), 0);
+    
+    int folds = static_cast<int>(std::min<size_t>(std::max(stackingFolds, 0), numRows));
+    if (folds < 2) {
+        // Too few rows to hold any out: fall back to in-sample predictions
+        if (nbPredictions) *nbPredictions = naiveBayes.predictBatch(data, allRows);
+        if (rfPredictions) *rfPredictions = randomForest.predictBatch(data, allRows);
+        metaLearner.train(basePredictions, groundTruth);
+        return;
+    }
+    
+    if (nbPredictions) nbPredictions->resize(numRows);
+    if (rfPredictions) rfPredictions->resize(numRows);
+    
+    // Seeded shuffle into folds; each fold is a pair of row index views
+    std::vector<uint32_t> order = allRows;
+    std::mt19937_64 gen(42);
+    std::shuffle(order.begin(), order.end(), gen);
+    std::vector<int> foldOf(numRows);
+    for (size_t i = 0; i < numRows; i++) {
+        foldOf[order[i]] = static_cast<int>(i % folds);
+    }
+    std::vector<std::vector<uint32_t>> heldOut(folds), training(folds);
+    for (uint32_t row = 0; row < numRows; row++) {
+        for (int fold = 0; fold < folds; fold++) {
+            (fold == foldOf[row] ? heldOut : training)[fold].push_back(row);
+        }
+    }
+    
+    // One task per (fold, model); trees inside a task are built serially
+    std::vector<std::vector<ClassificationResult>*> models;
+    if (nbPredictions) models.push_back(nbPredictions);
+    if (rfPredictions) models.push_back(rfPredictions);
+    size_t numTasks = folds * models.size();
+    
+    parallelFor(numTasks, 0, 1, [&](size_t begin, size_t end) {
+        for (size_t task = begin; task < end; task++) {
+            int fold = static_cast<int>(task / models.size());
+            std::vector<ClassificationResult>* target = models[task % models.size()];
             
-            if (useNaiveBayes) {
-                basePredictions["NaiveBayes"].push_back(naiveBayes.predict(fv));
+            std::vector<ClassificationResult> predictions;
+            if (target == nbPredictions) {
+                NaiveBayesClassifier foldModel;
+                const FeatureHasher& hasher = naiveBayes.getFeatureHasher();
+                foldModel.setFeatureHashing(hasher.bits, hasher.ngramOrder);
+                foldModel.train(data, training[fold]);
+                predictions = foldModel.predictBatch(data, heldOut[fold]);
+            } else {
+                RandomForestClassifier foldForest = randomForest.withSameParameters();
+                foldForest.setNumThreads(1);
+                foldForest.train(bins, training[fold]);
+                predictions = foldForest.predictBatch(data, heldOut[fold]);
             }
-            if (useRandomForest) {
-                basePredictions["RandomForest"].push_back(randomForest.predict(fv));
+            
+            for (size_t i = 0; i < heldOut[fold].size(); i++) {
+                (*target)[heldOut[fold][i]] = std::move(predictions[i]);
             }
         }
-        
-        metaLearner.train(basePredictions, groundTruth);
-    }
+    });
     
-    isTrained = true;
+    metaLearner.train(basePredictions, groundTruth);
 }
 
 EnsemblePrediction EnsembleClassifier::predict(const FeatureVector& features) const {
@@ -653,6 +1903,143 @@ EnsemblePrediction EnsembleClassifier::predict(const FeatureVector& features) co
     return ensemble;
 }
 
+EnsembleBatchResult EnsembleClassifier::predictBatch(
+    const std::vector<std::shared_ptr<Proposal>>& proposals) const {
+    
+    size_t numDocs = proposals.size();
+    EnsembleBatchResult batch;
+    batch.predictions.assign(numDocs, CompactPrediction{-1, 0.0f});
+    
+    bool runNaiveBayes = useNaiveBayes && naiveBayes.isModelTrained();
+    bool runRandomForest = useRandomForest && randomForest.isModelTrained();
+    bool stacking = (ensembleStrategy == "stacking");
+    
+    // Fused extraction: numeric columns and term IDs in one pass, no FeatureVectors
+    std::vector<std::string> numericNames = ProposalFeatureExtractor::getFeatureNames();
+    std::vector<std::vector<float>> numeric(numericNames.size(), std::vector<float>(numDocs));
+    std::vector<double> values(numericNames.size());
+    std::vector<uint32_t> termIds;
+    std::vector<size_t> docOffsets(1, 0);
+    docOffsets.reserve(numDocs + 1);
+    const FeatureHasher& hasher = naiveBayes.getFeatureHasher();
+    std::vector<uint64_t> tokenHashes;
+    auto appendTerm = [&](const std::string& token) {
+        if (hasher.isEnabled()) {
+            tokenHashes.push_back(FeatureHasher::hashToken(token));
+        } else {
+            termIds.push_back(naiveBayes.lookupTerm(token));
+        }
+    };
+    
+    for (size_t d = 0; d < numDocs; d++) {
+        const Proposal& proposal = *proposals[d];
+        ProposalFeatureExtractor::extractNumericFeatures(proposal, values.data());
+        for (size_t f = 0; f < numericNames.size(); f++) {
+            numeric[f][d] = static_cast<float>(values[f]);
+        }
+        if (runNaiveBayes) {
+            tokenHashes.clear();
+            ProposalFeatureExtractor::forEachToken(proposal, appendTerm);
+            hasher.hashSequence(tokenHashes.data(), tokenHashes.size(), termIds);
+            docOffsets.push_back(termIds.size());
+        }
+    }
+    
+    // Per-model winners
+    std::vector<int32_t> nbClasses, rfClasses;
+    std::vector<double> nbConfidences, rfConfidences;
+    if (runNaiveBayes) {
+        nbClasses.resize(numDocs);
+        nbConfidences.resize(numDocs);
+        naiveBayes.predictCompact(termIds.data(), docOffsets.data(), numDocs,
+                                  nbClasses.data(), nbConfidences.data());
+    }
+    if (runRandomForest) {
+        // Forest features the extractor does not produce read as zero
+        std::vector<float> zeros(numDocs, 0.0f);
+        std::vector<const float*> columns;
+        for (const auto& name : randomForest.getFeatureNames()) {
+            auto it = std::find(numericNames.begin(), numericNames.end(), name);
+            columns.push_back(it != numericNames.end() ? numeric[it - numericNames.begin()].data()
+                                                       : zeros.data());
+        }
+        rfClasses.resize(numDocs);
+        rfConfidences.resize(numDocs);
+        randomForest.predictCompact(columns, numDocs, rfClasses.data(), rfConfidences.data());
+    }
+    
+    // One class table for the batch; model class IDs map into it
+    auto classIdOf = [&](const std::string& name) {
+        auto it = std::find(batch.classNames.begin(), batch.classNames.end(), name);
+        if (it != batch.classNames.end()) return static_cast<int32_t>(it - batch.classNames.begin());
+        batch.classNames.push_back(name);
+        return static_cast<int32_t>(batch.classNames.size() - 1);
+    };
+    std::vector<int32_t> nbMap, rfMap;
+    for (size_t c = 0; runNaiveBayes && c < naiveBayes.getClassCount(); c++) {
+        nbMap.push_back(classIdOf(naiveBayes.getClassName(c)));
+    }
+    for (size_t c = 0; runRandomForest && c < randomForest.getClassNames().size(); c++) {
+        rfMap.push_back(classIdOf(randomForest.getClassNames()[c]));
+    }
+    int32_t emptyLabel = -1;    // The "" label of empty leaves, added on first use
+    
+    if (stacking && !metaLearner.isModelTrained()) {
+        int32_t unknown = classIdOf("unknown");
+        for (auto& prediction : batch.predictions) {
+            prediction.classId = unknown;
+        }
+        return batch;
+    }
+    
+    double nbWeight = 0.5, rfWeight = 0.5;
+    if (stacking) {
+        auto weights = metaLearner.getWeights();
+        if (weights.count("NaiveBayes")) nbWeight = weights["NaiveBayes"];
+        if (weights.count("RandomForest")) rfWeight = weights["RandomForest"];
+    }
+    
+    // Same aggregation as predict(), over at most two votes per proposal
+    for (size_t d = 0; d < numDocs; d++) {
+        int32_t classes[2];
+        double scores[2];
+        int numVotes = 0;
+        double total = 0.0;
+        auto vote = [&](int32_t classId, double confidence, double modelWeight) {
+            double weight = stacking ? modelWeight * confidence
+                          : (ensembleStrategy == "weighted" ? confidence : 1.0);
+            total += stacking ? modelWeight : weight;
+            for (int v = 0; v < numVotes; v++) {
+                if (classes[v] == classId) {
+                    scores[v] += weight;
+                    return;
+                }
+            }
+            classes[numVotes] = classId;
+            scores[numVotes++] = weight;
+        };
+        
+        if (runNaiveBayes) {
+            vote(nbMap[nbClasses[d]], nbConfidences[d], nbWeight);
+        }
+        if (runRandomForest) {
+            if (rfClasses[d] < 0 && emptyLabel < 0) emptyLabel = classIdOf("");
+            vote(rfClasses[d] >= 0 ? rfMap[rfClasses[d]] : emptyLabel, rfConfidences[d], rfWeight);
+        }
+        
+        double bestScore = 0.0;
+        for (int v = 0; v < numVotes; v++) {
+            if (scores[v] > bestScore) {
+                bestScore = scores[v];
+                batch.predictions[d].classId = classes[v];
+                batch.predictions[d].confidence = static_cast<float>(bestScore / total);
+            }
+        }
+    }
+    
+    return batch;
+}
+
 std::unordered_map<std::string, ClassificationResult> EnsembleClassifier::getIndividualPredictions(
     const FeatureVector& features) const {
     
@@ -694,6 +2081,67 @@ std::map<std::pair<std::string, std::string>, int> EnsembleClassifier::getConfus
     return matrix;
 }
 
+namespace {
+
+struct EnsembleFileFlags {
+    uint32_t useNaiveBayes;
+    uint32_t useRandomForest;
+    uint32_t isTrained;
+    uint32_t reserved;
+};
+
+}  // namespace
+
+bool EnsembleClassifier::saveModel(const std::string& path) const {
+    ModelFileWriter writer;
+    EnsembleFileFlags flags = {useNaiveBayes ? 1u : 0u, useRandomForest ? 1u : 0u,
+                               isTrained ? 1u : 0u, 0};
+    writer.addArray("ENSF", &flags, 1);
+    writer.addStrings("ENSS", {ensembleStrategy});
+    
+    naiveBayes.serialize(writer);
+    randomForest.serialize(writer);
+    metaLearner.serialize(writer);
+    
+    if (!writer.writeToFile(path)) {
+        std::cerr << "Warning: could not write model file " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+bool EnsembleClassifier::loadModel(const std::string& path, bool verifyChecksum) {
+    std::string error;
+    auto file = MappedModelFile::open(path, verifyChecksum, error);
+    if (!file) {
+        std::cerr << "Warning: could not load model " << path << ": " << error << "\n";
+        return false;
+    }
+    
+    size_t count = 0;
+    const EnsembleFileFlags* flags = file->array<EnsembleFileFlags>("ENSF", count);
+    std::vector<std::string> strategy;
+    if (!flags || count != 1 || !file->strings("ENSS", strategy) || strategy.size() != 1) {
+        std::cerr << "Warning: could not load model " << path << ": missing ensemble section\n";
+        return false;
+    }
+    
+    // Components validate before replacing their state; a later failure
+    // leaves the ensemble untrained rather than mixing two models
+    if (!naiveBayes.deserialize(file) || !randomForest.deserialize(*file) ||
+        !metaLearner.deserialize(*file)) {
+        isTrained = false;
+        std::cerr << "Warning: could not load model " << path << ": malformed model section\n";
+        return false;
+    }
+    
+    ensembleStrategy = strategy[0];
+    useNaiveBayes = flags->useNaiveBayes != 0;
+    useRandomForest = flags->useRandomForest != 0;
+    isTrained = flags->isTrained != 0;
+    return true;
+}
+
 std::string EnsembleClassifier::getEnsembleInfo() const {
     std::stringstream ss;
     ss << "Ensemble Classifier\n";
@@ -714,25 +2162,68 @@ FeatureVector ProposalFeatureExtractor::extractFeatures(
     FeatureVector fv(proposal->getProposalId());
     
     // Numeric features
-    fv.features["vote_count"] = static_cast<double>(proposal->getVoteCount());
-    fv.features["title_length"] = static_cast<double>(proposal->getTitle().length());
-    fv.features["description_length"] = static_cast<double>(proposal->getDescription().length());
+    auto names = getFeatureNames();
+    std::vector<double> values(names.size());
+    extractNumericFeatures(*proposal, values.data());
+    for (size_t f = 0; f < names.size(); f++) {
+        fv.features[names[f]] = values[f];
+    }
     
     // Text tokenization for NLP models
     if (includeText) {
-        std::string text = proposal->getTitle() + " " + proposal->getDescription();
-        std::istringstream iss(text);
-        std::string token;
-        while (iss >> token) {
-            // Simple tokenization - convert to lowercase
-            std::transform(token.begin(), token.end(), token.begin(), ::tolower);
+        forEachToken(*proposal, [&](const std::string& token) {
             fv.textTokens.push_back(token);
-        }
+        });
     }
     
     return fv;
 }
 
+void ProposalFeatureExtractor::extractNumericFeatures(const Proposal& proposal, double* values) {
+    values[0] = static_cast<double>(proposal.getVoteCount());
+    values[1] = static_cast<double>(proposal.getTitle().length());
+    values[2] = static_cast<double>(proposal.getDescription().length());
+}
+
+void ProposalFeatureExtractor::forEachToken(const Proposal& proposal,
+                                            const std::function<void(const std::string&)>& onToken) {
+    // Simple tokenization - split title and description on whitespace, lowercase
+    std::string token;
+    for (const std::string* text : {&proposal.getTitle(), &proposal.getDescription()}) {
+        for (char ch : *text) {
+            if (std::isspace(static_cast<unsigned char>(ch))) {
+                if (!token.empty()) {
+                    onToken(token);
+                    token.clear();
+                }
+            } else {
+                token += static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+            }
+        }
+        
+        // Title and description are joined by a space
+        if (!token.empty()) {
+            onToken(token);
+            token.clear();
+        }
+    }
+}
+
+void ProposalFeatureExtractor::extractHashedFeatures(const Proposal& proposal,
+                                                     const FeatureHasher& hasher,
+                                                     std::vector<uint32_t>& indices,
+                                                     std::vector<float>& values) {
+    indices.clear();
+    values.clear();
+    if (!hasher.isEnabled()) return;
+    
+    std::vector<uint64_t> tokenHashes;
+    forEachToken(proposal, [&](const std::string& token) {
+        tokenHashes.push_back(FeatureHasher::hashToken(token));
+    });
+    hasher.hashSequence(tokenHashes.data(), tokenHashes.size(), indices, &values);
+}
+
 std::vector<FeatureVector> ProposalFeatureExtractor::extractBatch(
     const std::vector<std::shared_ptr<Proposal>>& proposals,
     const std::vector<std::string>& labels) {
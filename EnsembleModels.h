@@ -9,6 +9,11 @@
 #include <cmath>
 #include <algorithm>
 #include <numeric>
+#include <cstdint>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <functional>
 
 // Forward declarations
 class Proposal;
@@ -28,6 +33,28 @@ struct ClassificationResult {
         : label(lbl), confidence(conf), modelName(model) {}
 };
 
+/**
+ * Compact prediction for batch inference
+ */
+struct CompactPrediction {
+    int32_t classId;                // Index into the batch class table; -1 = no prediction
+    float confidence;
+};
+
+/**
+ * Batch predictions with a shared class table
+ */
+struct EnsembleBatchResult {
+    std::vector<std::string> classNames;
+    std::vector<CompactPrediction> predictions;
+    
+    const std::string& getLabel(size_t index) const {
+        static const std::string none;
+        int32_t classId = predictions[index].classId;
+        return classId >= 0 ? classNames[classId] : none;
+    }
+};
+
 /**
  * Ensemble prediction combining multiple models
  */
@@ -54,33 +81,302 @@ struct FeatureVector {
     FeatureVector(const std::string& id) : instanceId(id) {}
 };
 
+/**
+ * Columnar training data shared by all models
+ * 
+ * Numeric features are stored feature-major as float columns, labels as
+ * dense class IDs and text tokens as CSR term IDs into a shared dictionary.
+ * Models train on row index arrays (bootstrap samples, folds) over one
+ * Dataset instead of copying FeatureVectors. Features missing from a
+ * sample read as 0.0, as in the FeatureVector API.
+ */
+struct Dataset {
+    std::vector<std::string> instanceIds;
+    std::vector<std::string> featureNames;
+    std::vector<std::vector<float>> columns;    // per feature, per row
+    std::vector<int> labels;                    // per row class ID
+    std::vector<std::string> classNames;
+    std::vector<std::string> terms;             // term ID -> token
+    std::vector<uint32_t> tokenIds;             // CSR token term IDs
+    std::vector<size_t> tokenOffsets;           // row r owns [tokenOffsets[r], tokenOffsets[r + 1])
+    
+    std::unordered_map<std::string, int> featureIndex;
+    std::unordered_map<std::string, int> classIndex;
+    std::unordered_map<std::string, uint32_t> termIndex;
+    
+    Dataset() : tokenOffsets(1, 0) {}
+    
+    /**
+     * Append one sample, adding unseen features (zero-filled), classes and terms
+     */
+    void append(const FeatureVector& features);
+    
+    /**
+     * Convert feature vectors; features are ordered by first appearance
+     */
+    static Dataset fromFeatureVectors(const std::vector<FeatureVector>& features);
+    
+    /**
+     * Rebuild the FeatureVector for one row
+     */
+    FeatureVector toFeatureVector(size_t row) const;
+    
+    size_t size() const { return labels.size(); }
+    size_t getFeatureCount() const { return featureNames.size(); }
+};
+
+/**
+ * Binary model file
+ * 
+ * Layout: a 64-byte header, a table of section entries, then the sections,
+ * each starting on a 64-byte boundary. Arrays are stored in native layout
+ * so a mapped file is used in place; string lists are a uint32 count,
+ * count + 1 uint32 byte offsets and the concatenated bytes. The checksum
+ * covers everything after the header.
+ */
+struct ModelFileHeader {
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderMark = 0x01020304;
+    
+    char magic[8];                  // "CDMODEL\0"
+    uint32_t version;
+    uint32_t byteOrderMark;         // Rejects files written on other-endian hosts
+    uint32_t sectionCount;
+    uint32_t reserved0;
+    uint64_t fileSize;
+    uint64_t checksum;              // 64-bit FNV-1a over 8-byte words after the header
+    uint8_t reserved[24];
+};
+
+struct ModelSectionEntry {
+    uint32_t tag;                   // Four-character code
+    uint32_t elementSize;           // Bytes per element (1 for string lists)
+    uint64_t offset;                // From start of file
+    uint64_t size;                  // Bytes
+};
+
+/**
+ * Collects sections in memory and writes them as one model file
+ */
+class ModelFileWriter {
+private:
+    struct Section {
+        uint32_t tag;
+        uint32_t elementSize;
+        std::string bytes;
+    };
+    std::vector<Section> sections;
+    
+public:
+    static uint32_t makeTag(const char* code) {
+        return static_cast<uint32_t>(code[0]) | static_cast<uint32_t>(code[1]) << 8 |
+               static_cast<uint32_t>(code[2]) << 16 | static_cast<uint32_t>(code[3]) << 24;
+    }
+    
+    /**
+     * Add an array of trivially copyable elements
+     */
+    template <typename T>
+    void addArray(const char* code, const T* data, size_t count) {
+        std::string bytes;
+        if (count > 0) {
+            bytes.assign(reinterpret_cast<const char*>(data), count * sizeof(T));
+        }
+        sections.push_back({makeTag(code), static_cast<uint32_t>(sizeof(T)), std::move(bytes)});
+    }
+    
+    void addStrings(const char* code, const std::vector<std::string>& strings);
+    
+    /**
+     * Write header, section table and sections
+     * @return false if the file could not be written
+     */
+    bool writeToFile(const std::string& path) const;
+};
+
+/**
+ * Read-only model file, memory-mapped where the platform allows
+ * 
+ * Sections are validated against the file size when opened; array()
+ * returns pointers straight into the mapping, so holders of those
+ * pointers keep the file alive through a shared_ptr.
+ */
+class MappedModelFile {
+private:
+    const uint8_t* base;
+    size_t length;
+    bool isMapped;                  // munmap on destruction; otherwise base is buffer
+    std::vector<uint8_t> buffer;
+    std::unordered_map<uint32_t, ModelSectionEntry> sections;
+    
+    MappedModelFile() : base(nullptr), length(0), isMapped(false) {}
+    bool validate(bool verifyChecksum, std::string& error);
+    
+public:
+    ~MappedModelFile();
+    MappedModelFile(const MappedModelFile&) = delete;
+    MappedModelFile& operator=(const MappedModelFile&) = delete;
+    
+    /**
+     * Map and validate a model file
+     * @param path File to open
+     * @param verifyChecksum Hash the payload (one pass over the file)
+     * @param error Receives the reason on failure
+     * @return Open file, or nullptr on failure
+     */
+    static std::shared_ptr<const MappedModelFile> open(const std::string& path,
+                                                       bool verifyChecksum,
+                                                       std::string& error);
+    
+    /**
+     * Checksum used by the format: 64-bit FNV-1a over 8-byte words, then tail bytes
+     */
+    static uint64_t checksum(const uint8_t* data, size_t size);
+    
+    bool hasSection(const char* code) const {
+        return sections.count(ModelFileWriter::makeTag(code)) > 0;
+    }
+    
+    /**
+     * Typed view of an array section
+     * @param count Receives the element count
+     * @return Pointer into the file, or nullptr if missing or of another element size
+     */
+    template <typename T>
+    const T* array(const char* code, size_t& count) const {
+        count = 0;
+        auto it = sections.find(ModelFileWriter::makeTag(code));
+        if (it == sections.end() || it->second.elementSize != sizeof(T)) return nullptr;
+        count = it->second.size / sizeof(T);
+        return reinterpret_cast<const T*>(base + it->second.offset);
+    }
+    
+    /**
+     * Decode a string list section
+     * @return false if missing or malformed
+     */
+    bool strings(const char* code, std::vector<std::string>& out) const;
+};
+
+/**
+ * Hashing trick for token features
+ * 
+ * Tokens hash (64-bit FNV-1a with a final mix) straight to one of 2^bits
+ * buckets, so the feature space is fixed whatever the corpus size and no
+ * string vocabulary is kept. N-grams hash from their token hashes without
+ * building strings. The sign comes from the top hash bit, independent of
+ * the bucket bits, so collisions cancel in expectation for linear models.
+ */
+struct FeatureHasher {
+    static constexpr int kMaxBits = 30;
+    
+    int bits;                       // log2 of the bucket count; 0 = disabled
+    int ngramOrder;                 // Longest n-gram hashed (1 = unigrams only)
+    
+    FeatureHasher(int bits = 0, int ngramOrder = 1)
+        : bits(std::max(0, std::min(bits, kMaxBits))), ngramOrder(std::max(1, ngramOrder)) {}
+    
+    bool isEnabled() const { return bits > 0; }
+    uint32_t getBucketCount() const { return bits > 0 ? (1u << bits) : 0; }
+    uint32_t bucket(uint64_t hash) const { return static_cast<uint32_t>(hash & (getBucketCount() - 1)); }
+    static float sign(uint64_t hash) { return (hash >> 63) ? -1.0f : 1.0f; }
+    
+    static uint64_t hashToken(const std::string& token);
+    
+    /**
+     * Order-sensitive hash of a token followed by an (n-1)-gram
+     */
+    static uint64_t combine(uint64_t first, uint64_t rest);
+    
+    /**
+     * Append the buckets of every 1..ngramOrder-gram of a token sequence
+     * @param tokenHashes hashToken() of each token, in order
+     * @param buckets Receives bucket indices (appended)
+     * @param signs Receives ±1 per bucket when not null (appended)
+     */
+    void hashSequence(const uint64_t* tokenHashes, size_t count,
+                      std::vector<uint32_t>& buckets, std::vector<float>* signs = nullptr) const;
+};
+
 /**
  * Multinomial Naive Bayes Classifier
  * 
  * Fast text baseline classifier using Bayes' theorem:
  * P(class|features) ∝ P(class) × ∏ P(feature|class)
+ * 
+ * Tokens are mapped to dense term IDs and log-probabilities are kept in
+ * separable form: a term-major matrix of log(count + α) numerators (one row
+ * of classStride values per term, plus a final row of log α for unseen
+ * tokens) and one log denominator per class. Scoring a document is a
+ * gather-and-sum of rows minus tokens × log denominator, and absorbing a
+ * labeled document only touches its own rows and the per-class terms.
+ * 
+ * Counts are stored unscaled and multiplied by countScale, so decay is O(1);
+ * the numerators are then recomputed lazily by the next prediction.
  */
 class NaiveBayesClassifier {
 private:
-    // P(class) - prior probability of each class
-    std::unordered_map<std::string, double> classPriors;
+    // Class index (ID = position in classNames)
+    std::vector<std::string> classNames;
+    std::unordered_map<std::string, int> classIds;
     
-    // P(feature|class) - likelihood of feature given class
-    std::unordered_map<std::string, std::unordered_map<std::string, double>> featureLikelihoods;
+    // Vocabulary: token -> term ID (empty in feature hashing mode, where
+    // term IDs are hash buckets)
+    std::unordered_map<std::string, uint32_t> vocabulary;
+    FeatureHasher hasher;
     
-    // Vocabulary and class statistics
-    std::unordered_set<std::string> vocabulary;
-    std::unordered_map<std::string, int> classDocCounts;
-    std::unordered_map<std::string, std::unordered_map<std::string, int>> featureCounts;
+    // Training counts (effective count = stored × countScale)
+    std::vector<double> classDocCounts;                 // by class
+    std::vector<double> classTokenTotals;               // by class
+    std::vector<std::vector<double>> featureCounts;     // by class, then term
+    double countScale;
+    
+    // Precomputed log-probabilities (refreshed lazily by const predictions)
+    mutable std::vector<double> logPriors;          // classStride entries
+    mutable std::vector<double> logDenominators;    // log(count(class) + α|V|), classStride entries
+    mutable std::vector<double> logNumerators;      // (|V| + 1) × classStride; last row = unseen
+    mutable size_t classStride;                     // classes rounded up to a multiple of 4
+    
+    // Set by decay or a new class; cleared by the next prediction
+    mutable std::atomic<bool> likelihoodsStale;
+    mutable std::mutex likelihoodMutex;
     
     int totalDocuments;
     double smoothingAlpha;  // Laplace smoothing parameter
     
     bool isTrained;
     
+    // Loaded models read the numerator matrix in place from the file; the
+    // first update copies it out and rebuilds counts from the log tables
+    std::shared_ptr<const MappedModelFile> mappedModel;
+    const double* mappedNumerators;
+    double mappedDocumentWeight;    // Sum of effective class document counts
+    
     // Helper methods
-    double calculateLogProbability(const std::vector<std::string>& tokens,
-                                   const std::string& className) const;
+    void resetModel();
+    void detachMappedModel();
+    size_t termCount() const {
+        return hasher.isEnabled() ? hasher.getBucketCount() : vocabulary.size();
+    }
+    
+    // Helper: hashed term IDs of one dataset row, from per-term token hashes
+    void hashRowTerms(const Dataset& data, uint32_t row, const std::vector<uint64_t>& termHashes,
+                      std::vector<uint64_t>& tokenHashes, std::vector<uint32_t>& termIds) const;
+    const double* numeratorTable() const {
+        return mappedNumerators ? mappedNumerators : logNumerators.data();
+    }
+    void addDocument(const FeatureVector& features, bool updateLikelihoods);
+    void updateClassTerms() const;
+    void computeLogLikelihoods() const;
+    void refreshLikelihoods() const;
+    
+    /**
+     * Sum log prior and token rows for one document
+     * @param out Receives classStride accumulated log-probabilities
+     */
+    void accumulateLogProbabilities(const uint32_t* termIds, size_t count, double* out) const;
+    
+    ClassificationResult resultFromLogProbabilities(const double* logProbs) const;
     
 public:
     /**
@@ -89,12 +385,52 @@ public:
      */
     NaiveBayesClassifier(double alpha = 1.0);
     
+    NaiveBayesClassifier(const NaiveBayesClassifier&) = delete;
+    NaiveBayesClassifier& operator=(const NaiveBayesClassifier&) = delete;
+    
     /**
-     * Train the classifier
+     * Switch between a string vocabulary and feature hashing
+     * With hashing, tokens (and n-grams up to ngramOrder) count into 2^bits
+     * buckets: model memory is fixed and |V| in the smoothing denominator
+     * is the bucket count. Discards the current model.
+     * @param bits log2 of the bucket count (0 = string vocabulary)
+     * @param ngramOrder Longest n-gram hashed (default: unigrams)
+     */
+    void setFeatureHashing(int bits, int ngramOrder = 1);
+    
+    const FeatureHasher& getFeatureHasher() const { return hasher; }
+    
+    /**
+     * Train the classifier from scratch
      * @param features Vector of feature vectors with labels
      */
     void train(const std::vector<FeatureVector>& features);
     
+    /**
+     * Train from scratch on dataset rows
+     * Term and class IDs are assigned in order of first appearance in rows.
+     * @param data Columnar dataset
+     * @param rows Rows to train on (all rows when omitted)
+     */
+    void train(const Dataset& data);
+    void train(const Dataset& data, const std::vector<uint32_t>& rows);
+    
+    /**
+     * Absorb labeled documents into the current model
+     * Updates counts and only the affected log-likelihood entries; new
+     * classes trigger a full refresh at the next prediction.
+     * @param features Feature vectors with labels
+     */
+    void partialFit(const std::vector<FeatureVector>& features);
+    void partialFit(const FeatureVector& features);
+    
+    /**
+     * Multiply all counts by factor to age out older documents (concept drift)
+     * O(1); likelihoods are recomputed by the next prediction.
+     * @param factor Decay factor in (0, 1]
+     */
+    void decayCounts(double factor);
+    
     /**
      * Predict class for a feature vector
      * @param features Feature vector to classify
@@ -110,6 +446,72 @@ public:
     std::unordered_map<std::string, double> predictProbabilities(
         const FeatureVector& features) const;
     
+    /**
+     * Map tokens to term IDs; unseen tokens map to getUnseenTermId()
+     * In hashing mode the IDs are buckets of all configured n-grams.
+     */
+    void encodeTokens(const std::vector<std::string>& tokens, std::vector<uint32_t>& termIds) const;
+    
+    uint32_t getUnseenTermId() const { return static_cast<uint32_t>(termCount()); }
+    
+    /**
+     * Term ID of one token (its unigram bucket in hashing mode), or getUnseenTermId()
+     */
+    uint32_t lookupTerm(const std::string& token) const {
+        if (hasher.isEnabled()) return hasher.bucket(FeatureHasher::hashToken(token));
+        auto it = vocabulary.find(token);
+        return it != vocabulary.end() ? it->second : getUnseenTermId();
+    }
+    
+    /**
+     * Batch log-probabilities over CSR-encoded documents
+     * Document d owns termIds[docOffsets[d], docOffsets[d + 1]).
+     * Rows are summed with AVX2 when available, in the same order as predict().
+     * @param numDocs Number of documents
+     * @param logProbs Receives numDocs × getClassCount() unnormalized log-probabilities
+     */
+    void scoreBatch(const uint32_t* termIds, const size_t* docOffsets,
+                    size_t numDocs, double* logProbs) const;
+    
+    /**
+     * Predict a batch of feature vectors
+     * @param features Feature vectors to classify
+     * @return One classification result per input, in order
+     */
+    std::vector<ClassificationResult> predictBatch(const std::vector<FeatureVector>& features) const;
+    
+    /**
+     * Predict dataset rows; each distinct dataset term is looked up once
+     * @param data Columnar dataset
+     * @param rows Rows to classify
+     * @return One classification result per row, in order
+     */
+    std::vector<ClassificationResult> predictBatch(const Dataset& data,
+                                                   const std::vector<uint32_t>& rows) const;
+    
+    /**
+     * Most probable class and its probability for CSR-encoded documents
+     * @param classIds Receives numDocs class IDs (-1 when untrained)
+     * @param confidences Receives numDocs probabilities
+     */
+    void predictCompact(const uint32_t* termIds, const size_t* docOffsets, size_t numDocs,
+                        int32_t* classIds, double* confidences) const;
+    
+    size_t getClassCount() const { return classNames.size(); }
+    const std::string& getClassName(size_t classId) const { return classNames[classId]; }
+    
+    /**
+     * Add vocabulary, class names and log-probability tables to a model file
+     */
+    void serialize(ModelFileWriter& writer) const;
+    
+    /**
+     * Replace this model with the one stored in a model file
+     * The numerator matrix stays in the file until the model is updated.
+     * @return false (model unchanged) if sections are missing or inconsistent
+     */
+    bool deserialize(const std::shared_ptr<const MappedModelFile>& file);
+    
     /**
      * Check if model is trained
      */
@@ -123,48 +525,87 @@ public:
 
 /**
  * Decision Tree Node (for Random Forest)
+ * 
+ * Trees are stored as a contiguous array of these. Siblings are adjacent:
+ * a sample goes to leftChild when value <= threshold and to leftChild + 1
+ * otherwise. A leaf points at itself with an infinite threshold, so
+ * traversal can step every sample of a batch a fixed number of levels
+ * without branching on leaf/internal.
  */
 struct DecisionTreeNode {
-    bool isLeaf;
-    std::string featureName;        // Feature to split on
-    double threshold;                // Split threshold
-    std::string label;              // Label if leaf node
-    double confidence;              // Confidence at leaf
+    int32_t feature;                // Feature index to split on (0 at leaves)
+    float threshold;                // Split threshold
+    int32_t leftChild;              // Index of left child (own index at leaves)
+    int32_t classId;                // Class if leaf node (-1 when no samples)
+    float confidence;               // Confidence at leaf
     
-    std::shared_ptr<DecisionTreeNode> leftChild;   // <= threshold
-    std::shared_ptr<DecisionTreeNode> rightChild;  // > threshold
+    bool isLeaf(int32_t index) const { return leftChild == index; }
+};
+
+/**
+ * Quantile-binned feature matrix for histogram split finding
+ * 
+ * Each feature's values map to at most kMaxBins bins through ascending cut
+ * points: bin b holds values in (cuts[b-1], cuts[b]], so the bin split
+ * "bin <= b" is exactly the value split "value <= cuts[b]". Labels are
+ * stored as dense class IDs.
+ */
+struct BinnedFeatureMatrix {
+    static constexpr int kMaxBins = 256;
+    
+    std::vector<std::string> featureNames;
+    std::vector<std::vector<double>> cutPoints;     // per feature, ascending
+    std::vector<std::vector<uint8_t>> bins;         // per feature, per sample
+    std::vector<int> labels;                        // per sample class ID
+    std::vector<std::string> classNames;
+    
+    /**
+     * Bin every feature column of a dataset
+     * @param maxBins Bins per feature, at most kMaxBins
+     */
+    void build(const Dataset& data, int maxBins = kMaxBins);
     
-    DecisionTreeNode() : isLeaf(false), threshold(0.0), confidence(0.0) {}
+    size_t getSampleCount() const { return labels.size(); }
+    size_t getBinCount(size_t feature) const { return cutPoints[feature].size() + 1; }
 };
 
 /**
  * Decision Tree Classifier
  * 
- * Binary decision tree for classification
+ * Binary decision tree for classification. Splits are found LightGBM-style:
+ * per node, class counts are accumulated into one histogram per feature
+ * and every bin boundary is scored in a single sweep.
  */
 class DecisionTree {
 private:
-    std::shared_ptr<DecisionTreeNode> root;
+    std::vector<DecisionTreeNode> nodes;    // nodes[0] is the root
+    std::vector<std::string> featureNames;  // Feature index -> name
+    std::vector<std::string> classNames;    // Class ID -> label
     int maxDepth;
     int minSamplesSplit;
     int currentDepth;
     
-    // Helper methods
-    std::shared_ptr<DecisionTreeNode> buildTree(
-        const std::vector<FeatureVector>& samples,
-        const std::vector<std::string>& featureNames,
-        int depth);
-    
-    double calculateGini(const std::vector<std::string>& labels) const;
+    struct SplitCandidate {
+        int feature;            // -1 when no split improves Gini
+        int bin;                // samples with bin <= this go left
+        double giniGain;
+    };
     
-    std::pair<std::string, double> findBestSplit(
-        const std::vector<FeatureVector>& samples,
-        const std::vector<std::string>& featureNames) const;
+    // Helper methods
+    void buildTree(const BinnedFeatureMatrix& data,
+                   const std::vector<int>& features,
+                   uint32_t* indices,
+                   size_t count,
+                   int depth,
+                   int32_t nodeIndex);
     
-    std::string getMajorityClass(const std::vector<FeatureVector>& samples) const;
+    static double calculateGini(const int* classCounts, size_t numClasses, size_t total);
     
-    ClassificationResult traverse(const FeatureVector& features,
-                                 std::shared_ptr<DecisionTreeNode> node) const;
+    SplitCandidate findBestSplit(const BinnedFeatureMatrix& data,
+                                 const std::vector<int>& features,
+                                 const uint32_t* indices,
+                                 size_t count,
+                                 const std::vector<int>& classCounts) const;
     
 public:
     /**
@@ -182,6 +623,15 @@ public:
     void train(const std::vector<FeatureVector>& features,
               const std::vector<std::string>& featureNames);
     
+    /**
+     * Train on pre-binned data
+     * @param data Binned features and labels
+     * @param sampleIndices Rows of data to train on (repeats allowed)
+     * @param features Feature indices to consider for splits
+     */
+    void train(const BinnedFeatureMatrix& data, std::vector<uint32_t> sampleIndices,
+               const std::vector<int>& features);
+    
     /**
      * Predict class for a feature vector
      * @param features Feature vector to classify
@@ -189,10 +639,53 @@ public:
      */
     ClassificationResult predict(const FeatureVector& features) const;
     
+    /**
+     * Predict the class ID of one dense row
+     * @param row Feature values indexed like getFeatureNames()
+     * @return Class ID (-1 for an untrained tree or empty leaf)
+     */
+    int32_t predictClass(const float* row) const {
+        if (nodes.empty()) return -1;
+        int32_t index = 0;
+        while (!nodes[index].isLeaf(index)) {
+            const DecisionTreeNode& node = nodes[index];
+            index = node.leftChild + (row[node.feature] > node.threshold);
+        }
+        return nodes[index].classId;
+    }
+    
+    /**
+     * Predict class IDs for many rows at once. Rows are walked in blocks,
+     * level by level, so loads for different samples overlap.
+     * @param columns columns[f] points at numRows values of feature f
+     * @param numRows Number of rows
+     * @param classIds Output, one class ID per row
+     */
+    void predictColumns(const float* const* columns, size_t numRows, int32_t* classIds) const;
+    
+    const std::vector<std::string>& getFeatureNames() const { return featureNames; }
+    const std::vector<std::string>& getClassNames() const { return classNames; }
+    const std::vector<DecisionTreeNode>& getNodes() const { return nodes; }
+    
+    /**
+     * Replace the tree with a stored node array
+     * Nodes are checked so traversal stays in bounds: children come after
+     * their parent, feature and class IDs are in range.
+     * @return false (tree unchanged) if the nodes are malformed
+     */
+    bool loadNodes(const DecisionTreeNode* source, size_t count,
+                   const std::vector<std::string>& features,
+                   const std::vector<std::string>& classes);
+    
     /**
      * Get tree depth
      */
     int getDepth() const { return currentDepth; }
+    
+    /**
+     * Get number of nodes (internal and leaf)
+     */
+    size_t getNodeCount() const { return nodes.size(); }
 };
 
 /**
@@ -208,17 +701,30 @@ private:
     int maxDepth;
     int minSamplesSplit;
     double featureSamplingRatio;  // Fraction of features to consider per tree
+    uint64_t randomSeed;          // Tree i draws from an RNG seeded by (randomSeed, i)
+    int numThreads;               // Worker threads (0 = hardware concurrency)
     
     bool isTrained;
     std::vector<std::string> featureNames;
+    std::vector<std::string> classNames;    // Shared class IDs of all trees
+    
+    // Helper: Turn per-class vote counts (classNames.size() + 1 slots, the
+    // last for empty leaves) into a result
+    ClassificationResult resultFromVotes(const int* votes) const;
+    
+    // Helper: Blocked traversal over contiguous columns (one per forest feature);
+    // fn(begin, count, votes) receives count × (classNames.size() + 1) vote counts
+    void forEachVoteBlock(const std::vector<const float*>& columns, size_t numRows,
+                          const std::function<void(size_t, size_t, const int*)>& fn) const;
+    
+    std::vector<ClassificationResult> predictColumnBatch(const std::vector<const float*>& columns,
+                                                         size_t numRows) const;
     
-    // Helper: Create bootstrap sample
-    std::vector<FeatureVector> createBootstrapSample(
-        const std::vector<FeatureVector>& features) const;
+    // Helper: Create bootstrap sample (row indices drawn with replacement)
+    std::vector<uint32_t> createBootstrapSample(size_t numRows, std::mt19937_64& gen) const;
     
-    // Helper: Sample features for tree
-    std::vector<std::string> sampleFeatures(
-        const std::vector<std::string>& allFeatures) const;
+    // Helper: Sample feature indices for tree
+    std::vector<int> sampleFeatures(size_t numFeatures, std::mt19937_64& gen) const;
     
 public:
     /**
@@ -227,9 +733,24 @@ public:
      * @param maxDepth Maximum depth per tree (default: 10)
      * @param minSamples Minimum samples to split (default: 2)
      * @param featureRatio Fraction of features per tree (default: 0.7)
+     * @param seed Base seed; the same seed and data give the same forest
+     *             regardless of thread count (default: 42)
+     * @param threads Worker threads for training and batch prediction (0 = all cores)
      */
     RandomForestClassifier(int numTrees = 10, int maxDepth = 10,
-                          int minSamples = 2, double featureRatio = 0.7);
+                          int minSamples = 2, double featureRatio = 0.7,
+                          uint64_t seed = 42, int threads = 0);
+    
+    void setSeed(uint64_t seed) { randomSeed = seed; }
+    void setNumThreads(int threads) { numThreads = threads; }
+    
+    /**
+     * Untrained forest with the same parameters, seed and thread count
+     */
+    RandomForestClassifier withSameParameters() const {
+        return RandomForestClassifier(numTrees, maxDepth, minSamplesSplit, featureSamplingRatio,
+                                      randomSeed, numThreads);
+    }
     
     /**
      * Train the random forest
@@ -237,6 +758,19 @@ public:
      */
     void train(const std::vector<FeatureVector>& features);
     
+    /**
+     * Train the random forest on a columnar dataset
+     * Features are binned once and shared by all trees.
+     */
+    void train(const Dataset& data);
+    
+    /**
+     * Train on a subset of pre-binned rows (e.g. the training part of a fold)
+     * @param data Binned features and labels
+     * @param rows Rows to bootstrap from
+     */
+    void train(const BinnedFeatureMatrix& data, const std::vector<uint32_t>& rows);
+    
     /**
      * Predict class for a feature vector
      * @param features Feature vector to classify
@@ -252,6 +786,49 @@ public:
     std::unordered_map<std::string, double> predictProbabilities(
         const FeatureVector& features) const;
     
+    /**
+     * Predict a batch of feature vectors, split across worker threads
+     * @param features Feature vectors to classify
+     * @return One classification result per input, in order
+     */
+    std::vector<ClassificationResult> predictBatch(const std::vector<FeatureVector>& features) const;
+    
+    /**
+     * Predict every row of a dataset with blocked tree traversal
+     * @param data Rows to classify; features are matched by name, absent ones read as zero
+     * @return One classification result per row, in order
+     */
+    std::vector<ClassificationResult> predictBatch(const Dataset& data) const;
+    
+    /**
+     * Predict selected dataset rows (gathered into contiguous columns first)
+     */
+    std::vector<ClassificationResult> predictBatch(const Dataset& data,
+                                                   const std::vector<uint32_t>& rows) const;
+    
+    /**
+     * Most-voted class and its vote share for rows in contiguous columns
+     * @param columns columns[f] points at numRows values of getFeatureNames()[f]
+     * @param classIds Receives numRows class IDs (-1 for empty leaves or untrained)
+     * @param confidences Receives numRows vote shares
+     */
+    void predictCompact(const std::vector<const float*>& columns, size_t numRows,
+                        int32_t* classIds, double* confidences) const;
+    
+    const std::vector<std::string>& getFeatureNames() const { return featureNames; }
+    const std::vector<std::string>& getClassNames() const { return classNames; }
+    
+    /**
+     * Add forest parameters, names and all tree node arrays to a model file
+     */
+    void serialize(ModelFileWriter& writer) const;
+    
+    /**
+     * Replace this forest with the one stored in a model file
+     * @return false (forest unchanged) if sections are missing or malformed
+     */
+    bool deserialize(const MappedModelFile& file);
+    
     /**
      * Check if model is trained
      */
@@ -298,6 +875,17 @@ public:
      */
     std::unordered_map<std::string, double> getWeights() const { return weights; }
     
+    /**
+     * Add model names and weights to a model file
+     */
+    void serialize(ModelFileWriter& writer) const;
+    
+    /**
+     * Replace weights with those stored in a model file
+     * @return false (weights unchanged) if sections are missing or malformed
+     */
+    bool deserialize(const MappedModelFile& file);
+    
     bool isModelTrained() const { return isTrained; }
 };
 
@@ -318,9 +906,18 @@ private:
     std::string ensembleStrategy;  // "voting", "weighted", "stacking"
     bool useNaiveBayes;
     bool useRandomForest;
+    int stackingFolds;             // Folds for out-of-fold meta-learner training
     
     bool isTrained;
     
+    /**
+     * Train the meta learner on out-of-fold base predictions
+     * Rows are split into stackingFolds index views; every (fold, model)
+     * pair trains a fresh base model on the other folds in parallel and
+     * predicts the held-out rows.
+     */
+    void trainMetaLearner(const Dataset& data, const BinnedFeatureMatrix& bins);
+    
 public:
     /**
      * Constructor
@@ -335,12 +932,30 @@ public:
      */
     void configureModels(bool useNB, bool useRF);
     
+    /**
+     * Set the number of folds used to train the stacking meta learner
+     * @param folds Fold count (default: 5; fewer than 2 predicts in-sample)
+     */
+    void setStackingFolds(int folds) { stackingFolds = folds; }
+    
+    /**
+     * Use feature hashing for the Naive Bayes text model (takes effect at the next train)
+     * @param bits log2 of the bucket count (0 = string vocabulary)
+     * @param ngramOrder Longest n-gram hashed
+     */
+    void setFeatureHashing(int bits, int ngramOrder = 1) { naiveBayes.setFeatureHashing(bits, ngramOrder); }
+    
     /**
      * Train all base models and meta learner
      * @param features Training feature vectors with labels
      */
     void train(const std::vector<FeatureVector>& features);
     
+    /**
+     * Train all base models and meta learner on a columnar dataset
+     */
+    void train(const Dataset& data);
+    
     /**
      * Predict using ensemble
      * @param features Feature vector to classify
@@ -348,6 +963,18 @@ public:
      */
     EnsemblePrediction predict(const FeatureVector& features) const;
     
+    /**
+     * Classify many proposals at once
+     * Features go straight from each proposal into batch buffers (numeric
+     * columns and Naive Bayes term IDs) and both models run their batch
+     * paths, without per-proposal FeatureVectors or result maps. Labels and
+     * confidences match predict() on the extracted features, up to float
+     * rounding and tie order.
+     * @param proposals Proposals to classify
+     * @return Class table and one compact prediction per proposal, in order
+     */
+    EnsembleBatchResult predictBatch(const std::vector<std::shared_ptr<Proposal>>& proposals) const;
+    
     /**
      * Get predictions from individual models
      * @param features Feature vector to classify
@@ -371,6 +998,23 @@ public:
     std::map<std::pair<std::string, std::string>, int> getConfusionMatrix(
         const std::vector<FeatureVector>& testFeatures) const;
     
+    /**
+     * Save strategy, base models and meta weights to a binary model file
+     * @param path Output file
+     * @return false if the file could not be written
+     */
+    bool saveModel(const std::string& path) const;
+    
+    /**
+     * Load a model written by saveModel()
+     * The file is memory-mapped and its tables are used in place, so loading
+     * costs little more than building the vocabulary hash map.
+     * @param path Model file
+     * @param verifyChecksum Hash the whole file before trusting it
+     * @return false if the file is missing, corrupt or of another version
+     */
+    bool loadModel(const std::string& path, bool verifyChecksum = true);
+    
     /**
      * Get ensemble statistics
      */
@@ -405,6 +1049,30 @@ public:
         const std::vector<std::shared_ptr<Proposal>>& proposals,
         const std::vector<std::string>& labels = {});
     
+    /**
+     * Numeric features of a proposal
+     * @param values Receives one value per getFeatureNames() entry, in that order
+     */
+    static void extractNumericFeatures(const Proposal& proposal, double* values);
+    
+    /**
+     * Lowercase whitespace tokens of title and description, as in
+     * extractFeatures(), passed through one reused buffer
+     * @param onToken Called once per token
+     */
+    static void forEachToken(const Proposal& proposal,
+                             const std::function<void(const std::string&)>& onToken);
+    
+    /**
+     * Hashed text features: one bucket index and ±1 value per token and
+     * n-gram (repeats are kept, so they add up in sparse dot products)
+     * @param hasher Bucket count and n-gram order
+     * @param indices Receives bucket indices
+     * @param values Receives signed values
+     */
+    static void extractHashedFeatures(const Proposal& proposal, const FeatureHasher& hasher,
+                                      std::vector<uint32_t>& indices, std::vector<float>& values);
+    
     /**
      * Get feature names
      * @return Vector of feature names
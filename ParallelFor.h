@@ -0,0 +1,157 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+
+/**
+ * Worker count for splitting count items into ranges of grain items
+ * @param numThreads Requested threads (<= 0: hardware concurrency)
+ * @return Between 1 and the number of ranges
+ */
+inline int parallelWorkerCount(int numThreads, size_t count, size_t grain) {
+    if (numThreads <= 0) {
+        numThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    size_t ranges = (count + std::max<size_t>(1, grain) - 1) / std::max<size_t>(1, grain);
+    return static_cast<int>(std::max<size_t>(1, std::min<size_t>(numThreads, ranges)));
+}
+
+/**
+ * Threads kept alive across parallel loops
+ * 
+ * run() executes fn(worker) on every worker, the calling thread being
+ * worker 0, and returns once all of them have finished. If fn throws, the
+ * first exception is rethrown from run() after every worker has finished.
+ * Keep one pool for loops that repeat many times (e.g. once per mini-batch)
+ * so threads are not respawned each time.
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(int count) : task(nullptr), generation(0), pending(0), stopping(false) {
+        for (int w = 1; w < count; ++w) {
+            threads.emplace_back([this, w] { workerLoop(w); });
+        }
+    }
+    
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    
+    size_t size() const { return threads.size() + 1; }
+    
+    void run(const std::function<void(size_t)>& fn) {
+        if (threads.empty()) {
+            fn(0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            task = &fn;
+            pending = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        
+        // The workers hold a pointer to fn, so wait for them even if worker 0 throws
+        std::exception_ptr error;
+        try {
+            fn(0);
+        } catch (...) {
+            error = std::current_exception();
+        }
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return pending == 0; });
+        if (!error) error = workerError;
+        workerError = nullptr;
+        if (error) std::rethrow_exception(error);
+    }
+    
+    /**
+     * Run fn(begin, end, worker) over [0, count). Ranges of grain items are
+     * handed out dynamically, so uneven items balance across workers.
+     */
+    void parallelFor(size_t count, size_t grain,
+                     const std::function<void(size_t, size_t, size_t)>& fn) {
+        grain = std::max<size_t>(1, grain);
+        std::atomic<size_t> next(0);
+        run([&](size_t worker) {
+            for (size_t begin = next.fetch_add(grain); begin < count; begin = next.fetch_add(grain)) {
+                fn(begin, std::min(count, begin + grain), worker);
+            }
+        });
+    }
+
+private:
+    void workerLoop(size_t worker) {
+        size_t seen = 0;
+        while (true) {
+            const std::function<void(size_t)>* current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                current = task;
+            }
+            std::exception_ptr error;
+            try {
+                (*current)(worker);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (error && !workerError) workerError = error;
+                if (--pending == 0) finished.notify_one();
+            }
+        }
+    }
+    
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    const std::function<void(size_t)>* task;
+    std::exception_ptr workerError;     // first exception thrown by a worker thread
+    size_t generation;
+    size_t pending;
+    bool stopping;
+};
+
+/**
+ * Run fn(begin, end) over [0, count) on up to numThreads threads
+ * (<= 0: hardware concurrency), handing out ranges of grain items.
+ * Runs inline when there is only one range.
+ */
+inline void parallelFor(size_t count, int numThreads, size_t grain,
+                        const std::function<void(size_t, size_t)>& fn) {
+    int workers = parallelWorkerCount(numThreads, count, grain);
+    if (workers <= 1) {
+        fn(0, count);
+        return;
+    }
+    
+    WorkerPool pool(workers);
+    pool.parallelFor(count, grain, [&](size_t begin, size_t end, size_t) { fn(begin, end); });
+}
+
+#endif // PARALLEL_FOR_H
@@ -0,0 +1,69 @@
+#include "StringInterner.h"
+#include <functional>
+
+// ==================== String Interner Implementation ====================
+
+static const size_t kMinTableSize = 16;
+
+size_t StringInterner::probe(std::string_view name, size_t hash) const {
+    size_t mask = table.size() - 1;
+    size_t pos = hash & mask;
+    while (table[pos] != kEmpty && view(table[pos] - 1) != name) {
+        pos = (pos + 1) & mask;
+    }
+    return pos;
+}
+
+void StringInterner::grow() {
+    std::vector<uint32_t> old;
+    old.swap(table);
+    table.assign(old.empty() ? kMinTableSize : old.size() * 2, kEmpty);
+    
+    size_t mask = table.size() - 1;
+    for (uint32_t slot : old) {
+        if (slot == kEmpty) continue;
+        size_t pos = std::hash<std::string_view>()(view(slot - 1)) & mask;
+        while (table[pos] != kEmpty) {
+            pos = (pos + 1) & mask;
+        }
+        table[pos] = slot;
+    }
+}
+
+uint32_t StringInterner::intern(const std::string& name) {
+    // Keep the table at most 3/4 full so probe runs stay short
+    if ((size() + 1) * 4 > table.size() * 3) {
+        grow();
+    }
+    
+    size_t hash = std::hash<std::string_view>()(name);
+    size_t pos = probe(name, hash);
+    if (table[pos] != kEmpty) return table[pos] - 1;
+    
+    uint32_t id = static_cast<uint32_t>(size());
+    arena.append(name);
+    offsets.push_back(static_cast<uint32_t>(arena.size()));
+    table[pos] = id + 1;
+    return id;
+}
+
+bool StringInterner::find(const std::string& name, uint32_t& id) const {
+    if (table.empty()) return false;
+    
+    size_t pos = probe(name, std::hash<std::string_view>()(name));
+    if (table[pos] == kEmpty) return false;
+    id = table[pos] - 1;
+    return true;
+}
+
+size_t StringInterner::memoryBytes() const {
+    return arena.capacity() +
+           offsets.capacity() * sizeof(uint32_t) +
+           table.capacity() * sizeof(uint32_t);
+}
+
+void StringInterner::clear() {
+    arena.clear();
+    offsets.assign(1, 0);
+    table.clear();
+}
@@ -0,0 +1,51 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+/**
+ * Maps strings to dense 32-bit ids so indexes store each string once
+ * 
+ * Names are packed back to back in one arena and found through an
+ * open-addressing table of ids, so an interned name costs its characters
+ * plus about 10 bytes instead of a hash node and a second std::string.
+ * Ids are never recycled; clear() drops everything.
+ */
+class StringInterner {
+private:
+    std::string arena;                  // all names back to back
+    std::vector<uint32_t> offsets;      // id -> start in arena; one extra end offset
+    std::vector<uint32_t> table;        // linear probing, id + 1 (0 = empty)
+    
+    static constexpr uint32_t kEmpty = 0;
+    
+    std::string_view view(uint32_t id) const {
+        return std::string_view(arena.data() + offsets[id], offsets[id + 1] - offsets[id]);
+    }
+    
+    /**
+     * Table position holding name, or the empty position where it belongs
+     */
+    size_t probe(std::string_view name, size_t hash) const;
+    void grow();
+    
+public:
+    StringInterner() : offsets(1, 0) {}
+    
+    uint32_t intern(const std::string& name);
+    bool find(const std::string& name, uint32_t& id) const;
+    std::string lookup(uint32_t id) const { return std::string(view(id)); }
+    size_t size() const { return offsets.size() - 1; }
+    
+    /**
+     * Heap bytes held by the arena, offsets and table
+     */
+    size_t memoryBytes() const;
+    
+    void clear();
+};
+
+#endif // STRING_INTERNER_H
@@ -0,0 +1,1099 @@
+#include "AntiAbuseEngine.h"
+#include "ConsistencyScorer.h"
+#include "EnsembleModels.h"
+#include "AdvancedAnalytics.h"
+#include "IntelligenceEngine.h"
+#include "VotingSystem.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <cstdio>
+#include <ctime>
+#include <malloc.h>
+#include <cmath>
+#include <set>
+
+using namespace std;
+
+void printHeader(const string& title) {
+    cout << "\n" << string(70, '=') << "\n";
+    cout << "  " << title << "\n";
+    cout << string(70, '=') << "\n\n";
+}
+
+double elapsedMs(const chrono::steady_clock::time_point& start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// Heap bytes currently allocated (glibc), including mmap'd blocks
+size_t heapBytesInUse() {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+void benchmarkAntiAbuseSharding() {
+    printHeader("ANTI-ABUSE ENGINE: SHARDED INGESTION");
+
+    // Synthetic load: many users spread over many proposals so per-user work
+    // dominates the shared co-voting graph
+    const int numUsers = 20000;
+    const int numProposals = 50000;
+    const int numEvents = 200000;
+
+    mt19937 rng(42);
+    uniform_int_distribution<int> userDist(0, numUsers - 1);
+    uniform_int_distribution<int> proposalDist(0, numProposals - 1);
+
+    struct SyntheticVote {
+        string userId;
+        string proposalId;
+        string ipHash;
+        string deviceHash;
+        chrono::system_clock::time_point timestamp;
+    };
+
+    auto start = chrono::system_clock::now();
+    vector<SyntheticVote> votes;
+    votes.reserve(numEvents);
+    for (int i = 0; i < numEvents; i++) {
+        int user = userDist(rng);
+        votes.push_back({"USER_" + to_string(user),
+                         "PROP_" + to_string(proposalDist(rng)),
+                         "IP_" + to_string(user % 5000),
+                         "DEV_" + to_string(user),
+                         start + chrono::milliseconds(i * 5)});
+    }
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "Events: " << numEvents << ", users: " << numUsers
+         << ", hardware threads: " << cores << "\n\n";
+
+    vector<int> shardCounts = {0, 1, 2, 4, 8, 16};
+    double baselineMs = 0.0;
+    for (int shardCount : shardCounts) {
+        if (shardCount > static_cast<int>(cores) * 2) break;
+
+        AntiAbuseEngine engine(30.0, 200.0, 60, shardCount);
+        auto t0 = chrono::steady_clock::now();
+        for (const auto& vote : votes) {
+            engine.recordVoteEvent(vote.userId, vote.proposalId, vote.timestamp,
+                                   vote.ipHash, vote.deviceHash);
+        }
+        engine.flush();
+        double ms = elapsedMs(t0);
+        if (shardCount == 0) baselineMs = ms;
+
+        cout << "  Shards: " << setw(6) << (shardCount == 0 ? string("inline") : to_string(shardCount))
+             << "  " << fixed << setprecision(1) << setw(8) << ms << " ms"
+             << "  " << setw(10) << setprecision(0) << numEvents / (ms / 1000.0) << " events/s"
+             << "  speedup " << setprecision(2) << baselineMs / ms << "x\n";
+    }
+}
+
+// CPU time consumed by the calling thread
+double threadCpuMs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+void benchmarkCoVotePartitioning() {
+    printHeader("CO-VOTING GRAPH: UPDATES PARTITIONED BY PROPOSAL");
+
+    // Hot proposals make every vote touch ~15 earlier voters, which is the
+    // part of ingestion that the cross-user partitions spread out
+    const int numUsers = 20000;
+    const int numProposals = 2000;
+    const int numEvents = 60000;
+
+    mt19937 rng(43);
+    uniform_int_distribution<int> userDist(0, numUsers - 1);
+    uniform_int_distribution<int> proposalDist(0, numProposals - 1);
+
+    vector<pair<string, string>> votes;
+    votes.reserve(numEvents);
+    for (int i = 0; i < numEvents; i++) {
+        votes.emplace_back("USER_" + to_string(userDist(rng)), "PROP_" + to_string(proposalDist(rng)));
+    }
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "Events: " << numEvents << ", proposals: " << numProposals
+         << ", hardware threads: " << cores << "\n";
+    cout << "Critical path = busiest partition's CPU time; it bounds the speedup\n"
+         << "with one core per partition.\n\n";
+
+    double singleCpuMs = 0.0;
+    for (int partitions : {1, 2, 4, 8}) {
+        CoVotingGraph graph;
+        vector<double> cpuMs(partitions, 0.0);
+
+        auto t0 = chrono::steady_clock::now();
+        vector<thread> workers;
+        for (int p = 0; p < partitions; p++) {
+            workers.emplace_back([&, p]() {
+                double start = threadCpuMs();
+                for (const auto& vote : votes) {
+                    if (static_cast<int>(hash<string>()(vote.second) % partitions) == p) {
+                        graph.addVote(vote.first, vote.second);
+                    }
+                }
+                cpuMs[p] = threadCpuMs() - start;
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double wallMs = elapsedMs(t0);
+
+        double totalCpuMs = 0.0;
+        double criticalMs = 0.0;
+        for (double ms : cpuMs) {
+            totalCpuMs += ms;
+            criticalMs = max(criticalMs, ms);
+        }
+        if (partitions == 1) singleCpuMs = totalCpuMs;
+
+        cout << "  Partitions: " << setw(2) << partitions
+             << "  wall " << fixed << setprecision(1) << setw(8) << wallMs << " ms"
+             << "  CPU " << setw(8) << totalCpuMs << " ms"
+             << "  critical path " << setw(8) << criticalMs << " ms"
+             << "  (" << setprecision(2) << singleCpuMs / criticalMs << "x)\n";
+    }
+}
+
+void benchmarkBatchRanking() {
+    printHeader("CONSISTENCY SCORER: BATCH RANKING");
+
+    const size_t numProposals = 1000000;
+    const size_t topK = 20;
+
+    mt19937 rng(7);
+    uniform_real_distribution<double> dist(0.0, 1.0);
+    vector<double> relevance(numProposals), consistency(numProposals),
+                   trust(numProposals), recency(numProposals), scores(numProposals);
+    for (size_t i = 0; i < numProposals; i++) {
+        relevance[i] = dist(rng);
+        consistency[i] = dist(rng);
+        trust[i] = dist(rng);
+        recency[i] = dist(rng);
+    }
+
+    RankingWeights weights(0.55, 0.25, 0.15, 0.05);
+
+    // Per-proposal scoring through calculateWeightedScore
+    ConsistencyScorer scorer;
+    vector<string> proposalIds(1000), userIds(1000);
+    for (size_t i = 0; i < proposalIds.size(); i++) {
+        proposalIds[i] = "PROP_" + to_string(i);
+        userIds[i] = "USER_" + to_string(i);
+        scorer.recordProposalSimilarity(userIds[i], proposalIds[i], dist(rng), "2024-11-09");
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    double checksum = 0.0;
+    for (size_t i = 0; i < numProposals; i++) {
+        auto score = scorer.calculateWeightedScore(proposalIds[i % 1000], userIds[i % 1000],
+                                                   relevance[i], trust[i], recency[i], weights);
+        checksum += score.finalWeightedScore;
+    }
+    double perCallMs = elapsedMs(t0);
+
+    // Batch path: consistency gathered once per user, then one SoA pass
+    for (size_t i = 0; i < numProposals; i += 1000) {
+        scorer.getConsistencyScores(userIds, consistency.data() + i);
+    }
+
+    t0 = chrono::steady_clock::now();
+    ConsistencyScorer::scoreBatch(relevance.data(), consistency.data(), trust.data(),
+                                  recency.data(), numProposals, weights, scores.data());
+    double batchMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    auto top = ConsistencyScorer::selectTopK(scores.data(), numProposals, topK);
+    double topKMs = elapsedMs(t0);
+
+    cout << "Proposals: " << numProposals << " (checksum " << fixed << setprecision(3)
+         << checksum << ")\n\n";
+    cout << "  calculateWeightedScore loop: " << setprecision(2) << setw(8) << perCallMs << " ms\n";
+    cout << "  scoreBatch:                  " << setw(8) << batchMs << " ms\n";
+    cout << "  selectTopK(" << topK << "):              " << setw(8) << topKMs << " ms"
+         << "  (best " << setprecision(4) << scores[top[0]] << ")\n";
+}
+
+void benchmarkDecayedConsistency() {
+    printHeader("CONSISTENCY SCORER: DECAYED MODE");
+
+    const int numUsers = 1000000;
+    const int numRecords = 5000000;
+
+    mt19937 rng(11);
+    uniform_int_distribution<int> userDist(0, numUsers - 1);
+    uniform_real_distribution<double> dist(0.0, 1.0);
+
+    vector<string> userIds(numUsers);
+    for (int i = 0; i < numUsers; i++) {
+        userIds[i] = "USER_" + to_string(i);
+    }
+    vector<string> days = {"2024-11-01", "2024-11-05", "2024-11-09", "2024-11-13"};
+
+    size_t heapBefore = heapBytesInUse();
+    ConsistencyScorer scorer;
+    scorer.setDecayedScoring(true, 7 * 86400.0);
+
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < numRecords; i++) {
+        scorer.recordProposalSimilarity(userIds[userDist(rng)], "", dist(rng),
+                                        days[i / (numRecords / 4)]);
+    }
+    double recordMs = elapsedMs(t0);
+    double bytesPerUser = static_cast<double>(heapBytesInUse() - heapBefore) / numUsers;
+
+    t0 = chrono::steady_clock::now();
+    size_t high = scorer.getHighConsistencyUsers(0.75).size();
+    size_t low = scorer.getLowConsistencyUsers(0.72).size();
+    double queryMs = elapsedMs(t0);
+
+    cout << "Users: " << numUsers << ", records: " << numRecords
+         << " (state " << sizeof(DecayedConsistencyState) << " bytes/user, "
+         << fixed << setprecision(1) << bytesPerUser << " bytes/user measured)\n\n";
+    cout << "  recordProposalSimilarity: " << fixed << setprecision(2) << setw(8) << recordMs << " ms\n";
+    cout << "  high/low queries:         " << setw(8) << queryMs << " ms"
+         << "  (" << high << " high, " << low << " low)\n";
+}
+
+void benchmarkNaiveBayes() {
+    printHeader("NAIVE BAYES: DENSE LOG-LIKELIHOODS");
+
+    const int numDocs = 1000000;
+    const int tokensPerDoc = 12;
+    const int vocabSize = 20000;
+    const vector<string> labels = {"high_priority", "low_priority", "spam", "duplicate"};
+
+    // Each class favours its own slice of the vocabulary
+    mt19937 rng(5);
+    uniform_int_distribution<int> wordDist(0, vocabSize - 1);
+    vector<string> words(vocabSize);
+    for (int i = 0; i < vocabSize; i++) {
+        words[i] = "w" + to_string(i);
+    }
+
+    vector<FeatureVector> docs(numDocs);
+    for (int d = 0; d < numDocs; d++) {
+        size_t label = d % labels.size();
+        docs[d].groundTruthLabel = labels[label];
+        docs[d].textTokens.reserve(tokensPerDoc);
+        for (int t = 0; t < tokensPerDoc; t++) {
+            int word = wordDist(rng);
+            if (t % 4 == 0) word = (word % (vocabSize / 4)) + label * (vocabSize / 4);
+            docs[d].textTokens.push_back(words[word]);
+        }
+    }
+
+    NaiveBayesClassifier nb(1.0);
+    auto t0 = chrono::steady_clock::now();
+    nb.train(docs);
+    double trainMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    int correct = 0;
+    for (const auto& doc : docs) {
+        correct += nb.predict(doc).label == doc.groundTruthLabel;
+    }
+    double predictMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    auto results = nb.predictBatch(docs);
+    double batchMs = elapsedMs(t0);
+
+    // Scoring only, over pre-encoded CSR term IDs
+    vector<uint32_t> termIds, docTermIds;
+    vector<size_t> offsets = {0};
+    for (const auto& doc : docs) {
+        nb.encodeTokens(doc.textTokens, docTermIds);
+        termIds.insert(termIds.end(), docTermIds.begin(), docTermIds.end());
+        offsets.push_back(termIds.size());
+    }
+    vector<double> logProbs(numDocs * nb.getClassCount());
+    t0 = chrono::steady_clock::now();
+    nb.scoreBatch(termIds.data(), offsets.data(), numDocs, logProbs.data());
+    double scoreMs = elapsedMs(t0);
+
+    // Online updates: absorb documents one at a time into the trained model
+    const int numUpdates = 100000;
+    t0 = chrono::steady_clock::now();
+    for (int d = 0; d < numUpdates; d++) {
+        nb.partialFit(docs[d]);
+    }
+    double partialFitMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    nb.decayCounts(0.9);
+    nb.predict(docs[0]);
+    double decayMs = elapsedMs(t0);
+
+    cout << "Documents: " << numDocs << " x " << tokensPerDoc << " tokens, vocabulary "
+         << vocabSize << ", classes " << nb.getClassCount() << "\n\n";
+    cout << "  train:                  " << fixed << setprecision(1) << setw(8) << trainMs << " ms\n";
+    cout << "  predict loop:           " << setw(8) << predictMs << " ms"
+         << "  (accuracy " << setprecision(3) << static_cast<double>(correct) / numDocs << ")\n";
+    cout << "  predictBatch:           " << setprecision(1) << setw(8) << batchMs << " ms\n";
+    cout << "  scoreBatch (encoded):   " << setw(8) << scoreMs << " ms\n";
+    cout << "  partialFit:             " << setw(8) << partialFitMs * 1000.0 / numUpdates
+         << " us/doc\n";
+    cout << "  decay + lazy refresh:   " << setw(8) << decayMs << " ms\n";
+
+    // Feature hashing: fixed bucket count, no string vocabulary
+    NaiveBayesClassifier hashed(1.0);
+    hashed.setFeatureHashing(15);
+    t0 = chrono::steady_clock::now();
+    hashed.train(docs);
+    double hashedTrainMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    auto hashedResults = hashed.predictBatch(docs);
+    double hashedBatchMs = elapsedMs(t0);
+    int hashedCorrect = 0;
+    for (int d = 0; d < numDocs; d++) {
+        hashedCorrect += hashedResults[d].label == docs[d].groundTruthLabel;
+    }
+
+    cout << "\n  hashed (2^15 buckets)\n";
+    cout << "  train:                  " << setw(8) << hashedTrainMs << " ms\n";
+    cout << "  predictBatch:           " << setw(8) << hashedBatchMs << " ms"
+         << "  (accuracy " << setprecision(3) << static_cast<double>(hashedCorrect) / numDocs << ")\n";
+}
+
+void benchmarkDecisionTree() {
+    printHeader("DECISION TREE: HISTOGRAM SPLITS");
+
+    const int numSamples = 200000;
+    const vector<string> featureNames = {"vote_count", "title_length", "description_length", "age_hours"};
+
+    mt19937 rng(17);
+    normal_distribution<double> dist(0.0, 1.0);
+    auto generate = [&](int count) {
+        vector<FeatureVector> samples(count);
+        for (auto& sample : samples) {
+            double a = dist(rng), b = dist(rng), c = dist(rng), d = dist(rng);
+            sample.features = {{featureNames[0], a}, {featureNames[1], b},
+                               {featureNames[2], c}, {featureNames[3], d}};
+            sample.groundTruthLabel = (a + 0.5 * b * b - 0.3 * c > 0.6) ? "high_priority"
+                                    : (b > 0.8 ? "medium_priority" : "low_priority");
+        }
+        return samples;
+    };
+    auto training = generate(numSamples);
+    auto test = generate(20000);
+
+    DecisionTree tree(10, 2);
+    auto t0 = chrono::steady_clock::now();
+    tree.train(training, featureNames);
+    double trainMs = elapsedMs(t0);
+
+    int correct = 0;
+    for (const auto& sample : test) {
+        correct += tree.predict(sample).label == sample.groundTruthLabel;
+    }
+
+    // Flat-node inference on dense rows: one sample at a time vs blocked columns
+    Dataset testData = Dataset::fromFeatureVectors(test);
+    vector<const float*> columns(featureNames.size());
+    vector<float> rows(test.size() * featureNames.size());
+    for (size_t f = 0; f < featureNames.size(); f++) {
+        const auto& column = testData.columns[testData.featureIndex.at(featureNames[f])];
+        columns[f] = column.data();
+        for (size_t i = 0; i < test.size(); i++) rows[i * featureNames.size() + f] = column[i];
+    }
+    const int rounds = 20;
+    long checksum = 0;
+    t0 = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < test.size(); i++) {
+            checksum += tree.predictClass(&rows[i * featureNames.size()]);
+        }
+    }
+    double singleNs = elapsedMs(t0) * 1e6 / (rounds * test.size());
+
+    vector<int32_t> classIds(test.size());
+    t0 = chrono::steady_clock::now();
+    for (int r = 0; r < rounds; r++) {
+        tree.predictColumns(columns.data(), test.size(), classIds.data());
+        checksum += classIds[r];
+    }
+    double batchNs = elapsedMs(t0) * 1e6 / (rounds * test.size());
+
+    cout << "Samples: " << numSamples << ", features: " << featureNames.size() << "\n\n";
+    cout << "  train:    " << fixed << setprecision(1) << setw(8) << trainMs << " ms"
+         << "  (depth " << tree.getDepth() << ", " << tree.getNodeCount() << " nodes, accuracy "
+         << setprecision(3) << static_cast<double>(correct) / test.size() << ")\n";
+    cout << "  predictClass:   " << setprecision(1) << setw(8) << singleNs << " ns/sample\n";
+    cout << "  predictColumns: " << setw(8) << batchNs << " ns/sample"
+         << "  (checksum " << checksum << ")\n";
+}
+
+void benchmarkRandomForest() {
+    printHeader("RANDOM FOREST: PARALLEL TREES");
+
+    const int numSamples = 100000;
+    const int numTrees = 32;
+    const vector<string> featureNames = {"vote_count", "title_length", "description_length", "age_hours"};
+
+    mt19937 rng(23);
+    normal_distribution<double> dist(0.0, 1.0);
+    vector<FeatureVector> samples(numSamples);
+    for (auto& sample : samples) {
+        double a = dist(rng), b = dist(rng), c = dist(rng), d = dist(rng);
+        sample.features = {{featureNames[0], a}, {featureNames[1], b},
+                           {featureNames[2], c}, {featureNames[3], d}};
+        sample.groundTruthLabel = (a + 0.5 * b * b - 0.3 * c > 0.6) ? "high_priority"
+                                : (b > 0.8 ? "medium_priority" : "low_priority");
+    }
+    Dataset data = Dataset::fromFeatureVectors(samples);
+
+    unsigned cores = max(1u, thread::hardware_concurrency());
+    cout << "Samples: " << numSamples << ", trees: " << numTrees
+         << ", hardware threads: " << cores << "\n\n";
+
+    string referenceLabels;
+    double baselineTrainMs = 0.0, baselinePredictMs = 0.0;
+    for (int threads : {1, 2, 4, 8, 16}) {
+        if (threads > static_cast<int>(cores) * 2) break;
+
+        RandomForestClassifier forest(numTrees, 10, 2, 0.7, 42, threads);
+        auto t0 = chrono::steady_clock::now();
+        forest.train(data);
+        double trainMs = elapsedMs(t0);
+
+        t0 = chrono::steady_clock::now();
+        auto results = forest.predictBatch(samples);
+        double predictMs = elapsedMs(t0);
+
+        // Seeded per-tree RNGs must make the forest independent of thread count
+        string labels;
+        for (size_t i = 0; i < results.size(); i += 97) labels += results[i].label;
+        if (threads == 1) {
+            referenceLabels = labels;
+            baselineTrainMs = trainMs;
+            baselinePredictMs = predictMs;
+        }
+
+        cout << "  Threads: " << setw(3) << threads
+             << "  train " << fixed << setprecision(1) << setw(8) << trainMs << " ms"
+             << " (" << setprecision(2) << baselineTrainMs / trainMs << "x)"
+             << "  predictBatch " << setprecision(1) << setw(8) << predictMs << " ms"
+             << " (" << setprecision(2) << baselinePredictMs / predictMs << "x)"
+             << (labels == referenceLabels ? "" : "  MISMATCH") << "\n";
+    }
+}
+
+void benchmarkModelFile() {
+    printHeader("ENSEMBLE MODEL FILE: SAVE / MMAP LOAD");
+
+    const int numSamples = 100000;
+    const int vocabSize = 200000;
+    mt19937 rng(31);
+    normal_distribution<double> dist(0.0, 1.0);
+    vector<FeatureVector> samples(numSamples);
+    for (auto& sample : samples) {
+        double a = dist(rng), b = dist(rng);
+        sample.features = {{"vote_count", a}, {"age_hours", b}};
+        sample.groundTruthLabel = a > 0.3 ? "high_priority" : (b > 0.0 ? "medium_priority" : "low_priority");
+        for (int k = 0; k < 12; k++) {
+            sample.textTokens.push_back("t" + to_string(rng() % vocabSize));
+        }
+    }
+
+    EnsembleClassifier ensemble("weighted");
+    ensemble.train(samples);
+
+    const string path = "benchmark_model.bin";
+    auto t0 = chrono::steady_clock::now();
+    bool saved = ensemble.saveModel(path);
+    double saveMs = elapsedMs(t0);
+
+    EnsembleClassifier loaded;
+    t0 = chrono::steady_clock::now();
+    bool loadedOk = loaded.loadModel(path);
+    double loadMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    EnsembleClassifier unchecked;
+    unchecked.loadModel(path, false);
+    double uncheckedMs = elapsedMs(t0);
+
+    int mismatches = 0;
+    for (int i = 0; i < 2000; i++) {
+        mismatches += ensemble.predict(samples[i]).finalLabel != loaded.predict(samples[i]).finalLabel;
+    }
+    remove(path.c_str());
+
+    cout << "Samples: " << numSamples << ", vocabulary: ~" << vocabSize << "\n\n";
+    cout << "  save:                 " << fixed << setprecision(1) << setw(8) << saveMs << " ms"
+         << (saved ? "" : "  FAILED") << "\n";
+    cout << "  load (checksummed):   " << setw(8) << loadMs << " ms"
+         << (loadedOk ? "" : "  FAILED") << "\n";
+    cout << "  load (no checksum):   " << setw(8) << uncheckedMs << " ms\n";
+    cout << "  prediction mismatches after reload: " << mismatches << " / 2000\n";
+}
+
+void benchmarkEnsembleBatch() {
+    printHeader("ENSEMBLE: BATCH PROPOSAL CLASSIFICATION");
+
+    const int numProposals = 100000;
+    const int numTraining = 20000;
+    const vector<string> topics = {"park", "library", "road", "school", "transit", "budget",
+                                   "housing", "water", "energy", "safety"};
+    mt19937 rng(37);
+    vector<shared_ptr<Proposal>> proposals;
+    vector<string> labels;
+    proposals.reserve(numProposals);
+    for (int i = 0; i < numProposals; i++) {
+        int topic = rng() % topics.size();
+        string title = "Improve " + topics[topic] + " " + to_string(rng() % 500);
+        string description = "Proposal to fund the " + topics[topic] + " program in district " +
+                             to_string(rng() % 50) + " with community support";
+        auto proposal = make_shared<Proposal>(title, description, "creator");
+        int votes = rng() % 12;
+        for (int v = 0; v < votes; v++) proposal->addVote("voter" + to_string(v));
+        proposals.push_back(proposal);
+        labels.push_back(votes >= 8 || topic < 2 ? "high_priority" : (votes >= 4 ? "medium_priority" : "low_priority"));
+    }
+
+    vector<shared_ptr<Proposal>> trainingProposals(proposals.begin(), proposals.begin() + numTraining);
+    vector<string> trainingLabels(labels.begin(), labels.begin() + numTraining);
+    EnsembleClassifier ensemble("weighted");
+    ensemble.train(ProposalFeatureExtractor::extractBatch(trainingProposals, trainingLabels));
+
+    auto t0 = chrono::steady_clock::now();
+    vector<EnsemblePrediction> single;
+    single.reserve(numProposals);
+    for (const auto& proposal : proposals) {
+        single.push_back(ensemble.predict(ProposalFeatureExtractor::extractFeatures(proposal)));
+    }
+    double singleMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    EnsembleBatchResult batch = ensemble.predictBatch(proposals);
+    double batchMs = elapsedMs(t0);
+
+    int disagreements = 0;
+    for (int i = 0; i < numProposals; i++) {
+        disagreements += single[i].finalLabel != batch.getLabel(i);
+    }
+
+    cout << "Proposals: " << numProposals << "\n\n";
+    cout << "  extract + predict loop: " << fixed << setprecision(1) << setw(8) << singleMs << " ms\n";
+    cout << "  predictBatch:           " << setw(8) << batchMs << " ms  ("
+         << setprecision(1) << singleMs / batchMs << "x, " << disagreements << " label differences)\n";
+}
+
+// Proposals with distinct IDs (generated IDs are random and can repeat). Texts
+// mix a shared vocabulary, numbered rare words, stop words, capitals and
+// punctuation, so tokenization and frequent terms are both exercised.
+vector<shared_ptr<Proposal>> makeTextProposals(size_t count, mt19937& rng) {
+    static const vector<string> common = {"technology", "software", "climate", "green", "school",
+                                          "student", "health", "hospital", "market", "budget",
+                                          "learning", "ai", "digital", "renewable", "transit"};
+    static const vector<string> filler = {"the", "and", "for", "with", "of", "to", "in", "a"};
+
+    set<string> usedIds;
+    vector<shared_ptr<Proposal>> proposals;
+    while (proposals.size() < count) {
+        string title = "Fund " + common[rng() % common.size()] + " " + common[rng() % common.size()];
+        string description;
+        int words = 6 + rng() % 20;
+        for (int w = 0; w < words; w++) {
+            switch (rng() % 4) {
+                case 0: description += filler[rng() % filler.size()]; break;
+                case 1: description += "Item" + to_string(rng() % (count * 2)); break;
+                default: description += common[rng() % common.size()]; break;
+            }
+            description += (rng() % 6 == 0) ? ", " : " ";
+        }
+        auto proposal = make_shared<Proposal>(title, description, "creator");
+        if (!usedIds.insert(proposal->getProposalId()).second) continue;
+        proposals.push_back(proposal);
+    }
+    return proposals;
+}
+
+string proposalText(const shared_ptr<Proposal>& proposal) {
+    return proposal->getTitle() + " " + proposal->getDescription();
+}
+
+void benchmarkCorpusIndex() {
+    printHeader("CORPUS INDEX: INCREMENTAL TF-IDF");
+
+    mt19937 rng(46);
+    vector<shared_ptr<Proposal>> proposals = makeTextProposals(300, rng);
+    DecisionRankingEngine engine;
+    engine.initialize(proposals);
+
+    // The engine's vectors against createTFIDFVector over the same texts; every
+    // fifth proposal, since the reference re-tokenizes the corpus per call
+    auto compare = [&](const vector<shared_ptr<Proposal>>& current) {
+        vector<string> corpus;
+        for (const auto& proposal : current) corpus.push_back(proposalText(proposal));
+
+        double maxDifference = 0.0;
+        int termMismatches = 0;
+        for (size_t i = 0; i < current.size(); i += 5) {
+            auto expected = SimilarityMetrics::createTFIDFVector(corpus[i], corpus);
+            SparseVector actual = engine.getProposalTFIDFVector(current[i]->getProposalId());
+            termMismatches += actual.size() != expected.size();
+            for (size_t k = 0; k < actual.size(); k++) {
+                auto it = expected.find(engine.getCorpusIndex().getTerm(actual.indices[k]));
+                if (it == expected.end()) {
+                    termMismatches++;
+                } else {
+                    maxDifference = max(maxDifference, fabs(it->second - actual.values[k]));
+                }
+            }
+        }
+        cout << "  " << setw(3) << current.size() << " proposals: max weight difference "
+             << scientific << setprecision(1) << maxDifference << fixed
+             << ", term mismatches " << termMismatches << "\n";
+    };
+
+    cout << "DecisionRankingEngine vectors vs SimilarityMetrics::createTFIDFVector\n";
+    compare(proposals);
+    vector<shared_ptr<Proposal>> remaining;
+    for (size_t i = 0; i < proposals.size(); i++) {
+        if (i % 3 == 0) {
+            engine.removeProposal(proposals[i]->getProposalId());
+        } else {
+            remaining.push_back(proposals[i]);
+        }
+    }
+    compare(remaining);
+
+    // Cost of one vector from scratch against building the index and every vector
+    const size_t numDocs = 3000;
+    vector<shared_ptr<Proposal>> docs = makeTextProposals(numDocs, rng);
+    vector<string> corpus;
+    for (const auto& doc : docs) corpus.push_back(proposalText(doc));
+
+    const int referenceCalls = 5;
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < referenceCalls; i++) {
+        SimilarityMetrics::createTFIDFVector(corpus[i], corpus);
+    }
+    double referenceMs = elapsedMs(t0) / referenceCalls;
+
+    t0 = chrono::steady_clock::now();
+    CorpusIndex index;
+    for (const auto& doc : docs) index.addProposal(doc);
+    size_t weights = 0;
+    for (const auto& doc : docs) weights += index.getDocumentVector(doc->getProposalId()).size();
+    double indexMs = elapsedMs(t0);
+
+    cout << "\nDocuments: " << numDocs << "\n";
+    cout << "  createTFIDFVector:            " << setprecision(1) << setw(8) << referenceMs << " ms per vector\n";
+    cout << "  CorpusIndex + all vectors:    " << setw(8) << indexMs << " ms  ("
+         << weights << " weights)\n";
+}
+
+// Random sparse vector over term IDs [0, universe)
+SparseVector randomSparseVector(size_t size, uint32_t universe, mt19937& rng) {
+    set<uint32_t> ids;
+    while (ids.size() < size) ids.insert(rng() % universe);
+
+    SparseVector vec;
+    uniform_real_distribution<float> valueDist(0.1f, 2.0f);
+    for (uint32_t id : ids) {
+        vec.indices.push_back(id);
+        vec.values.push_back(valueDist(rng));
+    }
+    vec.computeNorm();
+    return vec;
+}
+
+// combinedSimilarity as it was computed before the sparse kernels: regex
+// tokens, std::set Jaccard and hash-map cosine over word counts
+double referenceCombinedSimilarity(const string& text1, const string& text2) {
+    auto tokens1 = NLPUtils::tokenize(text1);
+    auto tokens2 = NLPUtils::tokenize(text2);
+    set<string> set1(tokens1.begin(), tokens1.end());
+    set<string> set2(tokens2.begin(), tokens2.end());
+    unordered_map<string, double> vec1, vec2;
+    for (const auto& token : tokens1) vec1[token]++;
+    for (const auto& token : tokens2) vec2[token]++;
+    return 0.5 * SimilarityMetrics::jaccardSimilarity(set1, set2) +
+           0.5 * SimilarityMetrics::cosineSimilarity(vec1, vec2);
+}
+
+void benchmarkSparseOverlap() {
+    printHeader("SPARSE VECTORS: INTERSECTION KERNELS");
+
+    // Random pairs, half of similar size (block merge) and half lopsided
+    // (galloping search), against a plain merge
+    const int numPairs = 20000;
+    mt19937 rng(47);
+    int sharedMismatches = 0;
+    double maxDotDifference = 0.0;
+    for (int i = 0; i < numPairs; i++) {
+        size_t size1 = rng() % 300;
+        size_t size2 = (i % 2 == 0) ? rng() % 300 : rng() % 10;
+        if (i % 2 != 0) size1 = 200 + size1 * 6;
+        uint32_t universe = 64 + rng() % 4000;
+        SparseVector vec1 = randomSparseVector(min<size_t>(size1, universe), universe, rng);
+        SparseVector vec2 = randomSparseVector(min<size_t>(size2, universe), universe, rng);
+
+        size_t shared = 0;
+        double dot = 0.0;
+        for (size_t a = 0, b = 0; a < vec1.size() && b < vec2.size(); ) {
+            if (vec1.indices[a] < vec2.indices[b]) {
+                a++;
+            } else if (vec1.indices[a] > vec2.indices[b]) {
+                b++;
+            } else {
+                shared++;
+                dot += static_cast<double>(vec1.values[a++]) * vec2.values[b++];
+            }
+        }
+
+        SparseOverlap overlap = SimilarityMetrics::sparseOverlap(vec1, vec2);
+        sharedMismatches += overlap.sharedTerms != shared;
+        maxDotDifference = max(maxDotDifference, fabs(overlap.dotProduct - dot));
+    }
+    cout << "sparseOverlap vs merge, " << numPairs << " random pairs: shared-term mismatches "
+         << sharedMismatches << ", max dot difference " << scientific << setprecision(1)
+         << maxDotDifference << fixed << "\n";
+
+    // One-vs-many against the set and map versions of Jaccard and cosine
+    const int numCandidates = 20000;
+    const int numQueries = 20;
+    vector<SparseVector> candidates;
+    vector<set<string>> candidateSets;
+    vector<unordered_map<string, double>> candidateMaps;
+    for (int c = 0; c < numCandidates; c++) {
+        candidates.push_back(randomSparseVector(rng() % 60, 5000, rng));
+        set<string> terms;
+        unordered_map<string, double> weights;
+        for (size_t k = 0; k < candidates.back().size(); k++) {
+            string term = "t" + to_string(candidates.back().indices[k]);
+            terms.insert(term);
+            weights[term] = candidates.back().values[k];
+        }
+        candidateSets.push_back(move(terms));
+        candidateMaps.push_back(move(weights));
+    }
+
+    vector<double> jaccard(numCandidates), cosine(numCandidates);
+    double oneToManyMs = 0.0, mapCosineMs = 0.0;
+    double maxJaccardDifference = 0.0, maxCosineDifference = 0.0;
+    for (int q = 0; q < numQueries; q++) {
+        SparseVector query = randomSparseVector(20 + rng() % 60, 5000, rng);
+        set<string> querySet;
+        unordered_map<string, double> queryMap;
+        for (size_t k = 0; k < query.size(); k++) {
+            string term = "t" + to_string(query.indices[k]);
+            querySet.insert(term);
+            queryMap[term] = query.values[k];
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        SimilarityMetrics::compareOneToMany(query, candidates, jaccard.data(), cosine.data());
+        oneToManyMs += elapsedMs(t0);
+
+        t0 = chrono::steady_clock::now();
+        vector<double> mapCosine(numCandidates);
+        for (int c = 0; c < numCandidates; c++) {
+            mapCosine[c] = SimilarityMetrics::cosineSimilarity(queryMap, candidateMaps[c]);
+        }
+        mapCosineMs += elapsedMs(t0);
+
+        for (int c = 0; c < numCandidates; c++) {
+            double setJaccard = SimilarityMetrics::jaccardSimilarity(querySet, candidateSets[c]);
+            maxJaccardDifference = max(maxJaccardDifference, fabs(jaccard[c] - setJaccard));
+            maxCosineDifference = max(maxCosineDifference, fabs(cosine[c] - mapCosine[c]));
+        }
+    }
+    cout << "compareOneToMany vs set Jaccard / map cosine: max differences "
+         << scientific << setprecision(1) << maxJaccardDifference << " / " << maxCosineDifference
+         << fixed << "\n\n";
+    cout << numQueries << " queries x " << numCandidates << " vectors\n";
+    cout << "  compareOneToMany (Jaccard + cosine): " << setprecision(1) << setw(8) << oneToManyMs << " ms\n";
+    cout << "  map cosine only:                     " << setw(8) << mapCosineMs << " ms\n";
+
+    // combinedSimilarity on proposal texts against the previous implementation
+    const int numTextPairs = 4000;
+    vector<shared_ptr<Proposal>> proposals = makeTextProposals(200, rng);
+    vector<pair<string, string>> textPairs;
+    for (int i = 0; i < numTextPairs; i++) {
+        textPairs.emplace_back(proposalText(proposals[rng() % proposals.size()]),
+                               proposalText(proposals[rng() % proposals.size()]));
+    }
+
+    vector<double> combined(numTextPairs), reference(numTextPairs);
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < numTextPairs; i++) {
+        combined[i] = SimilarityMetrics::combinedSimilarity(textPairs[i].first, textPairs[i].second);
+    }
+    double combinedMs = elapsedMs(t0);
+
+    t0 = chrono::steady_clock::now();
+    for (int i = 0; i < numTextPairs; i++) {
+        reference[i] = referenceCombinedSimilarity(textPairs[i].first, textPairs[i].second);
+    }
+    double referenceMs = elapsedMs(t0);
+
+    double maxCombinedDifference = 0.0;
+    for (int i = 0; i < numTextPairs; i++) {
+        maxCombinedDifference = max(maxCombinedDifference, fabs(combined[i] - reference[i]));
+    }
+    cout << "\ncombinedSimilarity, " << numTextPairs << " text pairs (max difference "
+         << scientific << setprecision(1) << maxCombinedDifference << fixed << ")\n";
+    cout << "  sparse:                              " << setprecision(1) << setw(8) << combinedMs << " ms\n";
+    cout << "  regex + set + map:                   " << setw(8) << referenceMs << " ms\n";
+}
+
+void benchmarkSimilarityIndex() {
+    printHeader("SIMILARITY INDEX: TOP-K NEIGHBORS");
+
+    // Below 1000 proposals no term is too frequent to generate candidates, so
+    // each neighbor list must equal the best all-pairs combinedSimilarity scores
+    const size_t numProposals = 600;
+    const size_t maxNeighbors = 8;
+    mt19937 rng(48);
+    vector<shared_ptr<Proposal>> proposals = makeTextProposals(numProposals, rng);
+
+    SimilarityIndex index(maxNeighbors, 0.0);
+    index.build(proposals);
+
+    int listMismatches = 0;
+    double maxScoreDifference = 0.0;
+    for (size_t i = 0; i < numProposals; i++) {
+        unordered_map<string, double> scores;
+        vector<double> best;
+        for (size_t j = 0; j < numProposals; j++) {
+            if (j == i) continue;
+            double score = SimilarityMetrics::combinedSimilarity(proposalText(proposals[i]),
+                                                                 proposalText(proposals[j]));
+            scores[proposals[j]->getProposalId()] = score;
+            if (score > 0.0) best.push_back(score);
+        }
+        sort(best.rbegin(), best.rend());
+        best.resize(min(best.size(), maxNeighbors));
+
+        // Ties at the cutoff may pick either proposal, so lists are compared by score
+        auto neighbors = index.getNeighbors(proposals[i]->getProposalId());
+        if (neighbors.size() != best.size()) {
+            listMismatches++;
+            continue;
+        }
+        for (size_t k = 0; k < neighbors.size(); k++) {
+            double difference = max(fabs(neighbors[k].second - best[k]),
+                                    fabs(neighbors[k].second - scores[neighbors[k].first]));
+            maxScoreDifference = max(maxScoreDifference, difference);
+        }
+    }
+    cout << "Top-" << maxNeighbors << " lists vs all-pairs combinedSimilarity, " << numProposals
+         << " proposals: length mismatches " << listMismatches << ", max score difference "
+         << scientific << setprecision(1) << maxScoreDifference << fixed << "\n";
+
+    const size_t numLarge = 20000;
+    vector<shared_ptr<Proposal>> large = makeTextProposals(numLarge, rng);
+    SimilarityIndex largeIndex;
+    auto t0 = chrono::steady_clock::now();
+    largeIndex.build(large);
+    double buildMs = elapsedMs(t0);
+
+    cout << "\nProposals: " << numLarge << ", hardware threads: " << max(1u, thread::hardware_concurrency()) << "\n";
+    cout << "  build (top-32):  " << setprecision(1) << setw(8) << buildMs << " ms  ("
+         << largeIndex.getNeighborCount() << " neighbors kept)\n";
+}
+
+void benchmarkIncrementalRanking() {
+    printHeader("DECISION RANKING: INCREMENTAL UPDATES");
+
+    // One engine follows a stream of adds, vote changes, removals and a new
+    // topic; the other is initialized once from the final state
+    const size_t numProposals = 400;
+    mt19937 rng(49);
+    vector<shared_ptr<Proposal>> proposals = makeTextProposals(numProposals, rng);
+    for (const auto& proposal : proposals) {
+        int votes = rng() % 20;
+        for (int v = 0; v < votes; v++) proposal->addVote("voter" + to_string(v));
+    }
+    const vector<string> transitKeywords = {"transit", "budget", "green"};
+
+    DecisionRankingEngine incremental;
+    incremental.initialize(vector<shared_ptr<Proposal>>(proposals.begin(), proposals.begin() + 50));
+    auto t0 = chrono::steady_clock::now();
+    for (size_t i = 50; i < numProposals; i++) {
+        incremental.addOrUpdateProposal(proposals[i]);
+    }
+    for (int i = 0; i < 60; i++) {
+        const auto& proposal = proposals[rng() % numProposals];
+        proposal->addVote("late_voter" + to_string(i));
+        incremental.addOrUpdateProposal(proposal);
+    }
+    vector<shared_ptr<Proposal>> remaining;
+    for (size_t i = 0; i < numProposals; i++) {
+        if (i % 10 == 3) {
+            incremental.removeProposal(proposals[i]->getProposalId());
+        } else {
+            remaining.push_back(proposals[i]);
+        }
+    }
+    int updates = static_cast<int>(numProposals - 50) + 60 + static_cast<int>(numProposals / 10);
+    double updateMs = elapsedMs(t0);
+    incremental.getTopicAnalyzer().addTopic("TRANSIT", "Transit", transitKeywords);
+    incremental.updateRankings(remaining);
+
+    DecisionRankingEngine rebuilt;
+    rebuilt.getTopicAnalyzer().addTopic("TRANSIT", "Transit", transitKeywords);
+    t0 = chrono::steady_clock::now();
+    rebuilt.initialize(remaining);
+    double initializeMs = elapsedMs(t0);
+
+    auto incrementalTop = incremental.getTopDecisions(static_cast<int>(remaining.size()));
+    auto rebuiltTop = rebuilt.getTopDecisions(static_cast<int>(remaining.size()));
+    int rankingMismatches = incrementalTop.size() != rebuiltTop.size();
+    for (size_t i = 0; i < min(incrementalTop.size(), rebuiltTop.size()); i++) {
+        rankingMismatches += incrementalTop[i].proposalId != rebuiltTop[i].proposalId ||
+                             fabs(incrementalTop[i].combinedScore - rebuiltTop[i].combinedScore) > 1e-12 ||
+                             incrementalTop[i].matchedTopics != rebuiltTop[i].matchedTopics;
+    }
+    int positionMismatches = 0, topicMismatches = 0, neighborMismatches = 0;
+    for (const auto& proposal : remaining) {
+        const string& proposalId = proposal->getProposalId();
+        positionMismatches += incremental.getProposalRanking(proposalId).rank !=
+                              rebuilt.getProposalRanking(proposalId).rank;
+        topicMismatches += incremental.getTopicAnalyzer().getProposalTopics(proposalId) !=
+                           rebuilt.getTopicAnalyzer().getProposalTopics(proposalId);
+        neighborMismatches += incremental.getSimilarProposals(proposalId) !=
+                              rebuilt.getSimilarProposals(proposalId);
+    }
+
+    cout << "Incremental vs fresh initialize, " << remaining.size() << " proposals:\n";
+    cout << "  ranking order / score mismatches: " << rankingMismatches
+         << ", rank mismatches: " << positionMismatches
+         << ", topic mismatches: " << topicMismatches
+         << ", neighbor list mismatches: " << neighborMismatches << "\n\n";
+    cout << "  " << updates << " incremental updates: " << fixed << setprecision(1) << setw(8) << updateMs << " ms"
+         << "  (" << setprecision(3) << updateMs / updates << " ms each)\n";
+    cout << "  initialize:             " << setprecision(1) << setw(8) << initializeMs << " ms\n";
+}
+
+void benchmarkTopicMatching() {
+    printHeader("TOPIC ANALYZER: SINGLE-PASS KEYWORD MATCHING");
+
+    const int numTopics = 2000;
+    const int vocabSize = 3000;
+    const size_t numProposals = 300;
+    mt19937 rng(50);
+
+    TopicAnalyzer analyzer;
+    for (int t = 0; t < numTopics; t++) {
+        set<string> keywords;
+        size_t count = 4 + rng() % 9;
+        while (keywords.size() < count) keywords.insert("kw" + to_string(rng() % vocabSize));
+        analyzer.addTopic("T" + to_string(t), "Topic " + to_string(t),
+                          vector<string>(keywords.begin(), keywords.end()));
+    }
+
+    // Texts draw repeatedly from a small slice of the vocabulary, so most
+    // proposals match several topics, with stop words and capitals mixed in
+    set<string> usedIds;
+    vector<shared_ptr<Proposal>> proposals;
+    while (proposals.size() < numProposals) {
+        int base = rng() % vocabSize;
+        string description;
+        for (int w = 0; w < 40; w++) {
+            if (rng() % 5 == 0) {
+                description += "the ";
+            } else {
+                int word = (base + rng() % 40) % vocabSize;
+                description += (rng() % 7 == 0 ? "KW" : "kw") + to_string(word) + " ";
+            }
+        }
+        auto proposal = make_shared<Proposal>("Technology and learning", description, "creator");
+        if (!usedIds.insert(proposal->getProposalId()).second) continue;
+        proposals.push_back(proposal);
+    }
+
+    auto t0 = chrono::steady_clock::now();
+    for (const auto& proposal : proposals) {
+        analyzer.analyzeProposal(proposal);
+    }
+    double analyzeMs = elapsedMs(t0);
+
+    // Per-topic scan as in the original extractTopicsFromText and
+    // calculateTopicRelevance: binary search per token, set Jaccard, mean weight
+    vector<Topic> topics = analyzer.getAllTopics();
+    int topicSetMismatches = 0;
+    size_t assignments = 0;
+    double maxRelevanceDifference = 0.0;
+    t0 = chrono::steady_clock::now();
+    for (const auto& proposal : proposals) {
+        auto tokens = NLPUtils::removeStopWords(NLPUtils::tokenize(proposalText(proposal)));
+        set<string> tokenSet(tokens.begin(), tokens.end());
+
+        vector<string> expected;
+        vector<double> expectedRelevance;
+        for (const auto& topic : topics) {
+            int matchCount = 0;
+            for (const auto& token : tokens) {
+                matchCount += binary_search(topic.keywords.begin(), topic.keywords.end(),
+                                            NLPUtils::toLowerCase(token));
+            }
+            if (matchCount < 2) continue;
+
+            set<string> keywordSet(topic.keywords.begin(), topic.keywords.end());
+            double weightedScore = 0.0;
+            int weightedMatches = 0;
+            for (const auto& token : tokens) {
+                auto it = topic.keywordWeights.find(token);
+                if (it != topic.keywordWeights.end()) {
+                    weightedScore += it->second;
+                    weightedMatches++;
+                }
+            }
+            if (weightedMatches > 0) weightedScore /= weightedMatches;
+            expected.push_back(topic.topicId);
+            expectedRelevance.push_back(0.6 * SimilarityMetrics::jaccardSimilarity(tokenSet, keywordSet) +
+                                        0.4 * weightedScore);
+        }
+
+        vector<string> actual = analyzer.getProposalTopics(proposal->getProposalId());
+        for (size_t k = 0; k < expected.size(); k++) {
+            double relevance = analyzer.getTopicRelevance(proposal->getProposalId(), expected[k]);
+            maxRelevanceDifference = max(maxRelevanceDifference, fabs(relevance - expectedRelevance[k]));
+        }
+        sort(expected.begin(), expected.end());
+        sort(actual.begin(), actual.end());
+        topicSetMismatches += actual != expected;
+        assignments += expected.size();
+    }
+    double scanMs = elapsedMs(t0);
+
+    cout << "Topics: " << topics.size() << ", proposals: " << numProposals
+         << ", topic assignments: " << assignments << "\n";
+    cout << "Keyword table vs per-topic scan: topic set mismatches " << topicSetMismatches
+         << ", max relevance difference " << scientific << setprecision(1)
+         << maxRelevanceDifference << fixed << "\n\n";
+    cout << "  analyzeProposal (keyword table): " << setprecision(1) << setw(8) << analyzeMs << " ms\n";
+    cout << "  per-topic scan:                  " << setw(8) << scanMs << " ms\n";
+}
+
+int main() {
+    benchmarkAntiAbuseSharding();
+    benchmarkCoVotePartitioning();
+    benchmarkBatchRanking();
+    benchmarkDecayedConsistency();
+    benchmarkNaiveBayes();
+    benchmarkDecisionTree();
+    benchmarkRandomForest();
+    benchmarkModelFile();
+    benchmarkEnsembleBatch();
+    benchmarkCorpusIndex();
+    benchmarkSparseOverlap();
+    benchmarkSimilarityIndex();
+    benchmarkIncrementalRanking();
+    benchmarkTopicMatching();
+    return 0;
+}